@@ -35,6 +35,9 @@ public class FWorldGenerator : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Projects",
+				"RenderCore",
+				"RHI",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -42,6 +45,10 @@ public class FWorldGenerator : ModuleRules
 			);
 		
 		
+		// PhysX for the heightfield collision of the chunks.
+		SetupModulePhysicsSupport(Target);
+
+
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
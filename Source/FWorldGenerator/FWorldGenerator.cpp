@@ -2,11 +2,19 @@
 
 #include "FWorldGenerator.h"
 
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
+
 #define LOCTEXT_NAMESPACE "FFWorldGeneratorModule"
 
 void FFWorldGeneratorModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	// The shader of the terrain vertex factory (FWGTerrainVertexFactory), the module is loaded before the shaders are compiled (PostConfigInit).
+	const FString sShaderDirectory = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("FWorldGenerator"))->GetBaseDir(), TEXT("Shaders"));
+	AddShaderSourceDirectoryMapping(TEXT("/Plugin/FWorldGenerator"), sShaderDirectory);
 }
 
 void FFWorldGeneratorModule::ShutdownModule()
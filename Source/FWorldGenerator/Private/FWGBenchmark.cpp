@@ -0,0 +1,630 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGBenchmark.h"
+
+// UE
+#include "HAL/PlatformTime.h"
+#include "ProceduralMeshComponent.h"
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+#include "PhysicsPublic.h"
+#include "IPhysXCookingModule.h"
+#include "IPhysXCooking.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#endif // WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+
+// STL
+#include <vector>
+
+// Custom
+#include "FWGNoise.h"
+#include "FWGMultiResolutionNoise.h"
+#include "FWGDomainWarp.h"
+#include "FWGPackedVertex.h"
+#include "FWGChunkRtin.h"
+#include "FWGChunkIndexBuffer.h"
+#include "FWGHeightfieldComponent.h"
+
+// Allowed difference between a single precision row and the double reference.
+#define FWG_SINGLE_PRECISION_TOLERANCE 1e-4
+
+// Camera of benchmarkChunkCulling(): directions it looks in, horizontal field of view (degrees),
+// width / height of the view and the height of the eye above the ground.
+#define FWG_BENCHMARK_CULLING_VIEW_COUNT   8
+#define FWG_BENCHMARK_CULLING_FOV          90.0f
+#define FWG_BENCHMARK_CULLING_ASPECT_RATIO (16.0f / 9.0f)
+#define FWG_BENCHMARK_CULLING_EYE_HEIGHT   180.0f
+
+namespace
+{
+	template <typename TReal>
+	FString benchmarkNoiseRow(const IFWGNoiseSource& noiseSource, const TCHAR* sName, siv::SimdLevel level,
+		int32 iRowLength, int32 iRowCount, double fTolerance)
+	{
+		std::vector<TReal> vX(iRowLength);
+		std::vector<TReal> vResult(iRowLength);
+		std::vector<TReal> vDx(iRowLength);
+		std::vector<TReal> vDy(iRowLength);
+
+		for (int32 j = 0; j < iRowLength; j++)
+		{
+			vX[j] = static_cast<TReal>(static_cast<double>(j) / iRowLength);
+		}
+
+		const double fStartTime = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < iRowCount; i++)
+		{
+			noiseSource.octaveNoise0_1Row(vX.data(), static_cast<TReal>(static_cast<double>(i) / iRowLength), iRowLength, vResult.data(), level);
+		}
+
+		const double fElapsed = FPlatformTime::Seconds() - fStartTime;
+
+		// Same rows with the derivatives (for the normals).
+		const double fDerivativesStartTime = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < iRowCount; i++)
+		{
+			noiseSource.octaveNoise0_1RowDerivatives(vX.data(), static_cast<TReal>(static_cast<double>(i) / iRowLength), iRowLength,
+				vResult.data(), vDx.data(), vDy.data(), level);
+		}
+
+		const double fDerivativesElapsed = FPlatformTime::Seconds() - fDerivativesStartTime;
+
+		// Compare the last row with the reference scalar noise.
+		const double fLastY = static_cast<TReal>(static_cast<double>(iRowCount - 1) / iRowLength);
+
+		double fMaxError = 0.0;
+
+		for (int32 j = 0; j < iRowLength; j++)
+		{
+			const double fReference = noiseSource.octaveNoise0_1(vX[j], fLastY);
+
+			fMaxError = FMath::Max(fMaxError, FMath::Abs(vResult[j] - fReference));
+		}
+
+		return FString::Printf(TEXT("\n    %s %s: %.2f Msamples/sec, with derivatives x%.2f time, max error %g (%s)"),
+			sName,
+			ANSI_TO_TCHAR(siv::SimdLevelName(level)),
+			(static_cast<double>(iRowLength) * iRowCount) / FMath::Max(fElapsed, 1e-9) / 1e6,
+			fDerivativesElapsed / FMath::Max(fElapsed, 1e-9),
+			fMaxError,
+			(fMaxError <= fTolerance) ? TEXT("ok") : TEXT("OUT OF TOLERANCE"));
+	}
+
+	// Side planes and the near plane of a camera at vEye looking horizontally at fYaw degrees,
+	// the normals point out of the frustum.
+	void makeViewFrustum(const FVector& vEye, float fYaw, FPlane* pPlanes)
+	{
+		const FVector vForward = FRotator(0.0f, fYaw, 0.0f).Vector();
+		const FVector vRight   = FVector::CrossProduct(FVector::UpVector, vForward);
+
+		const float fHalfX = FMath::DegreesToRadians(FWG_BENCHMARK_CULLING_FOV * 0.5f);
+		const float fHalfY = FMath::Atan(FMath::Tan(fHalfX) / FWG_BENCHMARK_CULLING_ASPECT_RATIO);
+
+		pPlanes[0] = FPlane(vEye,  vRight              * FMath::Cos(fHalfX) - vForward * FMath::Sin(fHalfX));
+		pPlanes[1] = FPlane(vEye, -vRight              * FMath::Cos(fHalfX) - vForward * FMath::Sin(fHalfX));
+		pPlanes[2] = FPlane(vEye,  FVector::UpVector   * FMath::Cos(fHalfY) - vForward * FMath::Sin(fHalfY));
+		pPlanes[3] = FPlane(vEye, -FVector::UpVector   * FMath::Cos(fHalfY) - vForward * FMath::Sin(fHalfY));
+		pPlanes[4] = FPlane(vEye, -vForward);
+	}
+
+	// Same test as the frustum culling of the renderer: the box is culled if it is fully outside of one plane.
+	bool isBoxInFrustum(const FPlane* pPlanes, const FBox& box)
+	{
+		const FVector vCenter = box.GetCenter();
+		const FVector vExtent = box.GetExtent();
+
+		for (int32 k = 0; k < 5; k++)
+		{
+			const float fPushOut = FVector::DotProduct(vExtent, FVector(pPlanes[k]).GetAbs());
+
+			if (pPlanes[k].PlaneDot(vCenter) > fPushOut)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+FString FWGBenchmark::benchmarkNoise(int32 iSeed, int32 iOctaves, int32 iRowLength, int32 iRowCount)
+{
+	FString sReport = FString::Printf(TEXT("Noise (%d octaves, %d x %d samples):"), iOctaves, iRowLength, iRowCount);
+
+	const EFWGNoiseType vNoiseTypes[] = { EFWGNoiseType::Perlin, EFWGNoiseType::OpenSimplex2, EFWGNoiseType::Value };
+	const TCHAR*        vNoiseNames[] = { TEXT("Perlin"),        TEXT("OpenSimplex2"),        TEXT("Value") };
+
+	const siv::SimdLevel vLevels[] = { siv::SimdLevel::Scalar, siv::SimdLevel::SSE4, siv::SimdLevel::AVX2 };
+
+	for (int32 i = 0; i < 3; i++)
+	{
+		const std::unique_ptr<IFWGNoiseSource> pNoiseSource =
+			FWGNoiseContext::createNoiseSource(vNoiseTypes[i], static_cast<uint32>(iSeed), iOctaves);
+
+		siv::SimdLevel bestLevel = siv::SimdLevel::Scalar;
+
+		for (siv::SimdLevel level : vLevels)
+		{
+			if (level > pNoiseSource->getMaxSimdLevel())
+			{
+				// The noise has no code for this level.
+				continue;
+			}
+
+			if (level > siv::DetectSimdLevel())
+			{
+				sReport += FString::Printf(TEXT("\n    %s %s: not supported"), vNoiseNames[i], ANSI_TO_TCHAR(siv::SimdLevelName(level)));
+				continue;
+			}
+
+			sReport += benchmarkNoiseRow<double>(*pNoiseSource, vNoiseNames[i], level, iRowLength, iRowCount, siv::PerlinNoise::RowTolerance);
+
+			bestLevel = level;
+		}
+
+		// SinglePrecisionGeneration, only on the level the generation would use.
+		sReport += benchmarkNoiseRow<float>(*pNoiseSource, *(FString(vNoiseNames[i]) + TEXT(" float")), bestLevel,
+			iRowLength, iRowCount, FWG_SINGLE_PRECISION_TOLERANCE);
+	}
+
+	return sReport;
+}
+
+FString FWGBenchmark::benchmarkMultiResolution(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+	double fStepX, double fStepY, double fHeightScale, double fMaxHeightError, int32 iChunkCount)
+{
+	const FWGNoiseContext noise(static_cast<uint32>(iSeed), iOctaves, noiseType);
+
+	std::vector<double> vX(iColumnCount);
+
+	for (int32 j = 0; j < iColumnCount; j++)
+	{
+		vX[j] = j * fStepX;
+	}
+
+	std::vector<double> vFull(static_cast<size_t>(iColumnCount) * iRowCount);
+	std::vector<double> vMultiResolution(static_cast<size_t>(iColumnCount) * iRowCount);
+
+	std::vector<double> vDx(iColumnCount);
+	std::vector<double> vDy(iColumnCount);
+
+	const double fStartTime = FPlatformTime::Seconds();
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		for (int32 i = 0; i < iRowCount; i++)
+		{
+			noise.octaveNoise0_1RowDerivatives(vX.data(), i * fStepY, iColumnCount, &vFull[static_cast<size_t>(i) * iColumnCount], vDx.data(), vDy.data());
+		}
+	}
+
+	const double fFullElapsed = FPlatformTime::Seconds() - fStartTime;
+
+	const double fMultiResolutionStartTime = FPlatformTime::Seconds();
+
+	bool bMultiResolution = false;
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		const TFWGMultiResolutionNoise<double> multiResolutionNoise(noise, vX.data(), iColumnCount, iRowCount, 0, 0, 0.0, 0.0,
+			fStepX, fStepY, fMaxHeightError / fHeightScale);
+
+		for (int32 i = 0; i < iRowCount; i++)
+		{
+			multiResolutionNoise.sampleRow(i, i * fStepY, &vMultiResolution[static_cast<size_t>(i) * iColumnCount], vDx.data(), vDy.data());
+		}
+
+		bMultiResolution = multiResolutionNoise.isMultiResolution();
+	}
+
+	const double fMultiResolutionElapsed = FPlatformTime::Seconds() - fMultiResolutionStartTime;
+
+	double fMaxError = 0.0;
+
+	for (size_t i = 0; i < vFull.size(); i++)
+	{
+		fMaxError = FMath::Max(fMaxError, FMath::Abs(vFull[i] - vMultiResolution[i]) * fHeightScale);
+	}
+
+	return FString::Printf(TEXT("Multi-resolution noise (%d x %d vertices, max error %g): %.2f ms per chunk, full %.2f ms, max error %g (%s)"),
+		iColumnCount, iRowCount, fMaxHeightError,
+		fMultiResolutionElapsed * 1000.0 / iChunkCount,
+		fFullElapsed * 1000.0 / iChunkCount,
+		fMaxError,
+		(bMultiResolution == false) ? TEXT("no octave is coarse enough") : ((fMaxError <= fMaxHeightError) ? TEXT("ok") : TEXT("OUT OF TOLERANCE")));
+}
+
+FString FWGBenchmark::benchmarkDomainWarp(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+	double fStepX, double fStepY, double fStrengthX, double fStrengthY, double fFrequency, int32 iChunkCount)
+{
+	const FWGNoiseContext noise(static_cast<uint32>(iSeed), iOctaves, noiseType);
+
+	std::vector<double> vX(iColumnCount);
+
+	for (int32 j = 0; j < iColumnCount; j++)
+	{
+		vX[j] = j * fStepX;
+	}
+
+	std::vector<double> vResult(iColumnCount);
+	std::vector<double> vDx(iColumnCount);
+	std::vector<double> vDy(iColumnCount);
+
+	const double fStartTime = FPlatformTime::Seconds();
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		for (int32 i = 0; i < iRowCount; i++)
+		{
+			noise.octaveNoise0_1RowDerivatives(vX.data(), i * fStepY, iColumnCount, vResult.data(), vDx.data(), vDy.data());
+		}
+	}
+
+	const double fElapsed = FPlatformTime::Seconds() - fStartTime;
+
+	const double fWarpStartTime = FPlatformTime::Seconds();
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		TFWGDomainWarp<double> domainWarp(noise, iColumnCount, iRowCount, 0, 0, 0.0, 0.0,
+			fStepX, fStepY, fStrengthX, fStrengthY, fFrequency);
+
+		for (int32 i = 0; i < iRowCount; i++)
+		{
+			domainWarp.sampleRow(i, vX.data(), i * fStepY, vResult.data(), vDx.data(), vDy.data());
+		}
+	}
+
+	const double fWarpElapsed = FPlatformTime::Seconds() - fWarpStartTime;
+
+	return FString::Printf(TEXT("Domain warp (%d x %d vertices): %.2f ms per chunk, without %.2f ms, overhead %.1f%%"),
+		iColumnCount, iRowCount,
+		fWarpElapsed * 1000.0 / iChunkCount,
+		fElapsed * 1000.0 / iChunkCount,
+		(fWarpElapsed / FMath::Max(fElapsed, 1e-9) - 1.0) * 100.0);
+}
+
+FString FWGBenchmark::benchmarkVertexPacking(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+	double fStepX, double fStepY, float fSizeX, float fSizeY, float fHeightRange, int32 iChunkCount)
+{
+	const FWGNoiseContext noise(static_cast<uint32>(iSeed), iOctaves, noiseType);
+
+	// A chunk like generateChunk() makes it.
+
+	const int32 iVertexCount = iColumnCount * iRowCount;
+
+	TArray<FVector>      vVertices;
+	TArray<FVector>      vNormals;
+	TArray<FLinearColor> vVertexColors;
+
+	vVertices    .Reserve(iVertexCount);
+	vNormals     .Reserve(iVertexCount);
+	vVertexColors.Reserve(iVertexCount);
+
+	std::vector<double> vX(iColumnCount);
+	std::vector<double> vResult(iColumnCount);
+	std::vector<double> vDx(iColumnCount);
+	std::vector<double> vDy(iColumnCount);
+
+	for (int32 j = 0; j < iColumnCount; j++)
+	{
+		vX[j] = j * fStepX;
+	}
+
+	for (int32 i = 0; i < iRowCount; i++)
+	{
+		noise.octaveNoise0_1RowDerivatives(vX.data(), i * fStepY, iColumnCount, vResult.data(), vDx.data(), vDy.data());
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			const float fSlopeX = static_cast<float>(vDx[j] * fHeightRange * fStepX / fSizeX);
+			const float fSlopeY = static_cast<float>(vDy[j] * fHeightRange * fStepY / fSizeY);
+
+			vVertices    .Add(FVector(j * fSizeX, i * fSizeY, static_cast<float>(vResult[j] * fHeightRange)));
+			vNormals     .Add(FVector(-fSlopeX, -fSlopeY, 1.0f).GetSafeNormal());
+			vVertexColors.Add(FLinearColor(0.0f, 0.0f, 0.0f, (vResult[j] < 0.5) ? 0.0f : 1.0f));
+		}
+	}
+
+	const FWGVertexPacker packer(FVector(0.0f, 0.0f, 0.0f), fSizeX, fSizeY, fHeightRange);
+
+	TArray<FWGPackedVertex> vPacked;
+
+	const double fStartTime = FPlatformTime::Seconds();
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		packer.pack(vVertices, vNormals, vVertexColors, vPacked);
+	}
+
+	const double fElapsed = FPlatformTime::Seconds() - fStartTime;
+
+	// Precision.
+
+	float fMaxLocationError  = 0.0f;
+	float fMinNormalCos      = 1.0f;
+
+	for (int32 k = 0; k < iVertexCount; k++)
+	{
+		fMaxLocationError = FMath::Max(fMaxLocationError, (packer.unpackLocation(vPacked[k]) - vVertices[k]).GetAbsMax());
+		fMinNormalCos     = FMath::Min(fMinNormalCos, FVector::DotProduct(FWGVertexPacker::unpackNormal(vPacked[k]), vNormals[k]));
+	}
+
+	// What generateChunk() fills and uploads per vertex, what the procedural mesh section keeps per vertex.
+	const int32 iSourceSize  = sizeof(FVector) * 2 + sizeof(FVector2D) + sizeof(FLinearColor) + sizeof(FProcMeshTangent);
+	const int32 iSectionSize = sizeof(FProcMeshVertex);
+	const int32 iPackedSize  = sizeof(FWGPackedVertex);
+
+	return FString::Printf(TEXT("Vertex packing (%d x %d vertices): %.3f ms per chunk (%.1f M vertices/s), ")
+		TEXT("%d bytes per vertex instead of %d (chunk arrays, %.1fx less) and %d (procedural mesh section, %.1fx less), ")
+		TEXT("%.1f KB per chunk, max location error %.3f, max normal error %.3f degrees"),
+		iColumnCount, iRowCount,
+		fElapsed * 1000.0 / iChunkCount,
+		static_cast<double>(iVertexCount) * iChunkCount / FMath::Max(fElapsed, 1e-9) / 1e6,
+		iPackedSize, iSourceSize, static_cast<float>(iSourceSize) / iPackedSize,
+		iSectionSize, static_cast<float>(iSectionSize) / iPackedSize,
+		iVertexCount * iPackedSize / 1024.0f,
+		fMaxLocationError,
+		FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(fMinNormalCos, -1.0f, 1.0f))));
+}
+
+FString FWGBenchmark::benchmarkAdaptiveMesh(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+	double fStepX, double fStepY, float fHeightRange, float fCutHeight, float fMaxError, int32 iChunkCount)
+{
+	const FWGNoiseContext noise(static_cast<uint32>(iSeed), iOctaves, noiseType);
+
+	// Heights of a chunk like generateChunk() makes it, X and Y are not used.
+
+	TArray<FVector> vVertices;
+	vVertices.Reserve(iColumnCount * iRowCount);
+
+	std::vector<double> vX(iColumnCount);
+	std::vector<double> vResult(iColumnCount);
+
+	for (int32 j = 0; j < iColumnCount; j++)
+	{
+		vX[j] = j * fStepX;
+	}
+
+	for (int32 i = 0; i < iRowCount; i++)
+	{
+		noise.octaveNoise0_1Row(vX.data(), i * fStepY, iColumnCount, vResult.data());
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			vVertices.Add(FVector(j, i, FMath::Min(static_cast<float>(vResult[j]), fCutHeight) * fHeightRange));
+		}
+	}
+
+	const FWGChunkRtin rtin(iRowCount, iColumnCount);
+
+	TArray<int32> vTriangles;
+
+	const double fStartTime = FPlatformTime::Seconds();
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		rtin.triangulate(vVertices, fMaxError, vTriangles);
+	}
+
+	const double fElapsed = FPlatformTime::Seconds() - fStartTime;
+
+	const int32 iTriangleCount = vTriangles.Num() / 3;
+
+	return FString::Printf(TEXT("Adaptive mesh (%d x %d vertices, max error %.1f): %.3f ms per chunk, ")
+		TEXT("%d triangles instead of %d (%.1fx less), measured max error %.1f"),
+		iColumnCount, iRowCount, fMaxError,
+		fElapsed * 1000.0 / iChunkCount,
+		iTriangleCount, rtin.getFullTriangleCount(),
+		static_cast<float>(rtin.getFullTriangleCount()) / FMath::Max(iTriangleCount, 1),
+		rtin.getMaxError(vVertices, vTriangles));
+}
+
+FString FWGBenchmark::benchmarkChunkCulling(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+	double fStepX, double fStepY, float fSizeX, float fSizeY, float fHeightRange, float fCutHeight, int32 iViewDistance)
+{
+	const FWGNoiseContext noise(static_cast<uint32>(iSeed), iOctaves, noiseType);
+
+	// Bounds of the chunks like generateChunk() makes them, the central chunk starts at (0, 0).
+
+	const int32 iSide       = iViewDistance * 2 + 1;
+	const int32 iChunkCount = iSide * iSide;
+
+	std::vector<FBox> vChunkBounds;
+	std::vector<FBox> vRangeBounds;
+
+	vChunkBounds.reserve(iChunkCount);
+	vRangeBounds.reserve(iChunkCount);
+
+	FBox worldBounds(ForceInit);
+
+	std::vector<double> vX(iColumnCount);
+	std::vector<double> vResult(iColumnCount);
+
+	float fEyeZ = FWG_BENCHMARK_CULLING_EYE_HEIGHT;
+
+	for (int32 iChunkY = -iViewDistance; iChunkY <= iViewDistance; iChunkY++)
+	{
+		for (int32 iChunkX = -iViewDistance; iChunkX <= iViewDistance; iChunkX++)
+		{
+			const double fStartX = static_cast<double>(iChunkX) * (iColumnCount - 1);
+			const double fStartY = static_cast<double>(iChunkY) * (iRowCount - 1);
+
+			for (int32 j = 0; j < iColumnCount; j++)
+			{
+				vX[j] = (fStartX + j) * fStepX;
+			}
+
+			float fMinZ = fHeightRange;
+			float fMaxZ = 0.0f;
+
+			for (int32 i = 0; i < iRowCount; i++)
+			{
+				noise.octaveNoise0_1Row(vX.data(), (fStartY + i) * fStepY, iColumnCount, vResult.data());
+
+				for (int32 j = 0; j < iColumnCount; j++)
+				{
+					const float fZ = FMath::Min(static_cast<float>(vResult[j]), fCutHeight) * fHeightRange;
+
+					fMinZ = FMath::Min(fMinZ, fZ);
+					fMaxZ = FMath::Max(fMaxZ, fZ);
+				}
+
+				if ((iChunkX == 0) && (iChunkY == 0) && (i == iRowCount / 2))
+				{
+					fEyeZ = FMath::Min(static_cast<float>(vResult[iColumnCount / 2]), fCutHeight) * fHeightRange + FWG_BENCHMARK_CULLING_EYE_HEIGHT;
+				}
+			}
+
+			const float fMinX = static_cast<float>(fStartX * fSizeX);
+			const float fMinY = static_cast<float>(fStartY * fSizeY);
+			const float fMaxX = static_cast<float>((fStartX + iColumnCount - 1) * fSizeX);
+			const float fMaxY = static_cast<float>((fStartY + iRowCount    - 1) * fSizeY);
+
+			vChunkBounds.push_back(FBox(FVector(fMinX, fMinY, fMinZ), FVector(fMaxX, fMaxY, fMaxZ)));
+			vRangeBounds.push_back(FBox(FVector(fMinX, fMinY, 0.0f),  FVector(fMaxX, fMaxY, fHeightRange)));
+
+			worldBounds += vChunkBounds.back();
+		}
+	}
+
+	// The camera stands in the middle of the central chunk and turns around.
+
+	const FVector vEye((iColumnCount - 1) * fSizeX * 0.5f, (iRowCount - 1) * fSizeY * 0.5f, fEyeZ);
+
+	int32 iWorldDraws = 0;
+	int32 iRangeDraws = 0;
+	int32 iChunkDraws = 0;
+
+	for (int32 v = 0; v < FWG_BENCHMARK_CULLING_VIEW_COUNT; v++)
+	{
+		FPlane vPlanes[5];
+		makeViewFrustum(vEye, 360.0f * v / FWG_BENCHMARK_CULLING_VIEW_COUNT, vPlanes);
+
+		// One component draws all chunks or none.
+		if (isBoxInFrustum(vPlanes, worldBounds))
+		{
+			iWorldDraws += iChunkCount;
+		}
+
+		for (int32 k = 0; k < iChunkCount; k++)
+		{
+			iRangeDraws += isBoxInFrustum(vPlanes, vRangeBounds[k]) ? 1 : 0;
+			iChunkDraws += isBoxInFrustum(vPlanes, vChunkBounds[k]) ? 1 : 0;
+		}
+	}
+
+	const float fViewCount = FWG_BENCHMARK_CULLING_VIEW_COUNT;
+
+	return FString::Printf(TEXT("Chunk culling (%d x %d chunks, %d views of %.0f degrees): draws per view - ")
+		TEXT("one component %.1f (%.1f culled), chunk bounds from the height range %.1f (%.1f culled), ")
+		TEXT("chunk bounds from the generated heights %.1f (%.1f culled)"),
+		iSide, iSide, FWG_BENCHMARK_CULLING_VIEW_COUNT, FWG_BENCHMARK_CULLING_FOV,
+		iWorldDraws / fViewCount, iChunkCount - iWorldDraws / fViewCount,
+		iRangeDraws / fViewCount, iChunkCount - iRangeDraws / fViewCount,
+		iChunkDraws / fViewCount, iChunkCount - iChunkDraws / fViewCount);
+}
+
+FString FWGBenchmark::benchmarkCollision(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+	double fStepX, double fStepY, float fSizeX, float fSizeY, float fHeightRange, int32 iStep, int32 iChunkCount)
+{
+	if (FWGHeightfield::isSupported() == false)
+	{
+		return TEXT("Collision: heightfields are not supported by the physics engine");
+	}
+
+	const FWGNoiseContext noise(static_cast<uint32>(iSeed), iOctaves, noiseType);
+
+	// Vertices of a chunk like generateChunk() makes them.
+
+	TArray<FVector> vVertices;
+	vVertices.Reserve(iColumnCount * iRowCount);
+
+	std::vector<double> vX(iColumnCount);
+	std::vector<double> vResult(iColumnCount);
+
+	for (int32 j = 0; j < iColumnCount; j++)
+	{
+		vX[j] = j * fStepX;
+	}
+
+	for (int32 i = 0; i < iRowCount; i++)
+	{
+		noise.octaveNoise0_1Row(vX.data(), i * fStepY, iColumnCount, vResult.data());
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			vVertices.Add(FVector(j * fSizeX, i * fSizeY, static_cast<float>(vResult[j] * fHeightRange)));
+		}
+	}
+
+	// The triangle mesh, cooked like the procedural mesh section does it.
+
+	double fTriangleMeshElapsed = 0.0;
+	int32  iTriangleMeshSize    = 0;
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	const FWGChunkIndexBuffer indexBuffer(iRowCount, iColumnCount);
+	const TArray<int32>&      vIndices = indexBuffer.getIndices();
+
+	TArray<FTriIndices> vTriangles;
+	vTriangles.SetNumUninitialized(vIndices.Num() / 3);
+
+	for (int32 k = 0; k < vTriangles.Num(); k++)
+	{
+		vTriangles[k].v0 = vIndices[k * 3];
+		vTriangles[k].v1 = vIndices[k * 3 + 1];
+		vTriangles[k].v2 = vIndices[k * 3 + 2];
+	}
+
+	const TArray<uint16> vMaterialIndices;
+
+	IPhysXCookingModule* pCookingModule = GetPhysXCookingModule();
+
+	if (pCookingModule)
+	{
+		TArray<uint8> vCookedData;
+
+		const double fStartTime = FPlatformTime::Seconds();
+
+		for (int32 k = 0; k < iChunkCount; k++)
+		{
+			vCookedData.Reset();
+
+			pCookingModule->GetPhysXCooking()->CookTriMesh(FName(FPlatformProperties::GetPhysicsFormat()), EPhysXMeshCookFlags::Default,
+				vVertices, vTriangles, vMaterialIndices, true, vCookedData);
+		}
+
+		fTriangleMeshElapsed = FPlatformTime::Seconds() - fStartTime;
+		iTriangleMeshSize    = vCookedData.Num();
+	}
+#endif // WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+
+	// The heightfield.
+
+	FWGHeightfieldPtr pHeightfield;
+
+	const double fStartTime = FPlatformTime::Seconds();
+
+	for (int32 k = 0; k < iChunkCount; k++)
+	{
+		pHeightfield = MakeShared<const FWGHeightfield, ESPMode::ThreadSafe>(vVertices, iRowCount, iColumnCount, iStep,
+			FWGHeightfield::loadCookingModule());
+	}
+
+	const double fHeightfieldElapsed = FPlatformTime::Seconds() - fStartTime;
+
+	return FString::Printf(TEXT("Collision (%d x %d vertices): triangle mesh %.3f ms per chunk, %.1f KB cooked; ")
+		TEXT("heightfield (%d x %d samples) %.3f ms per chunk (%.1fx faster), %.1f KB (%.1fx less)%s"),
+		iColumnCount, iRowCount,
+		fTriangleMeshElapsed * 1000.0 / iChunkCount, iTriangleMeshSize / 1024.0f,
+		pHeightfield->iSampleColumnCount, pHeightfield->iSampleRowCount,
+		fHeightfieldElapsed * 1000.0 / iChunkCount, fTriangleMeshElapsed / FMath::Max(fHeightfieldElapsed, 1e-9),
+		pHeightfield->getSize() / 1024.0f, static_cast<float>(iTriangleMeshSize) / FMath::Max(pHeightfield->getSize(), 1),
+		pHeightfield->isValid() ? TEXT("") : TEXT(" (FAILED)"));
+}
@@ -0,0 +1,54 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FWGNoiseType.h"
+
+class FWGBenchmark
+{
+public:
+
+	// Throughput of octaveNoise0_1Row() of every noise type, for every instruction set this CPU
+	// supports and in single precision, measured on iRowCount rows of iRowLength samples
+	// (one row per chunk vertex row).
+	static FString benchmarkNoise(int32 iSeed, int32 iOctaves, int32 iRowLength, int32 iRowCount);
+
+	// Time of the noise of iChunkCount chunks evaluated for every vertex and with TFWGMultiResolutionNoise,
+	// and the max height difference between them. fStepX / fStepY - noise units between two vertices,
+	// fHeightScale - height of the noise value 1, fMaxHeightError - MultiResolutionMaxError.
+	static FString benchmarkMultiResolution(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+		double fStepX, double fStepY, double fHeightScale, double fMaxHeightError, int32 iChunkCount);
+
+	// Time of the noise of iChunkCount chunks with and without TFWGDomainWarp (including its lattice).
+	// fStrengthX / fStrengthY - max offset in noise units, fFrequency - DomainWarpFrequency.
+	static FString benchmarkDomainWarp(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+		double fStepX, double fStepY, double fStrengthX, double fStrengthY, double fFrequency, int32 iChunkCount);
+
+	// Time of FWGVertexPacker::pack() on a chunk of the noise (fStepX / fStepY - noise units between two vertices,
+	// fSizeX / fSizeY - ChunkPieceSizeX / Y, fHeightRange - GenerationMaxZFromActorZ), the bytes per vertex
+	// and the precision of the packed vertices.
+	static FString benchmarkVertexPacking(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+		double fStepX, double fStepY, float fSizeX, float fSizeY, float fHeightRange, int32 iChunkCount);
+
+	// Time of FWGChunkRtin::triangulate() on a chunk of the noise cut at fCutHeight (TerrainCutHeightFromActorZ),
+	// the triangles it keeps and the max height error it makes. fHeightRange - GenerationMaxZFromActorZ,
+	// fMaxError - AdaptiveMeshMaxError.
+	static FString benchmarkAdaptiveMesh(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+		double fStepX, double fStepY, float fHeightRange, float fCutHeight, float fMaxError, int32 iChunkCount);
+
+	// Draws of a world of (iViewDistance * 2 + 1)^2 chunks of the noise the frustum culling rejects when
+	// the camera stands in the middle of the central chunk and looks around (FWG_BENCHMARK_CULLING_VIEW_COUNT directions):
+	// with one component for all chunks, with the bounds of every chunk taken from the whole height range
+	// and with the bounds of every chunk from its generated heights (see AFWGChunk::getMeshBounds()).
+	static FString benchmarkChunkCulling(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+		double fStepX, double fStepY, float fSizeX, float fSizeY, float fHeightRange, float fCutHeight, int32 iViewDistance);
+
+	// Time and memory of the collision of a chunk of the noise: the cooked triangle mesh (what the procedural mesh
+	// section cooks) and FWGHeightfield with every iStep-th vertex (HeightfieldCollisionStep).
+	static FString benchmarkCollision(int32 iSeed, int32 iOctaves, EFWGNoiseType noiseType, int32 iColumnCount, int32 iRowCount,
+		double fStepX, double fStepY, float fSizeX, float fSizeY, float fHeightRange, int32 iStep, int32 iChunkCount);
+};
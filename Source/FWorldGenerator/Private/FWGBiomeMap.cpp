@@ -0,0 +1,143 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGBiomeMap.h"
+
+// Custom
+#include "FWGNoise.h"
+
+
+static long long floorDivide(long long iValue, long long iDivisor)
+{
+	return (iValue >= 0) ? (iValue / iDivisor) : -((-iValue + iDivisor - 1) / iDivisor);
+}
+
+
+FWGBiomeMap::FWGBiomeMap(std::shared_ptr<const FWGNoiseContext> pNoise, double fOriginX, double fOriginY,
+	double fChunkSizeX, double fChunkSizeY, double fFrequency,
+	float fHeightVariation, float fMaterialHeightShift, float fSpawnVariation)
+	: pNoise(std::move(pNoise)), fOriginX(fOriginX), fOriginY(fOriginY),
+	fChunkSizeX(fChunkSizeX), fChunkSizeY(fChunkSizeY), fFrequency(fFrequency),
+	fHeightVariation(fHeightVariation), fMaterialHeightShift(fMaterialHeightShift), fSpawnVariation(fSpawnVariation)
+{
+}
+
+FWGChunkBiome FWGBiomeMap::getChunkBiome(long long iX, long long iY)
+{
+	const FRegionKey key(floorDivide(iX, FWG_BIOME_REGION_CHUNKS), floorDivide(iY, FWG_BIOME_REGION_CHUNKS));
+
+	const int32 iLocalX = static_cast<int32>(iX - key.first  * FWG_BIOME_REGION_CHUNKS);
+	const int32 iLocalY = static_cast<int32>(iY - key.second * FWG_BIOME_REGION_CHUNKS);
+
+	const int32 iCornersInRow = FWG_BIOME_REGION_CHUNKS + 1;
+
+	FWGClimate vCorners[4];
+
+	{
+		std::lock_guard<std::mutex> lock(mtxRegions);
+
+		const FRegion& region = findRegion(key);
+
+		vCorners[0] = region.vCorners[iLocalY       * iCornersInRow + iLocalX];
+		vCorners[1] = region.vCorners[iLocalY       * iCornersInRow + iLocalX + 1];
+		vCorners[2] = region.vCorners[(iLocalY + 1) * iCornersInRow + iLocalX];
+		vCorners[3] = region.vCorners[(iLocalY + 1) * iCornersInRow + iLocalX + 1];
+	}
+
+	FWGChunkBiome biome;
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		// All are linear in the climate, so interpolating them is the same as interpolating the climate.
+
+		biome.vHeightScale[i]         = 1.0f - fHeightVariation * vCorners[i].fMoisture;
+		biome.vMaterialHeightShift[i] = fMaterialHeightShift * (2.0f * vCorners[i].fTemperature - 1.0f);
+		biome.vSpawnScale[i]          = 1.0f + fSpawnVariation * (2.0f * vCorners[i].fMoisture - 1.0f);
+	}
+
+	return biome;
+}
+
+const FWGBiomeMap::FRegion& FWGBiomeMap::findRegion(const FRegionKey& key)
+{
+	auto it = mRegions.find(key);
+
+	if (it != mRegions.end())
+	{
+		// Move to the front.
+		lRegions.splice(lRegions.begin(), lRegions, it->second);
+
+		return lRegions.front();
+	}
+
+	if (lRegions.size() >= FWG_BIOME_CACHE_REGIONS)
+	{
+		mRegions.erase(lRegions.back().key);
+		lRegions.pop_back();
+	}
+
+	lRegions.push_front(FRegion());
+
+	FRegion& region = lRegions.front();
+	region.key = key;
+
+	sampleRegion(region);
+
+	mRegions[key] = lRegions.begin();
+
+	return region;
+}
+
+void FWGBiomeMap::sampleRegion(FRegion& region) const
+{
+	const int32 iCornersInRow = FWG_BIOME_REGION_CHUNKS + 1;
+	const int32 iOctaveCount  = FMath::Min(pNoise->iOctaves, FWG_BIOME_OCTAVES);
+
+	// Far from each other, from the terrain samples and from the domain warp field.
+	const double vOffsetX[2] = { 23.7, 61.9 };
+	const double vOffsetY[2] = { 41.1, 12.4 };
+
+	std::vector<double> vX(iCornersInRow);
+	std::vector<double> vValue(iCornersInRow);
+	std::vector<double> vDx(iCornersInRow);
+	std::vector<double> vDy(iCornersInRow);
+
+	region.vCorners.resize(iCornersInRow * iCornersInRow);
+
+	for (int32 c = 0; c < 2; c++)
+	{
+		for (int32 k = 0; k < iCornersInRow; k++)
+		{
+			const long long iCornerX = region.key.first * FWG_BIOME_REGION_CHUNKS + k;
+
+			vX[k] = (fOriginX + iCornerX * fChunkSizeX) * fFrequency + vOffsetX[c];
+		}
+
+		for (int32 i = 0; i < iCornersInRow; i++)
+		{
+			const long long iCornerY = region.key.second * FWG_BIOME_REGION_CHUNKS + i;
+
+			const double y = (fOriginY + iCornerY * fChunkSizeY) * fFrequency + vOffsetY[c];
+
+			pNoise->octaveNoiseRowDerivatives(vX.data(), y, iCornersInRow, 0, iOctaveCount, vValue.data(), vDx.data(), vDy.data());
+
+			for (int32 j = 0; j < iCornersInRow; j++)
+			{
+				const float fValue = FMath::Clamp(static_cast<float>(vValue[j] * 0.5 + 0.5), 0.0f, 1.0f);
+
+				FWGClimate& climate = region.vCorners[i * iCornersInRow + j];
+
+				if (c == 0)
+				{
+					climate.fTemperature = fValue;
+				}
+				else
+				{
+					climate.fMoisture = fValue;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+class FWGNoiseContext;
+
+
+// Chunks per side of one region (tile) of the biome map.
+#define FWG_BIOME_REGION_CHUNKS 8
+// Regions kept in memory, the least recently used one is dropped first.
+#define FWG_BIOME_CACHE_REGIONS 16
+// The climate only needs the first (slowest) octaves.
+#define FWG_BIOME_OCTAVES 2
+
+
+// Climate of a point of the world, both in [0, 1].
+struct FWGClimate
+{
+	float fTemperature;
+	float fMoisture;
+};
+
+// What the biome changes, at the 4 corners of one chunk: (0, 0), (0, last), (last, 0), (last, last) as row, column
+// of the chunk vertices (same order as FWGChunkBorder::vCorners).
+struct FWGChunkBiome
+{
+	// Bilinear interpolation of the corners at fU (along the columns) and fV (along the rows), both in [0, 1].
+	// Exact at the corners and the edges, so neighbour chunks agree on their common edge.
+	static float interpolate(const float* pCorners, float fU, float fV)
+	{
+		const float fBottom = (1.0f - fU) * pCorners[0] + fU * pCorners[1];
+		const float fTop    = (1.0f - fU) * pCorners[2] + fU * pCorners[3];
+
+		return (1.0f - fV) * fBottom + fV * fTop;
+	}
+
+	float vHeightScale[4];          // Multiplies the terrain noise (height above the actor).
+	float vMaterialHeightShift[4];  // Added to FirstMaterialMaxRelativeHeight and SecondMaterialMaxRelativeHeight.
+	float vSpawnScale[4];           // Multiplies the spawn probabilities.
+};
+
+// Very low frequency temperature and moisture noise that the biomes are made of:
+// moist regions are flatter, warm regions have higher material heights, moist regions spawn more objects.
+// The climate is sampled only at chunk corners, a region of FWG_BIOME_REGION_CHUNKS x FWG_BIOME_REGION_CHUNKS
+// chunks at a time, the regions are kept in a small LRU cache. A chunk reads its 4 corners once and
+// interpolates them for its vertices, so a vertex only pays for a bilinear interpolation.
+// The cache is guarded by a mutex, the map can be shared by chunks generated at the same time.
+class FWGBiomeMap
+{
+public:
+
+	// fOriginX     - noise x of the corner (0, 0) of the chunk (0, 0), fChunkSizeX - noise x between two chunk corners, same for y.
+	// fFrequency   - frequency of the climate relative to the first octave of the terrain noise.
+	// The rest are BiomeHeightVariation, BiomeMaterialHeightShift and BiomeSpawnVariation of AFWGen.
+	FWGBiomeMap(std::shared_ptr<const FWGNoiseContext> pNoise, double fOriginX, double fOriginY,
+		double fChunkSizeX, double fChunkSizeY, double fFrequency,
+		float fHeightVariation, float fMaterialHeightShift, float fSpawnVariation);
+
+	// Thread-safe.
+	FWGChunkBiome   getChunkBiome   (long long iX, long long iY);
+
+private:
+
+	typedef std::pair<long long, long long> FRegionKey;
+
+	struct FRegion
+	{
+		FRegionKey               key;
+
+		// (FWG_BIOME_REGION_CHUNKS + 1)^2 chunk corners, row by row.
+		std::vector<FWGClimate>  vCorners;
+	};
+
+
+	const FRegion& findRegion   (const FRegionKey& key);
+	void           sampleRegion (FRegion& region) const;
+
+
+	const std::shared_ptr<const FWGNoiseContext> pNoise;
+
+	const double              fOriginX;
+	const double              fOriginY;
+	const double              fChunkSizeX;
+	const double              fChunkSizeY;
+	const double              fFrequency;
+
+	const float               fHeightVariation;
+	const float               fMaterialHeightShift;
+	const float               fSpawnVariation;
+
+	std::mutex                mtxRegions;
+
+	// Most recently used first.
+	std::list<FRegion>                                     lRegions;
+	std::map<FRegionKey, std::list<FRegion>::iterator>     mRegions;
+};
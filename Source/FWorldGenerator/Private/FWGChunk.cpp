@@ -7,9 +7,30 @@
 #include "FWGChunk.h"
 
 #include "FWGen.h"
+#include "FWGChunkGenerator.h"
+
+// STL
+#include <algorithm>
 
 AFWGChunk::AFWGChunk()
 {
+	iLodLevel        = -1;
+
+	iMeshX           = 0;
+	iMeshY           = 0;
+	iLoadRequest     = 0;
+
+	iMinZVertexIndex = 0;
+	iMaxZVertexIndex = 0;
+
+	bHasCollision          = false;
+	bCollisionPending      = false;
+	iCollisionRequest      = 0;
+	bTriangleMeshCollision = false;
+	bCookRunning           = false;
+	iCookRequest           = 0;
+	fCookStartTime         = 0.0;
+
 	pTriggerBox = CreateDefaultSubobject<UBoxComponent>(MakeUniqueObjectName(this, UBoxComponent::StaticClass(), "Trigger"));
 	pTriggerBox->SetupAttachment(RootComponent);
 	pTriggerBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -30,7 +51,7 @@ void AFWGChunk::BeginPlay()
 
 void AFWGChunk::setInit(long long ix, long long iy, int32 iSectionindex, bool bAroundcenter)
 {
-	pMeshSection = nullptr;
+	iLodLevel    = -1;
 
 	this->iX = ix;
 	this->iY = iy;
@@ -42,7 +63,7 @@ void AFWGChunk::setInit(long long ix, long long iy, int32 iSectionindex, bool bA
 
 void AFWGChunk::setUpdate(long long ix, long long iy, bool bAroundcenter)
 {
-	clearChunk();
+	iLoadRequest++;
 
 	this->iX = ix;
 	this->iY = iy;
@@ -60,6 +81,31 @@ void AFWGChunk::setChunkSize(int32 iXCount, int32 iYCount)
 	}
 }
 
+void AFWGChunk::setMeshData(FWGChunkData& data)
+{
+	// No copies, data gets the old arrays (the caller gives them back with its result, see FWGChunkJobQueue::recycleResult()).
+
+	Swap(vVertices,     data.vVertices);
+	Swap(vNormals,      data.vNormals);
+	Swap(vUV0,          data.vUV0);
+	Swap(vVertexColors, data.vVertexColors);
+	Swap(vTangents,     data.vTangents);
+
+	vLayerIndex.swap(data.vLayerIndex);
+
+	iMinZVertexIndex = data.iMinZVertexIndex;
+	iMaxZVertexIndex = data.iMaxZVertexIndex;
+
+	iMeshX = iX;
+	iMeshY = iY;
+
+	// Nothing is spawned on the new chunk yet.
+	for (size_t i = 0; i < vChunkCells.size(); i++)
+	{
+		std::fill(vChunkCells[i].begin(), vChunkCells[i].end(), false);
+	}
+}
+
 void AFWGChunk::setChunkMap(FWGenChunkMap* pChunkmap)
 {
 	this->pChunkMap = pChunkmap;
@@ -70,22 +116,19 @@ void AFWGChunk::setOverlapToActors(std::vector<FString> vClasses)
 	vClassesToOverlap = vClasses;
 }
 
-void AFWGChunk::clearChunk()
+FBox AFWGChunk::getMeshBounds(float fSkirtDepth) const
 {
-	vVertices     .Empty();
-	vTriangles    .Empty();
-	vNormals      .Empty();
-	vUV0          .Empty();
-	vVertexColors .Empty();
-	vTangents     .Empty();
-
-	vLayerIndex.clear();
-	vChunkCells.clear();
-}
+	if (vVertices.Num() == 0)
+	{
+		return FBox(ForceInit);
+	}
 
-void AFWGChunk::setMeshSection(FProcMeshSection* pMeshsection)
-{
-	this->pMeshSection  = pMeshsection;
+	// The first vertex has the min X and Y, the last one has the max X and Y.
+	const FVector& vFirst = vVertices[0];
+	const FVector& vLast  = vVertices.Last();
+
+	return FBox(FVector(vFirst.X, vFirst.Y, vVertices[iMinZVertexIndex].Z - fSkirtDepth),
+		FVector(vLast.X, vLast.Y, vVertices[iMaxZVertexIndex].Z));
 }
 
 AFWGChunk::~AFWGChunk()
@@ -112,7 +155,7 @@ void AFWGChunk::OnBeginOverlap(UPrimitiveComponent* OverlappedComp, AActor* Othe
 		{
 			if (OtherActor->GetClass()->GetName() == vClassesToOverlap[i])
 			{
-				pChunkMap->setCurrentChunk(this);
+				pChunkMap->setCurrentChunk(this, OtherActor);
 
 				break;
 			}
@@ -17,7 +17,13 @@
 
 #include "FWGChunk.generated.h"
 
+// Seconds the async cooking of the triangle mesh collision may take, after that the chunk is cooked on the game thread
+// (a failed cooking never replaces the body of the component, see AFWGen::updatePendingCollisions()).
+#define FWG_COLLISION_COOK_TIMEOUT 10.0
+
 class FWGenChunkMap;
+class UBodySetup;
+struct FWGChunkData;
 
 UCLASS()
 class AFWGChunk : public AActor
@@ -29,11 +35,17 @@ public:
 	AFWGChunk();
 
 	void setInit             (long long ix, long long iy, int32 iSectionindex, bool bAroundcenter);
+	// Moves the chunk to other coordinates, it keeps its mesh until setMeshData() (the new one is generated by a chunk job).
 	void setUpdate           (long long ix, long long iy, bool bAroundcenter);
 	void setChunkSize        (int32 iXCount, int32 iYCount);
+	// Takes the generated arrays of the chunk (iX, iY), data gets the old ones.
+	void setMeshData         (FWGChunkData& data);
 	void setChunkMap         (FWGenChunkMap* pChunkmap);
 	void setOverlapToActors  (std::vector<FString> vClasses);
-	void setMeshSection      (FProcMeshSection* pMeshsection);
+
+	// Bounds of the generated vertices (in the space of the mesh component),
+	// fSkirtDepth - how far the skirts of the LOD mesh hang below the lowest vertex.
+	FBox getMeshBounds       (float fSkirtDepth) const;
 
 	~AFWGChunk();
 
@@ -45,8 +57,6 @@ public:
 	void OnEndOverlap(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);*/
 
 
-	FProcMeshSection* pMeshSection;
-
 	UPROPERTY()
 	UBoxComponent* pTriggerBox;
 
@@ -54,30 +64,70 @@ public:
 	TArray<FProcMeshTangent>  vTangents;
 	TArray<FLinearColor>      vVertexColors;
 	TArray<FVector>           vVertices;
-	TArray<int32>             vTriangles;
 	TArray<FVector>           vNormals;
 	TArray<FVector2D>         vUV0;
 
+	// Mesh section of the current LOD level (see FWGChunkLod) or of the adaptive mesh (see FWGChunkRtin),
+	// resampled from the arrays above. Not used if both are disabled, the section then has the arrays above.
+	// No UV and no tangents, the terrain component gets them from the grid.
+	TArray<FLinearColor>      vLodVertexColors;
+	TArray<FVector>           vLodVertices;
+	TArray<FVector>           vLodNormals;
+
+	// Triangles of the adaptive mesh, they depend on the heights (the grid LODs share theirs).
+	TArray<int32>             vLodTriangles;
+
 
 	std::vector<int32>        vLayerIndex;
 	std::vector<std::vector<bool>> vChunkCells;
 
 
+	size_t                    iMinZVertexIndex;
 	size_t                    iMaxZVertexIndex;
 
 
 	long long                 iX;
 	long long                 iY;
 
+	// Chunk the mesh and the spawned objects are for, not iX, iY while the chunk is generated for its new coordinates.
+	long long                 iMeshX;
+	long long                 iMeshY;
+
+	// Incremented by setUpdate(), the result of a chunk job for the older coordinates is thrown away.
+	uint32                    iLoadRequest;
+
 
 	int32                     iSectionIndex;
 
+	// LOD level the mesh section was created with, -1 if the section has the full resolution arrays.
+	int32                     iLodLevel;
+
+	// The collision of the chunk is attached / is being built (see AFWGen::updateChunkCollision()).
+	bool                      bHasCollision;
+	bool                      bCollisionPending;
+
+	// Incremented by every change of the collision, a heightfield built for an older value is thrown away.
+	uint32                    iCollisionRequest;
+
+	// The collision is (being) cooked into the collision component of the section: always without the heightfield
+	// collision, with it after the heightfield of the chunk failed to build.
+	bool                      bTriangleMeshCollision;
+
+	// An async cooking of the collision component is running, only one at a time: the component takes the body
+	// of any finished cooking, so the next one waits (see AFWGen::updatePendingCollisions()).
+	// iCookRequest - iCollisionRequest the running one was started for, fCookStartTime - when it was started.
+	bool                      bCookRunning;
+	uint32                    iCookRequest;
+	double                    fCookStartTime;
+
+	// Body of the collision component that was replaced when the running cooking started,
+	// the cooking is finished when the component has another.
+	TWeakObjectPtr<UBodySetup> pReplacedBodySetup;
+
 protected:
 
 	virtual void BeginPlay() override;
 
-	void clearChunk          ();
-
 
 	std::vector<FString>      vClassesToOverlap;
 
@@ -0,0 +1,273 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkBorderCache.h"
+
+// STL
+#include <set>
+
+// Custom
+#include "FWGChunk.h"
+
+FWGChunkBorder::FWGChunkBorder(int32 iRowCount, int32 iColumnCount)
+	: pLeft(nullptr), pRight(nullptr), pBottom(nullptr), pTop(nullptr),
+	iRowCount(iRowCount), iColumnCount(iColumnCount)
+{
+	for (int32 i = 0; i < 4; i++)
+	{
+		vCorners[i] = nullptr;
+	}
+}
+
+const FWGBorderVertex* FWGChunkBorder::find(int32 i, int32 j) const
+{
+	const bool bFirstRow    = (i == 0);
+	const bool bLastRow     = (i == iRowCount - 1);
+	const bool bFirstColumn = (j == 0);
+	const bool bLastColumn  = (j == iColumnCount - 1);
+
+	if ((bFirstRow || bLastRow) && (bFirstColumn || bLastColumn))
+	{
+		return vCorners[(bLastRow ? 2 : 0) + (bLastColumn ? 1 : 0)];
+	}
+
+	const std::vector<FWGBorderVertex>* pEdge = nullptr;
+	int32 iIndex = 0;
+
+	if (bFirstColumn || bLastColumn)
+	{
+		pEdge  = bFirstColumn ? pLeft : pRight;
+		iIndex = i - 1;
+	}
+	else if (bFirstRow || bLastRow)
+	{
+		pEdge  = bFirstRow ? pBottom : pTop;
+		iIndex = j - 1;
+	}
+
+	return pEdge ? &(*pEdge)[iIndex] : nullptr;
+}
+
+bool FWGChunkBorder::isRowCached(int32 i) const
+{
+	const std::vector<FWGBorderVertex>* pEdge = (i == 0) ? pBottom : pTop;
+	const int32 iFirstCorner = (i == 0) ? 0 : 2;
+
+	return pEdge && vCorners[iFirstCorner] && vCorners[iFirstCorner + 1];
+}
+
+bool FWGChunkBorder::isColumnCached(int32 j) const
+{
+	const std::vector<FWGBorderVertex>* pEdge = (j == 0) ? pLeft : pRight;
+	const int32 iFirstCorner = (j == 0) ? 0 : 1;
+
+	return pEdge && vCorners[iFirstCorner] && vCorners[iFirstCorner + 2];
+}
+
+FWGChunkBorder FWGChunkBorder::copy() const
+{
+	FWGChunkBorder border(iRowCount, iColumnCount);
+
+	copyInto(border);
+
+	return border;
+}
+
+void FWGChunkBorder::copyInto(FWGChunkBorder& border) const
+{
+	// The storage of a border no other border shares keeps the memory of its arrays.
+	std::shared_ptr<FStorage> pCopy = std::move(border.pStorage);
+
+	if ((pCopy == nullptr) || (pCopy.use_count() != 1))
+	{
+		pCopy = std::make_shared<FStorage>();
+	}
+
+	border = FWGChunkBorder(iRowCount, iColumnCount);
+
+	const std::vector<FWGBorderVertex>*  vEdges[4]     = { pLeft, pRight, pBottom, pTop };
+	const std::vector<FWGBorderVertex>** vCopyEdges[4] = { &border.pLeft, &border.pRight, &border.pBottom, &border.pTop };
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		if (vEdges[i])
+		{
+			pCopy->vEdges[i] = *vEdges[i];
+			*vCopyEdges[i]   = &pCopy->vEdges[i];
+		}
+
+		if (vCorners[i])
+		{
+			pCopy->vCorners[i]  = *vCorners[i];
+			border.vCorners[i] = &pCopy->vCorners[i];
+		}
+	}
+
+	border.pStorage = pCopy;
+}
+
+void FWGChunkBorder::copyTo(AFWGChunk* pChunk) const
+{
+	auto copyVertex = [&](int32 i, int32 j)
+	{
+		const FWGBorderVertex* pVertex = find(i, j);
+
+		if (pVertex == nullptr)
+		{
+			return;
+		}
+
+		const int32 iVertexIndex = i * iColumnCount + j;
+
+		pChunk->vVertices[iVertexIndex]     = pVertex->vLocation;
+		pChunk->vNormals[iVertexIndex]      = pVertex->vNormal;
+		pChunk->vTangents[iVertexIndex]     = pVertex->tangent;
+		pChunk->vVertexColors[iVertexIndex] = pVertex->color;
+		pChunk->vLayerIndex[iVertexIndex]   = pVertex->iLayerIndex;
+	};
+
+	for (int32 j = 0; j < iColumnCount; j++)
+	{
+		copyVertex(0, j);
+		copyVertex(iRowCount - 1, j);
+	}
+
+	for (int32 i = 1; i < iRowCount - 1; i++)
+	{
+		copyVertex(i, 0);
+		copyVertex(i, iColumnCount - 1);
+	}
+}
+
+FWGChunkBorder FWGChunkBorderCache::getBorder(long long iX, long long iY, int32 iRowCount, int32 iColumnCount) const
+{
+	FWGChunkBorder border(iRowCount, iColumnCount);
+
+	auto findEdge = [](const std::map<FChunkKey, std::vector<FWGBorderVertex>>& mEdges, long long iX, long long iY)
+		-> const std::vector<FWGBorderVertex>*
+	{
+		const auto it = mEdges.find(FChunkKey(iX, iY));
+
+		return (it != mEdges.end()) ? &it->second : nullptr;
+	};
+
+	border.pLeft   = findEdge(mLeftEdges,   iX,     iY);
+	border.pRight  = findEdge(mLeftEdges,   iX + 1, iY);
+	border.pBottom = findEdge(mBottomEdges, iX,     iY);
+	border.pTop    = findEdge(mBottomEdges, iX,     iY + 1);
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		const auto it = mCorners.find(FChunkKey(iX + (i % 2), iY + (i / 2)));
+
+		if (it != mCorners.end())
+		{
+			border.vCorners[i] = &it->second;
+		}
+	}
+
+	return border;
+}
+
+void FWGChunkBorderCache::addChunk(const AFWGChunk* pChunk, int32 iRowCount, int32 iColumnCount)
+{
+	const long long iX = pChunk->iX;
+	const long long iY = pChunk->iY;
+
+	auto addEdge = [&](std::map<FChunkKey, std::vector<FWGBorderVertex>>& mEdges, long long iEdgeX, long long iEdgeY,
+		int32 iFirstVertex, int32 iStep, int32 iCount)
+	{
+		std::vector<FWGBorderVertex>& vEdge = mEdges[FChunkKey(iEdgeX, iEdgeY)];
+
+		if (vEdge.empty() == false)
+		{
+			// Generated by the neighbour.
+			return;
+		}
+
+		vEdge.reserve(iCount);
+
+		for (int32 k = 0; k < iCount; k++)
+		{
+			vEdge.push_back(makeVertex(pChunk, iFirstVertex + k * iStep));
+		}
+	};
+
+	const int32 iLastRowStart = (iRowCount - 1) * iColumnCount;
+
+	addEdge(mLeftEdges,   iX,     iY,     iColumnCount,                    iColumnCount, iRowCount - 2);
+	addEdge(mLeftEdges,   iX + 1, iY,     iColumnCount + iColumnCount - 1, iColumnCount, iRowCount - 2);
+	addEdge(mBottomEdges, iX,     iY,     1,                               1,            iColumnCount - 2);
+	addEdge(mBottomEdges, iX,     iY + 1, iLastRowStart + 1,               1,            iColumnCount - 2);
+
+	const int32 vCornerVertices[4] = { 0, iColumnCount - 1, iLastRowStart, iLastRowStart + iColumnCount - 1 };
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		// Does nothing if the corner is already there.
+		mCorners.insert(std::make_pair(FChunkKey(iX + (i % 2), iY + (i / 2)), makeVertex(pChunk, vCornerVertices[i])));
+	}
+}
+
+void FWGChunkBorderCache::removeUnused(const std::vector<AFWGChunk*>& vLoadedChunks)
+{
+	std::set<FChunkKey> loaded;
+
+	for (size_t i = 0; i < vLoadedChunks.size(); i++)
+	{
+		loaded.insert(FChunkKey(vLoadedChunks[i]->iX, vLoadedChunks[i]->iY));
+	}
+
+	auto isLoaded = [&](long long iX, long long iY)
+	{
+		return loaded.find(FChunkKey(iX, iY)) != loaded.end();
+	};
+
+	for (auto it = mLeftEdges.begin(); it != mLeftEdges.end(); )
+	{
+		// Right edge of the left neighbour.
+		const bool bUsed = isLoaded(it->first.first, it->first.second) || isLoaded(it->first.first - 1, it->first.second);
+
+		it = bUsed ? std::next(it) : mLeftEdges.erase(it);
+	}
+
+	for (auto it = mBottomEdges.begin(); it != mBottomEdges.end(); )
+	{
+		// Top edge of the bottom neighbour.
+		const bool bUsed = isLoaded(it->first.first, it->first.second) || isLoaded(it->first.first, it->first.second - 1);
+
+		it = bUsed ? std::next(it) : mBottomEdges.erase(it);
+	}
+
+	for (auto it = mCorners.begin(); it != mCorners.end(); )
+	{
+		const long long iX = it->first.first;
+		const long long iY = it->first.second;
+
+		const bool bUsed = isLoaded(iX, iY) || isLoaded(iX - 1, iY) || isLoaded(iX, iY - 1) || isLoaded(iX - 1, iY - 1);
+
+		it = bUsed ? std::next(it) : mCorners.erase(it);
+	}
+}
+
+void FWGChunkBorderCache::clear()
+{
+	mLeftEdges.clear();
+	mBottomEdges.clear();
+	mCorners.clear();
+}
+
+FWGBorderVertex FWGChunkBorderCache::makeVertex(const AFWGChunk* pChunk, int32 iVertexIndex)
+{
+	FWGBorderVertex vertex;
+
+	vertex.vLocation   = pChunk->vVertices[iVertexIndex];
+	vertex.vNormal     = pChunk->vNormals[iVertexIndex];
+	vertex.tangent     = pChunk->vTangents[iVertexIndex];
+	vertex.color       = pChunk->vVertexColors[iVertexIndex];
+	vertex.iLayerIndex = pChunk->vLayerIndex[iVertexIndex];
+
+	return vertex;
+}
@@ -0,0 +1,115 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// UE
+#include "ProceduralMeshComponent.h"
+
+// STL
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+class AFWGChunk;
+
+
+// Everything generateChunk() writes for one vertex.
+struct FWGBorderVertex
+{
+	FVector           vLocation;
+	FVector           vNormal;
+	FProcMeshTangent  tangent;
+	FLinearColor      color;
+	int32             iLayerIndex;
+};
+
+// Border vertices of one chunk that its neighbours have already generated.
+// Vertex (i, j) of the chunk is row i, column j, as in generateChunk().
+class FWGChunkBorder
+{
+public:
+
+	FWGChunkBorder(int32 iRowCount, int32 iColumnCount);
+
+	// nullptr if the vertex is not shared or not generated yet.
+	const FWGBorderVertex* find(int32 i, int32 j) const;
+
+	// All vertices of the row / column are cached.
+	bool isRowCached   (int32 i) const;
+	bool isColumnCached(int32 j) const;
+
+	// Border that has its own copy of the vertices, stays valid when the cache changes (for the chunk jobs).
+	FWGChunkBorder copy  () const;
+
+	// Same as copy() into border, the arrays of the copy border had (if no other border shares them) are reused
+	// (see FWGChunkJobQueue::newJob()).
+	void           copyInto (FWGChunkBorder& border) const;
+
+	// Writes the cached vertices over the border of the chunk. For a chunk that was generated while
+	// its neighbour was, so that the neighbour that was committed first decides their common vertices.
+	void           copyTo(AFWGChunk* pChunk) const;
+
+
+	// Without the corners.
+	const std::vector<FWGBorderVertex>* pLeft;    // j = 0
+	const std::vector<FWGBorderVertex>* pRight;   // j = iColumnCount - 1
+	const std::vector<FWGBorderVertex>* pBottom;  // i = 0
+	const std::vector<FWGBorderVertex>* pTop;     // i = iRowCount - 1
+
+	// (0, 0), (0, last), (last, 0), (last, last).
+	const FWGBorderVertex* vCorners[4];
+
+	// Not const so that a border can be assigned (the jobs reuse theirs).
+	int32 iRowCount;
+	int32 iColumnCount;
+
+private:
+
+	struct FStorage
+	{
+		std::vector<FWGBorderVertex> vEdges[4];    // pLeft, pRight, pBottom, pTop
+		FWGBorderVertex              vCorners[4];
+	};
+
+	// Only set by copy() / copyInto().
+	std::shared_ptr<FStorage> pStorage;
+};
+
+// Border strips of the generated chunks, so that a chunk copies the vertices it shares with its
+// neighbours instead of generating them again and the borders match exactly.
+// An edge is stored once for the two chunks that share it (as the left / bottom edge of the
+// chunk with the bigger coordinate), a corner once for its four chunks (as the corner (0, 0)).
+class FWGChunkBorderCache
+{
+public:
+
+	// Cached border of the chunk (iX, iY). Valid until the next addChunk() / removeUnused() / clear().
+	FWGChunkBorder getBorder   (long long iX, long long iY, int32 iRowCount, int32 iColumnCount) const;
+
+	// Stores the border vertices of the generated chunk that are not cached yet.
+	void           addChunk    (const AFWGChunk* pChunk, int32 iRowCount, int32 iColumnCount);
+
+	// Removes the edges and the corners that none of the loaded chunks has.
+	void           removeUnused(const std::vector<AFWGChunk*>& vLoadedChunks);
+
+	void           clear       ();
+
+private:
+
+	typedef std::pair<long long, long long> FChunkKey;
+
+
+	static FWGBorderVertex makeVertex(const AFWGChunk* pChunk, int32 iVertexIndex);
+
+
+	std::map<FChunkKey, std::vector<FWGBorderVertex>>  mLeftEdges;
+	std::map<FChunkKey, std::vector<FWGBorderVertex>>  mBottomEdges;
+	std::map<FChunkKey, FWGBorderVertex>               mCorners;
+};
@@ -0,0 +1,1035 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkGenerator.h"
+
+// STL
+#include <type_traits>
+
+// Custom
+#include "FWGen.h"
+#include "FWGNoise.h"
+#include "FWGMultiResolutionNoise.h"
+#include "FWGChunkBorderCache.h"
+#include "FWGDomainWarp.h"
+#include "FWGBiomeMap.h"
+#include "FWGChunkIndexBuffer.h"
+#include "FWGChunkLod.h"
+
+FWGChunkGenerator::FWGChunkGenerator(const AFWGen* pGen, int32 iGeneratedSeed, const std::shared_ptr<const FWGNoiseContext>& pNoiseContext,
+	const std::shared_ptr<FWGBiomeMap>& pBiomeMap)
+	: ChunkPieceRowCount(pGen->ChunkPieceRowCount), ChunkPieceColumnCount(pGen->ChunkPieceColumnCount),
+	ChunkPieceSizeX(pGen->ChunkPieceSizeX), ChunkPieceSizeY(pGen->ChunkPieceSizeY),
+	GenerationFrequency(pGen->GenerationFrequency), GenerationMaxZFromActorZ(pGen->GenerationMaxZFromActorZ),
+	InvertWorld(pGen->InvertWorld), SinglePrecisionGeneration(pGen->SinglePrecisionGeneration),
+	MultiResolutionMaxError(pGen->MultiResolutionMaxError), DomainWarpStrength(pGen->DomainWarpStrength),
+	DomainWarpFrequency(pGen->DomainWarpFrequency),
+	FirstMaterialMaxRelativeHeight(pGen->FirstMaterialMaxRelativeHeight), SecondMaterialMaxRelativeHeight(pGen->SecondMaterialMaxRelativeHeight),
+	MaterialHeightMaxDeviation(pGen->MaterialHeightMaxDeviation), TerrainCutHeightFromActorZ(pGen->TerrainCutHeightFromActorZ),
+	SecondMaterialUnderWater(pGen->SecondMaterialUnderWater), ZWaterLevelInWorld(pGen->ZWaterLevelInWorld),
+	ApplyGroundMaterialBlend(pGen->ApplyGroundMaterialBlend), ApplySlopeDependentBlend(pGen->ApplySlopeDependentBlend),
+	FirstMaterialOnSecondProbability(pGen->FirstMaterialOnSecondProbability), FirstMaterialOnThirdProbability(pGen->FirstMaterialOnThirdProbability),
+	SecondMaterialOnFirstProbability(pGen->SecondMaterialOnFirstProbability), SecondMaterialOnThirdProbability(pGen->SecondMaterialOnThirdProbability),
+	ThirdMaterialOnFirstProbability(pGen->ThirdMaterialOnFirstProbability), ThirdMaterialOnSecondProbability(pGen->ThirdMaterialOnSecondProbability),
+	IncreasedMaterialBlendProbability(pGen->IncreasedMaterialBlendProbability), MinSlopeHeightMultiplier(pGen->MinSlopeHeightMultiplier),
+	vActorLocation(pGen->GetActorLocation()), iGeneratedSeed(iGeneratedSeed),
+	pNoiseContext(pNoiseContext), pBiomeMap(pBiomeMap)
+{
+	pChunkKernel = selectChunkKernel();
+}
+
+bool FWGChunkGenerator::generate(FWGChunkData& data, long long iX, long long iY, const FWGChunkBorder& border,
+	const std::function<bool()>& isCancelled) const
+{
+	// We ++ here because we start to make polygons from 2nd row
+	const int32 iCorrectedRowCount    = ChunkPieceRowCount + 1;
+	const int32 iCorrectedColumnCount = ChunkPieceColumnCount + 1;
+
+
+
+	// Perlin Noise setup
+
+	const double fx = ((iCorrectedColumnCount - 1) * ChunkPieceSizeX) / GenerationFrequency;
+	const double fy = ((iCorrectedRowCount - 1) * ChunkPieceSizeY) / GenerationFrequency;
+
+
+
+	// Prepare chunk coordinates
+
+	float fChunkX = vActorLocation.X;
+	float fChunkY = vActorLocation.Y;
+
+	if (iX != 0)
+	{
+		// Left or right chunk
+
+		fChunkX += (iX * ChunkPieceColumnCount * ChunkPieceSizeX);
+	}
+
+	if (iY != 0)
+	{
+		// Top or bottom chunk
+
+		fChunkY += (iY * ChunkPieceRowCount * ChunkPieceSizeY);
+	}
+
+
+
+	// Generation params
+
+	float fStartX = fChunkX - ((iCorrectedColumnCount - 1) * ChunkPieceSizeX) / 2;
+	float fStartY = fChunkY - ((iCorrectedRowCount    - 1) * ChunkPieceSizeY) / 2;
+
+	FVector vStartLocation(fStartX, fStartY, vActorLocation.Z);
+
+
+
+	// Generation
+
+	const int32 iVertexCount = iCorrectedRowCount * iCorrectedColumnCount;
+
+	data.vVertices     .Reset(iVertexCount);
+	data.vNormals      .Reset(iVertexCount);
+	data.vUV0          .Reset(iVertexCount);
+	data.vVertexColors .Reset(iVertexCount);
+	data.vTangents     .Reset(iVertexCount);
+
+	data.vLayerIndex.clear();
+	data.vLayerIndex.reserve(iVertexCount);
+
+	// The climate of the 4 corners of the chunk, the vertices interpolate it.
+	FWGChunkBiome biome;
+
+	if (pBiomeMap)
+	{
+		biome = pBiomeMap->getChunkBiome(iX, iY);
+	}
+
+	if (isCancelled && isCancelled())
+	{
+		return false;
+	}
+
+	(this->*pChunkKernel)(data, iX, iY, *pNoiseContext, border, pBiomeMap ? &biome : nullptr, vStartLocation, fx, fy);
+
+	if (ApplyGroundMaterialBlend)
+	{
+		if (isCancelled && isCancelled())
+		{
+			return false;
+		}
+
+		blendWorldMaterialsMore(data, iX, iY);
+	}
+
+	if (ApplySlopeDependentBlend)
+	{
+		if (isCancelled && isCancelled())
+		{
+			return false;
+		}
+
+		applySlopeDependentBlend(data);
+	}
+
+	return true;
+}
+
+bool FWGChunkGenerator::generateHorizon(FWGChunkData& data, long long iX, long long iY, int32 iResolution, const FWGChunkIndexBuffer& indexBuffer,
+	const std::function<bool()>& isCancelled) const
+{
+	if (isCancelled && isCancelled())
+	{
+		return false;
+	}
+
+	const FWGNoiseContext& noise = *pNoiseContext;
+
+	const int32 iVertexCount = indexBuffer.getVertexCount();
+
+	// Same noise coordinates as generate(), the chunk side has iResolution - 1 pieces instead of ChunkPieceColumnCount.
+
+	const double fChunkSizeX = ChunkPieceColumnCount * ChunkPieceSizeX;
+	const double fChunkSizeY = ChunkPieceRowCount    * ChunkPieceSizeY;
+
+	const double fx = fChunkSizeX / GenerationFrequency;
+	const double fy = fChunkSizeY / GenerationFrequency;
+
+	const double fPieceSizeX = fChunkSizeX / (iResolution - 1);
+	const double fPieceSizeY = fChunkSizeY / (iResolution - 1);
+
+	const double fOriginX = (vActorLocation.X - fChunkSizeX / 2.0) / fx;
+	const double fOriginY = (vActorLocation.Y - fChunkSizeY / 2.0) / fy;
+
+	const double fStartX  = vActorLocation.X + iX * fChunkSizeX - fChunkSizeX / 2.0;
+	const double fStartY  = vActorLocation.Y + iY * fChunkSizeY - fChunkSizeY / 2.0;
+
+	// Global vertex indices of the horizon grid, so that neighbour horizon chunks sample the same border.
+	const long long iFirstColumn = iX * (iResolution - 1);
+	const long long iFirstRow    = iY * (iResolution - 1);
+
+	// The warp field is interpolated between every FWG_DOMAIN_WARP_LATTICE_STEP horizon vertices, a coarser lattice
+	// than the one of the full resolution chunks, only its finest details are lost.
+	TFWGDomainWarp<double> domainWarp(noise, iResolution, iResolution, iFirstColumn, iFirstRow, fOriginX, fOriginY,
+		fPieceSizeX / fx, fPieceSizeY / fy, DomainWarpStrength / fx, DomainWarpStrength / fy, DomainWarpFrequency);
+
+	static thread_local std::vector<double> vNoiseX;
+	static thread_local std::vector<double> vNoiseRow;
+	static thread_local std::vector<double> vNoiseDx;
+	static thread_local std::vector<double> vNoiseDy;
+
+	vNoiseX  .resize(iResolution);
+	vNoiseRow.resize(iResolution);
+	vNoiseDx .resize(iResolution);
+	vNoiseDy .resize(iResolution);
+
+	for (int32 j = 0; j < iResolution; j++)
+	{
+		vNoiseX[j] = fOriginX + (iFirstColumn + j) * fPieceSizeX / fx;
+	}
+
+	FWGChunkBiome biome;
+
+	if (pBiomeMap)
+	{
+		biome = pBiomeMap->getChunkBiome(iX, iY);
+	}
+
+	// No random material height deviation and no material blends, so that the borders of the horizon chunks match.
+	std::mt19937_64 rnd(iGeneratedSeed);
+	std::uniform_real_distribution<float> urd(0.0f, 0.0f);
+
+	const float  fActorZ     = vActorLocation.Z;
+	const double fCutHeight  = TerrainCutHeightFromActorZ;
+
+	// Biome height scale along x and y in noise units, and the noise derivative to the slope of Z.
+	const double fBiomeColumnsX = fChunkSizeX / fx;
+	const double fBiomeRowsY    = fChunkSizeY / fy;
+
+	const double fSlopeScaleX = GenerationMaxZFromActorZ / fx;
+	const double fSlopeScaleY = GenerationMaxZFromActorZ / fy;
+
+	// The horizon components take the UV and the tangents from the grid (see AFWGen::commitHorizonChunk()).
+	data.vVertices     .SetNumUninitialized(iVertexCount, false);
+	data.vNormals      .SetNumUninitialized(iVertexCount, false);
+	data.vVertexColors .SetNumUninitialized(iVertexCount, false);
+
+	data.vUV0     .Reset();
+	data.vTangents.Reset();
+
+	data.vLayerIndex.clear();
+
+	data.iMinZVertexIndex = 0;
+	data.iMaxZVertexIndex = 0;
+
+	for (int32 i = 0; i < iResolution; i++)
+	{
+		const double y = fOriginY + (iFirstRow + i) * fPieceSizeY / fy;
+
+		if (domainWarp.isEnabled())
+		{
+			domainWarp.sampleRow(i, vNoiseX.data(), y, vNoiseRow.data(), vNoiseDx.data(), vNoiseDy.data());
+		}
+		else
+		{
+			noise.octaveNoise0_1RowDerivatives(vNoiseX.data(), y, iResolution, vNoiseRow.data(), vNoiseDx.data(), vNoiseDy.data());
+		}
+
+		const float fV = static_cast<float>(i) / (iResolution - 1);
+
+		for (int32 j = 0; j < iResolution; j++)
+		{
+			const float fU = static_cast<float>(j) / (iResolution - 1);
+
+			double fMaterialHeightShift = 0.0;
+
+			if (pBiomeMap)
+			{
+				// Same as the bilinear height scale of FWGChunkGenerator::generateChunkVertices().
+
+				const float* pScale = biome.vHeightScale;
+
+				const double fScale   = FWGChunkBiome::interpolate(pScale, fU, fV);
+				const double fScaleDx = (((1.0f - fV) * pScale[1] + fV * pScale[3]) - ((1.0f - fV) * pScale[0] + fV * pScale[2])) / fBiomeColumnsX;
+				const double fScaleDy = (((1.0f - fU) * pScale[2] + fU * pScale[3]) - ((1.0f - fU) * pScale[0] + fU * pScale[1])) / fBiomeRowsY;
+
+				vNoiseDx[j]  = vNoiseDx[j] * fScale + vNoiseRow[j] * fScaleDx;
+				vNoiseDy[j]  = vNoiseDy[j] * fScale + vNoiseRow[j] * fScaleDy;
+				vNoiseRow[j] = vNoiseRow[j] * fScale;
+
+				fMaterialHeightShift = FWGChunkBiome::interpolate(biome.vMaterialHeightShift, fU, fV);
+			}
+
+			double generatedValue = FMath::Min(vNoiseRow[j], fCutHeight);
+
+			double fSlopeX = (vNoiseRow[j] < fCutHeight) ? vNoiseDx[j] * fSlopeScaleX : 0.0;
+			double fSlopeY = (vNoiseRow[j] < fCutHeight) ? vNoiseDy[j] * fSlopeScaleY : 0.0;
+
+			if (InvertWorld)
+			{
+				generatedValue = 1 - generatedValue;
+
+				fSlopeX = -fSlopeX;
+				fSlopeY = -fSlopeY;
+			}
+
+			float fLayer = 0.0f;
+
+			if (SecondMaterialUnderWater && (generatedValue < (ZWaterLevelInWorld + 0.005f)))
+			{
+				fLayer = 0.5f;
+			}
+			else
+			{
+				pickVertexMaterial(generatedValue, &urd, &rnd, &fLayer, fMaterialHeightShift);
+			}
+
+			const int32 k = i * iResolution + j;
+
+			data.vVertices     [k] = FVector(fStartX + j * fPieceSizeX, fStartY + i * fPieceSizeY, fActorZ + GenerationMaxZFromActorZ * generatedValue);
+			data.vNormals      [k] = FVector(-fSlopeX, -fSlopeY, 1.0f).GetSafeNormal();
+			data.vVertexColors [k] = FLinearColor(0.0f, 0.0f, 0.0f, fLayer);
+		}
+	}
+
+	// The crack to a full resolution chunk can be as deep as the terrain, the skirt goes down to the lowest terrain
+	// (the actor Z). Only the part in the crack is visible, the rest is under the ground of the full resolution chunk.
+
+	const float fSkirtDepth = FWG_LOD_MIN_SKIRT_DEPTH * FMath::Min(ChunkPieceSizeX, ChunkPieceSizeY);
+
+	const TArray<int32>& vSkirtVertices = indexBuffer.getSkirtVertices();
+
+	for (int32 s = 0; s < vSkirtVertices.Num(); s++)
+	{
+		const int32 iSource = vSkirtVertices[s];
+		const int32 k       = iResolution * iResolution + s;
+
+		data.vVertices     [k] = data.vVertices     [iSource];
+		data.vVertices     [k].Z = FMath::Min(data.vVertices[iSource].Z, fActorZ) - fSkirtDepth;
+		data.vNormals      [k] = data.vNormals      [iSource];
+		data.vVertexColors [k] = data.vVertexColors [iSource];
+	}
+
+	return true;
+}
+
+float FWGChunkGenerator::pickVertexMaterial(double height, std::uniform_real_distribution<float>* pUrd, std::mt19937_64* pRnd, float* pfLayerTypeWithoutRnd,
+	float fMaterialHeightShift) const
+{
+	std::uniform_real_distribution<float> urd_mat(0.005f, 1.0f);
+	std::uniform_int_distribution<int> urd_bool(0, 1);
+
+
+	// The biome moves both material heights.
+	float fDiviation = (*pUrd)(*pRnd) + fMaterialHeightShift;
+
+	float fVertexColor = 0.0f; // apply first material to the vertex
+
+	if ( (height >= (FirstMaterialMaxRelativeHeight + fDiviation)) 
+		&& (height <= (SecondMaterialMaxRelativeHeight + fDiviation)) )
+	{
+		fVertexColor = 0.5f; // apply second material to the vertex
+
+		if (pfLayerTypeWithoutRnd)
+		{
+			*pfLayerTypeWithoutRnd = fVertexColor;
+		}
+
+		float fFirstProb = urd_mat(*pRnd);
+		float fThirdProb  = urd_mat(*pRnd);
+
+		bool bPickFirst = false, bPickThird = false;
+
+		if (fFirstProb <= FirstMaterialOnSecondProbability)
+		{
+			bPickFirst = true;
+		}
+
+		if (fThirdProb <= ThirdMaterialOnSecondProbability)
+		{
+			bPickThird = true;
+		}
+
+		if (bPickFirst && bPickThird)
+		{
+			if (urd_bool(*pRnd))
+			{
+				// Pick Third
+				fVertexColor = 1.0f; // apply third material to the vertex
+			}
+			else
+			{
+				// Pick First
+				fVertexColor = 0.0f; // apply first material to the vertex
+			}
+		}
+		else
+		{
+			if (bPickFirst)
+			{
+				fVertexColor = 0.0f; // apply first material to the vertex
+			}
+
+			if (bPickThird)
+			{
+				fVertexColor = 1.0f; // apply third material to the vertex
+			}
+		}
+	}
+	else if (height >= (SecondMaterialMaxRelativeHeight + fDiviation))
+	{
+		fVertexColor = 1.0f; // apply third material to the vertex
+
+		if (pfLayerTypeWithoutRnd)
+		{
+			*pfLayerTypeWithoutRnd = fVertexColor;
+		}
+
+		float fFirstProb  = urd_mat(*pRnd);
+		float fSecondProb = urd_mat(*pRnd);
+
+		bool bPickFirst = false, bPickSecond = false;
+
+		if (fFirstProb <= FirstMaterialOnThirdProbability)
+		{
+			bPickFirst = true;
+		}
+
+		if (fSecondProb <= SecondMaterialOnThirdProbability)
+		{
+			bPickSecond = true;
+		}
+
+		if (bPickFirst && bPickSecond)
+		{
+			if (urd_bool(*pRnd))
+			{
+				// Pick Third
+				fVertexColor = 0.5f; // apply second material to the vertex
+			}
+			else
+			{
+				// Pick First
+				fVertexColor = 0.0f; // apply first material to the vertex
+			}
+		}
+		else
+		{
+			if (bPickFirst)
+			{
+				fVertexColor = 0.0f; // apply first material to the vertex
+			}
+
+			if (bPickSecond)
+			{
+				fVertexColor = 0.5f; // apply second material to the vertex
+			}
+		}
+	}
+	else
+	{
+		// first material
+
+		fVertexColor = 0.0f;
+
+		if (pfLayerTypeWithoutRnd)
+		{
+			*pfLayerTypeWithoutRnd = fVertexColor;
+		}
+
+		float fSecondProb = urd_mat(*pRnd);
+		float fThirdProb  = urd_mat(*pRnd);
+
+		bool bPickSecond = false, bPickThird = false;
+
+		if (fSecondProb <= SecondMaterialOnFirstProbability)
+		{
+			bPickSecond = true;
+		}
+
+		if (fThirdProb <= ThirdMaterialOnFirstProbability)
+		{
+			bPickThird = true;
+		}
+
+		if (bPickSecond && bPickThird)
+		{
+			if (urd_bool(*pRnd))
+			{
+				// Pick Third
+				fVertexColor = 1.0f; // apply third material to the vertex
+			}
+			else
+			{
+				// Pick Second
+				fVertexColor = 0.5f; // apply second material to the vertex
+			}
+		}
+		else
+		{
+			if (bPickSecond)
+			{
+				fVertexColor = 0.5f; // apply second material to the vertex
+			}
+
+			if (bPickThird)
+			{
+				fVertexColor = 1.0f; // apply third material to the vertex
+			}
+		}
+	}
+
+	return fVertexColor;
+}
+
+template <bool bInvert, bool bUnderwaterSecondMaterial, typename TReal>
+void FWGChunkGenerator::generateChunkVertices(FWGChunkData& data, long long iX, long long iY, const FWGNoiseContext& noise,
+	const FWGChunkBorder& border, const FWGChunkBiome* pBiome, FVector vStartLocation, double fx, double fy) const
+{
+	// We ++ here because we start to make polygons from 2nd row
+	const int32 iCorrectedRowCount = ChunkPieceRowCount + 1;
+	const int32 iCorrectedColumnCount = ChunkPieceColumnCount + 1;
+
+	const float fActorZ = vActorLocation.Z;
+	const TReal fCutHeight = TerrainCutHeightFromActorZ;
+
+	FVector vPrevLocation = vStartLocation;
+
+
+
+	// Prepare random for vectex color
+
+	std::mt19937_64 rnd(iGeneratedSeed);
+	std::uniform_real_distribution<float> urd(-MaterialHeightMaxDeviation, MaterialHeightMaxDeviation);
+
+
+
+	// Noise input is the same for every row, only Y changes.
+	// X is accumulated exactly like vPrevLocation.X below so that the values stay the same.
+
+	// The rows are kept between the chunks (one set per thread), so that they are not allocated for every chunk.
+
+	static thread_local std::vector<TReal> vNoiseX;
+	static thread_local std::vector<TReal> vNoiseRow;
+
+	// Partial derivatives of the noise by its x and y, give the normals and tangents.
+	static thread_local std::vector<TReal> vNoiseDx;
+	static thread_local std::vector<TReal> vNoiseDy;
+
+	vNoiseX  .resize(iCorrectedColumnCount);
+	vNoiseRow.resize(iCorrectedColumnCount);
+	vNoiseDx .resize(iCorrectedColumnCount);
+	vNoiseDy .resize(iCorrectedColumnCount);
+
+	// Slowly changing octaves on coarser grids, if MultiResolutionMaxError allows it.
+	// Global vertex indices and noise coordinates are counted from the first vertex of the chunk at (0, 0).
+
+	const double fOriginX = (vActorLocation.X - (iCorrectedColumnCount - 1) * ChunkPieceSizeX / 2.0) / fx;
+	const double fOriginY = (vActorLocation.Y - (iCorrectedRowCount    - 1) * ChunkPieceSizeY / 2.0) / fy;
+
+	// The coarse grids assume unwarped coordinates, so not used with the domain warping.
+	const double fMaxNoiseError = ((GenerationMaxZFromActorZ > 0.0f) && (DomainWarpStrength <= 0.0f))
+		? (MultiResolutionMaxError / GenerationMaxZFromActorZ) : 0.0;
+
+	const TFWGMultiResolutionNoise<TReal> multiResolutionNoise(noise, vNoiseX.data(), iCorrectedColumnCount, iCorrectedRowCount,
+		iX * ChunkPieceColumnCount, iY * ChunkPieceRowCount, fOriginX, fOriginY,
+		ChunkPieceSizeX / fx, ChunkPieceSizeY / fy, fMaxNoiseError);
+
+	// Sample coordinates moved by a low frequency field, if DomainWarpStrength is set.
+
+	TFWGDomainWarp<TReal> domainWarp(noise, iCorrectedColumnCount, iCorrectedRowCount,
+		iX * ChunkPieceColumnCount, iY * ChunkPieceRowCount, fOriginX, fOriginY,
+		ChunkPieceSizeX / fx, ChunkPieceSizeY / fy, DomainWarpStrength / fx, DomainWarpStrength / fy, DomainWarpFrequency);
+
+	// Biome modifiers of the current row at the first and the last column, interpolated along the row for a vertex.
+	float fRowMaterialHeightShift[2] = { 0.0f, 0.0f };
+
+	// The height scale along x (per column) and y (per row) for its derivatives, in noise units.
+	const TReal fBiomeColumnsX = static_cast<TReal>((iCorrectedColumnCount - 1) * ChunkPieceSizeX / fx);
+	const TReal fBiomeRowsY    = static_cast<TReal>((iCorrectedRowCount    - 1) * ChunkPieceSizeY / fy);
+
+	// Noise derivative to the slope of Z in world units.
+	const TReal fSlopeScaleX = static_cast<TReal>(GenerationMaxZFromActorZ / fx);
+	const TReal fSlopeScaleY = static_cast<TReal>(GenerationMaxZFromActorZ / fy);
+
+	decltype(vPrevLocation.X) fNoiseX = vStartLocation.X;
+
+	for (int32 j = 0; j < iCorrectedColumnCount; j++)
+	{
+		vNoiseX[j] = static_cast<TReal>(fNoiseX / fx);
+		fNoiseX += ChunkPieceSizeX;
+	}
+
+
+
+	// Every Z is in [fActorZ, fActorZ + GenerationMaxZFromActorZ], the chunk bounds come from the lowest and the highest vertex.
+	float fMinGeneratedZ = fActorZ + GenerationMaxZFromActorZ;
+	size_t iMinGeneratedZIndex = 0;
+	float fMaxGeneratedZ = fActorZ;
+	size_t iMaxGeneratedZIndex = 0;
+
+	// Edge vertices get their material without the random deviation, so that neighbour chunks match.
+	// bEdge is std::true_type or std::false_type.
+	auto addVertex = [&](int32 i, int32 j, auto bEdge)
+	{
+		if (decltype(bEdge)::value)
+		{
+			// Already generated by a neighbour chunk, copy it so that the border matches exactly.
+			const FWGBorderVertex* pCached = border.find(i, j);
+
+			if (pCached)
+			{
+				data.vNormals      .Add(pCached->vNormal);
+				data.vUV0          .Add(FVector2D(i, j));
+				data.vTangents     .Add(pCached->tangent);
+
+				if (pCached->vLocation.Z > fMaxGeneratedZ)
+				{
+					fMaxGeneratedZ = pCached->vLocation.Z;
+					iMaxGeneratedZIndex = data.vVertices.Num();
+				}
+
+				if (pCached->vLocation.Z < fMinGeneratedZ)
+				{
+					fMinGeneratedZ = pCached->vLocation.Z;
+					iMinGeneratedZIndex = data.vVertices.Num();
+				}
+
+				data.vVertices     .Add(pCached->vLocation);
+				data.vVertexColors .Add(pCached->color);
+				data.vLayerIndex   .push_back(pCached->iLayerIndex);
+
+				vPrevLocation.X += ChunkPieceSizeX;
+
+				return;
+			}
+		}
+
+		TReal generatedValue = FMath::Min(vNoiseRow[j], fCutHeight);
+
+		// Flat where the terrain is cut.
+		TReal fSlopeX = (vNoiseRow[j] < fCutHeight) ? vNoiseDx[j] * fSlopeScaleX : TReal(0);
+		TReal fSlopeY = (vNoiseRow[j] < fCutHeight) ? vNoiseDy[j] * fSlopeScaleY : TReal(0);
+
+		if (bInvert)
+		{
+			generatedValue = 1 - generatedValue;
+
+			fSlopeX = -fSlopeX;
+			fSlopeY = -fSlopeY;
+		}
+
+
+		// Surface Z = f(X, Y): normal is (-dZ/dX, -dZ/dY, 1), tangent follows U (= i, along Y).
+		data.vNormals      .Add(FVector(-fSlopeX, -fSlopeY, 1.0f).GetSafeNormal());
+		data.vUV0          .Add(FVector2D(i, j));
+		data.vTangents     .Add(FProcMeshTangent(FVector(0.0f, 1.0f, fSlopeY).GetSafeNormal(), false));
+
+
+
+		// Set vertex Z
+
+		// Here return value from perlinNoise.octaveNoise0_1 can be
+		// 0    , but should be   GetActorLocation().Z
+		// ...  , but should be   value from interval [GetActorLocation().Z; GenerationMaxZFromActorZ]
+		// 1    , but should be   GenerationMaxZFromActorZ
+
+		vPrevLocation.Z = fActorZ + (GenerationMaxZFromActorZ * generatedValue);
+
+		if (vPrevLocation.Z > fMaxGeneratedZ)
+		{
+			fMaxGeneratedZ = vPrevLocation.Z;
+			iMaxGeneratedZIndex = data.vVertices.Num();
+		}
+
+		if (vPrevLocation.Z < fMinGeneratedZ)
+		{
+			fMinGeneratedZ = vPrevLocation.Z;
+			iMinGeneratedZIndex = data.vVertices.Num();
+		}
+
+		data.vVertices .Add (vPrevLocation);
+
+
+
+		// Set "material" to vertex
+
+		float fAlphaColor = 0.0f;
+
+		float fAlphaColorWithoutRnd = 0.0f;
+
+		float fMaterialHeightShift = 0.0f;
+
+		if (pBiome)
+		{
+			const float fU = static_cast<float>(j) / (iCorrectedColumnCount - 1);
+
+			fMaterialHeightShift = (1.0f - fU) * fRowMaterialHeightShift[0] + fU * fRowMaterialHeightShift[1];
+		}
+
+		if (bUnderwaterSecondMaterial && (generatedValue < (ZWaterLevelInWorld + 0.005f)))
+		{
+			fAlphaColor = 0.5f;
+			fAlphaColorWithoutRnd = 0.5f;
+		}
+		else
+		{
+			if (decltype(bEdge)::value)
+			{
+				pickVertexMaterial(generatedValue, &urd, &rnd, &fAlphaColorWithoutRnd, fMaterialHeightShift);
+				fAlphaColor = fAlphaColorWithoutRnd;
+			}
+			else
+			{
+				fAlphaColor = pickVertexMaterial(generatedValue, &urd, &rnd, &fAlphaColorWithoutRnd, fMaterialHeightShift);
+			}
+		}
+
+		data.vVertexColors .Add(FLinearColor(0.0f, 0.0f, 0.0f, fAlphaColor));
+
+		if (areEqual(fAlphaColorWithoutRnd, 0.0f, 0.1f))
+		{
+			// First Layer
+
+			data.vLayerIndex.push_back(1);
+		}
+		else if (areEqual(fAlphaColorWithoutRnd, 0.5f, 0.1f))
+		{
+			// Second Layer
+			data.vLayerIndex.push_back(2);
+		}
+		else
+		{
+			// Third Layer
+			data.vLayerIndex.push_back(3);
+		}
+
+
+
+		vPrevLocation.X += ChunkPieceSizeX;
+	};
+
+
+	for (int32 i = 0; i < iCorrectedRowCount; i++)
+	{
+		if (((i == 0) || (i == iCorrectedRowCount - 1)) && border.isRowCached(i))
+		{
+			// The whole row is copied from the neighbour, no noise needed.
+		}
+		else if (domainWarp.isEnabled())
+		{
+			domainWarp.sampleRow(i, vNoiseX.data(), static_cast<TReal>(vPrevLocation.Y / fy), vNoiseRow.data(), vNoiseDx.data(), vNoiseDy.data());
+		}
+		else if (multiResolutionNoise.isMultiResolution())
+		{
+			multiResolutionNoise.sampleRow(i, static_cast<TReal>(vPrevLocation.Y / fy), vNoiseRow.data(), vNoiseDx.data(), vNoiseDy.data());
+		}
+		else
+		{
+			noise.octaveNoise0_1RowDerivatives(vNoiseX.data(), static_cast<TReal>(vPrevLocation.Y / fy), iCorrectedColumnCount,
+				vNoiseRow.data(), vNoiseDx.data(), vNoiseDy.data());
+		}
+
+		if (pBiome)
+		{
+			const float fV = static_cast<float>(i) / (iCorrectedRowCount - 1);
+
+			fRowMaterialHeightShift[0] = (1.0f - fV) * pBiome->vMaterialHeightShift[0] + fV * pBiome->vMaterialHeightShift[2];
+			fRowMaterialHeightShift[1] = (1.0f - fV) * pBiome->vMaterialHeightShift[1] + fV * pBiome->vMaterialHeightShift[3];
+
+			// Height scale s(u, v), bilinear: noise * s, d(noise * s) = dnoise * s + noise * ds.
+
+			const float* pScale = pBiome->vHeightScale;
+
+			const TReal fScaleLeft   = (1.0f - fV) * pScale[0] + fV * pScale[2];
+			const TReal fScaleRight  = (1.0f - fV) * pScale[1] + fV * pScale[3];
+			const TReal fScaleDx     = (fScaleRight - fScaleLeft) / fBiomeColumnsX;
+			const TReal fScaleDyLeft = (pScale[2] - pScale[0]) / fBiomeRowsY;
+			const TReal fScaleDyStep = ((pScale[3] - pScale[1]) / fBiomeRowsY - fScaleDyLeft) / (iCorrectedColumnCount - 1);
+
+			for (int32 j = 0; j < iCorrectedColumnCount; j++)
+			{
+				const TReal fU     = static_cast<TReal>(j) / (iCorrectedColumnCount - 1);
+				const TReal fScale = (1 - fU) * fScaleLeft + fU * fScaleRight;
+
+				vNoiseDx[j]  = vNoiseDx[j] * fScale + vNoiseRow[j] * fScaleDx;
+				vNoiseDy[j]  = vNoiseDy[j] * fScale + vNoiseRow[j] * (fScaleDyLeft + j * fScaleDyStep);
+				vNoiseRow[j] = vNoiseRow[j] * fScale;
+			}
+		}
+
+		// The first and the last column are always edges, the rows in between only for the first and the last row.
+
+		addVertex(i, 0, std::true_type());
+
+		if ((i == 0) || (i == iCorrectedRowCount - 1))
+		{
+			for (int32 j = 1; j < iCorrectedColumnCount - 1; j++)
+			{
+				addVertex(i, j, std::true_type());
+			}
+		}
+		else
+		{
+			for (int32 j = 1; j < iCorrectedColumnCount - 1; j++)
+			{
+				addVertex(i, j, std::false_type());
+			}
+		}
+
+		addVertex(i, iCorrectedColumnCount - 1, std::true_type());
+
+		// The triangles are the same for every chunk, see FWGChunkIndexBuffer.
+
+		vPrevLocation.Set(vStartLocation.X, vPrevLocation.Y + ChunkPieceSizeY, fActorZ);
+	}
+
+	data.iMinZVertexIndex = iMinGeneratedZIndex;
+	data.iMaxZVertexIndex = iMaxGeneratedZIndex;
+}
+
+FWGChunkGenerator::FWGChunkKernel FWGChunkGenerator::selectChunkKernel() const
+{
+	if (SinglePrecisionGeneration)
+	{
+		if (InvertWorld)
+		{
+			return SecondMaterialUnderWater ? &FWGChunkGenerator::generateChunkVertices<true, true, float> : &FWGChunkGenerator::generateChunkVertices<true, false, float>;
+		}
+		else
+		{
+			return SecondMaterialUnderWater ? &FWGChunkGenerator::generateChunkVertices<false, true, float> : &FWGChunkGenerator::generateChunkVertices<false, false, float>;
+		}
+	}
+	else
+	{
+		if (InvertWorld)
+		{
+			return SecondMaterialUnderWater ? &FWGChunkGenerator::generateChunkVertices<true, true, double> : &FWGChunkGenerator::generateChunkVertices<true, false, double>;
+		}
+		else
+		{
+			return SecondMaterialUnderWater ? &FWGChunkGenerator::generateChunkVertices<false, true, double> : &FWGChunkGenerator::generateChunkVertices<false, false, double>;
+		}
+	}
+}
+
+void FWGChunkGenerator::blendWorldMaterialsMore(FWGChunkData& data, long long iX, long long iY) const
+{
+	const uint64 iChunkSeed = static_cast<uint64>(static_cast<uint32>(iGeneratedSeed))
+		^ (static_cast<uint64>(iX) * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64>(iY) * 0xC2B2AE3D27D4EB4Full);
+
+	std::mt19937_64 gen(iChunkSeed);
+	std::uniform_real_distribution<float> urd(0.0f, 1.0f);
+
+	size_t iVertexIndex = 0;
+
+	for (size_t iRow = 0; iRow < ChunkPieceRowCount + 1; iRow++)
+	{
+		iVertexIndex = (ChunkPieceColumnCount + 1) * iRow;
+
+		size_t iSkipPoints = 0;
+
+		for (size_t iColumn = 0; iColumn < ChunkPieceColumnCount + 1; iColumn++)
+		{
+			if (iSkipPoints > 0)
+			{
+				iSkipPoints--;
+				iVertexIndex++;
+
+				continue;
+			}
+
+			if ((iRow >= 3) && ((iRow + 3) < (ChunkPieceRowCount + 1))
+				&& (iColumn >= 3) && ((iColumn + 3) < (ChunkPieceColumnCount + 1)))
+			{
+				if (SecondMaterialUnderWater &&
+					(data.vVertices[iVertexIndex].Z <= (vActorLocation.Z + (GenerationMaxZFromActorZ * (ZWaterLevelInWorld + 0.008f)))))
+				{
+					// Under water material - don't touch.
+				}
+				else
+				{
+					bool bFirstLayerWithOtherColor  = false;
+					bool bSecondLayerWithOtherColor = false;
+					bool bThirdLayerWithOtherColor  = false;
+
+					if ((data.vLayerIndex[iVertexIndex] == 1)
+						&& (areEqual(data.vVertexColors[iVertexIndex].A, 0.0f, 0.1f) == false))
+					{
+						bFirstLayerWithOtherColor = true;
+					}
+					else if ((data.vLayerIndex[iVertexIndex] == 2)
+						&& (areEqual(data.vVertexColors[iVertexIndex].A, 0.5f, 0.1f) == false))
+					{
+						bSecondLayerWithOtherColor = true;
+					}
+					else if ((data.vLayerIndex[iVertexIndex] == 3)
+						&& (areEqual(data.vVertexColors[iVertexIndex].A, 1.0f, 0.1f) == false))
+					{
+						bThirdLayerWithOtherColor = true;
+					}
+
+
+					if (bFirstLayerWithOtherColor || bSecondLayerWithOtherColor || bThirdLayerWithOtherColor)
+					{
+						// Add a little more of other color.
+
+						// . . . . .
+						// . . . . .
+						// . . + . .  <- we are in the center.
+						// . . . . .
+						// . . . . .
+
+						// Close square:
+
+						for (int32 iIndexY = -(ChunkPieceColumnCount + 1); iIndexY <= (ChunkPieceColumnCount + 1); iIndexY += (ChunkPieceColumnCount + 1))
+						{
+							for (int32 iIndexX = -1; iIndexX <= 1; iIndexX++)
+							{
+								if (urd(gen) <= IncreasedMaterialBlendProbability)
+								{
+									data.vVertexColors[iVertexIndex + iIndexY + iIndexX] = data.vVertexColors[iVertexIndex];
+								}
+							}
+						}
+
+						// Far square:
+
+						for (int32 iIndexY = -((ChunkPieceColumnCount + 1) * 2 - 1); iIndexY <= ((ChunkPieceColumnCount + 1) * 2 - 1); iIndexY += (ChunkPieceColumnCount + 1))
+						{
+							for (int32 iIndexX = -2; iIndexX <= 2; iIndexX++)
+							{
+								if (urd(gen) <= (IncreasedMaterialBlendProbability / 2))
+								{
+									data.vVertexColors[iVertexIndex + iIndexY + iIndexX] = data.vVertexColors[iVertexIndex];
+								}
+							}
+						}
+
+						iSkipPoints = 2;
+					}
+				}
+			}
+			
+			iVertexIndex++;
+		}
+	}
+}
+
+void FWGChunkGenerator::applySlopeDependentBlend(FWGChunkData& data) const
+{
+	float fSteepSlopeMinHeightDiff = GenerationMaxZFromActorZ * MinSlopeHeightMultiplier;
+
+	// No allocation once the recycled data had a chunk of this size.
+	data.vProcessedVertices.assign(data.vVertices.Num(), false);
+	data.vProcessedVertices[0] = true;
+
+	size_t iVertexIndex = 0;
+
+	for (size_t iRow = 0; iRow < ChunkPieceRowCount + 1; iRow++)
+	{
+		for (size_t iColumn = 0; iColumn < ChunkPieceColumnCount + 1; iColumn++)
+		{
+			if (((iRow < 2) || (iRow > ChunkPieceRowCount - 3))
+				|| ((iColumn < 2) || (iColumn > ChunkPieceColumnCount - 3)))
+			{
+				iVertexIndex++;
+				continue;
+			}
+
+			bool bHasLeftPoints  = true;
+			bool bHasTopPoints   = true;
+			bool bHasRightPoints = true;
+			bool bHasDownPoints  = true;
+
+			if (iRow == 0)
+			{
+				bHasTopPoints = false;
+			}
+
+			if (iRow == ChunkPieceRowCount)
+			{
+				bHasDownPoints = false;
+			}
+
+			if (iColumn == 0)
+			{
+				bHasLeftPoints = false;
+			}
+
+			if (iColumn == ChunkPieceColumnCount)
+			{
+				bHasRightPoints = false;
+			}
+
+			float fCurrentVertexZ = data.vVertices[iVertexIndex].Z;
+
+			// Process the left points:
+			if (bHasLeftPoints)
+			{
+				compareHeightDifference(data, fCurrentVertexZ, iVertexIndex - 1, fSteepSlopeMinHeightDiff);
+
+				if (bHasTopPoints)
+				{
+					compareHeightDifference(data, fCurrentVertexZ, iVertexIndex - 1 - (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
+				}
+
+				if (bHasDownPoints)
+				{
+					compareHeightDifference(data, fCurrentVertexZ, iVertexIndex - 1 + (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
+				}
+			}
+
+			// Process the right points:
+			if (bHasRightPoints)
+			{
+			compareHeightDifference(data, fCurrentVertexZ, iVertexIndex + 1, fSteepSlopeMinHeightDiff);
+
+			if (bHasTopPoints)
+			{
+				compareHeightDifference(data, fCurrentVertexZ, iVertexIndex + 1 - (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
+			}
+
+			if (bHasDownPoints)
+			{
+				compareHeightDifference(data, fCurrentVertexZ, iVertexIndex + 1 + (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
+			}
+			}
+
+			// Top point:
+			if (bHasTopPoints)
+			{
+				compareHeightDifference(data, fCurrentVertexZ, iVertexIndex - (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
+			}
+
+			// Down point:
+			if (bHasDownPoints)
+			{
+				compareHeightDifference(data, fCurrentVertexZ, iVertexIndex + (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
+			}
+
+			iVertexIndex++;
+		}
+	}
+}
+
+bool FWGChunkGenerator::areEqual(float a, float b, float eps)
+{
+	return fabs(a - b) < eps;
+}
+
+void FWGChunkGenerator::compareHeightDifference(FWGChunkData& data, float& fCurrentZ, size_t iCompareToIndex, float& fSteepSlopeMinHeightDiff) const
+{
+	if (data.vProcessedVertices[iCompareToIndex] == false)
+	{
+		if (fabs(data.vVertices[iCompareToIndex].Z - fCurrentZ) > fSteepSlopeMinHeightDiff)
+		{
+			data.vVertexColors[iCompareToIndex] = FLinearColor(0.0f, 0.0f, 0.0f, 0.5f);
+		}
+
+		data.vProcessedVertices[iCompareToIndex] = true;
+	}
+}
@@ -0,0 +1,138 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// UE
+#include "ProceduralMeshComponent.h"
+
+// STL
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+class AFWGen;
+class FWGNoiseContext;
+class FWGChunkBorder;
+class FWGChunkIndexBuffer;
+class FWGBiomeMap;
+struct FWGChunkBiome;
+
+
+// Everything the generation writes for one chunk, filled by FWGChunkGenerator (on any thread)
+// and swapped with the arrays of the chunk actor on the game thread (see AFWGChunk::setMeshData()),
+// the old arrays are filled by a next chunk job (see FWGChunkJobQueue::recycleResult()).
+struct FWGChunkData
+{
+	TArray<FProcMeshTangent>  vTangents;
+	TArray<FLinearColor>      vVertexColors;
+	TArray<FVector>           vVertices;
+	TArray<FVector>           vNormals;
+	TArray<FVector2D>         vUV0;
+
+	std::vector<int32>        vLayerIndex;
+
+	// Scratch of the slope dependent blend, kept with the recycled arrays so that it is not allocated for every chunk.
+	std::vector<bool>         vProcessedVertices;
+
+	size_t                    iMinZVertexIndex = 0;
+	size_t                    iMaxZVertexIndex = 0;
+};
+
+// Generation parameters of AFWGen copied by GenerateWorld(), with the noise and the biome map they were made for.
+// Never modified after that, so the chunk jobs use it on the worker threads while the properties
+// of the actor are changed (they only change the world after the next GenerateWorld(), which makes a new one).
+// The members are named like the properties they are copied from.
+class FWGChunkGenerator
+{
+public:
+
+	FWGChunkGenerator(const AFWGen* pGen, int32 iGeneratedSeed, const std::shared_ptr<const FWGNoiseContext>& pNoiseContext,
+		const std::shared_ptr<FWGBiomeMap>& pBiomeMap);
+
+	// Vertices of the chunk (iX, iY) with their materials and both material blends (if enabled).
+	// border - vertices of the chunk its neighbours have already generated, only read during the call.
+	// isCancelled - checked between the stages (heights, material blend, slope blend), returns false if the generation was stopped
+	// (the data is incomplete then).
+	bool  generate           (FWGChunkData& data, long long iX, long long iY, const FWGChunkBorder& border,
+		const std::function<bool()>& isCancelled = nullptr) const;
+
+	// Vertices of the horizon chunk (iX, iY) (see FWGHorizon): iResolution x iResolution vertices over the same area
+	// as a full resolution chunk, then the skirt vertices of indexBuffer. No random material height deviation,
+	// no blends and no border cache, so that the neighbour horizon chunks match. Returns false if it was cancelled.
+	bool  generateHorizon    (FWGChunkData& data, long long iX, long long iY, int32 iResolution, const FWGChunkIndexBuffer& indexBuffer,
+		const std::function<bool()>& isCancelled = nullptr) const;
+
+	float pickVertexMaterial (double height, std::uniform_real_distribution<float>* pUrd, std::mt19937_64* pRnd, float* pfLayerTypeWithoutRnd = nullptr,
+		float fMaterialHeightShift = 0.0f) const;
+
+
+	const int32   ChunkPieceRowCount;
+	const int32   ChunkPieceColumnCount;
+	const float   ChunkPieceSizeX;
+	const float   ChunkPieceSizeY;
+
+	const float   GenerationFrequency;
+	const float   GenerationMaxZFromActorZ;
+	const bool    InvertWorld;
+	const bool    SinglePrecisionGeneration;
+	const float   MultiResolutionMaxError;
+	const float   DomainWarpStrength;
+	const float   DomainWarpFrequency;
+
+	const float   FirstMaterialMaxRelativeHeight;
+	const float   SecondMaterialMaxRelativeHeight;
+	const float   MaterialHeightMaxDeviation;
+	const float   TerrainCutHeightFromActorZ;
+	const bool    SecondMaterialUnderWater;
+	const float   ZWaterLevelInWorld;
+
+	const bool    ApplyGroundMaterialBlend;
+	const bool    ApplySlopeDependentBlend;
+	const float   FirstMaterialOnSecondProbability;
+	const float   FirstMaterialOnThirdProbability;
+	const float   SecondMaterialOnFirstProbability;
+	const float   SecondMaterialOnThirdProbability;
+	const float   ThirdMaterialOnFirstProbability;
+	const float   ThirdMaterialOnSecondProbability;
+	const float   IncreasedMaterialBlendProbability;
+	const float   MinSlopeHeightMultiplier;
+
+	const FVector vActorLocation;
+	const int32   iGeneratedSeed;
+
+private:
+
+	// Height pass of generate() compiled for one set of flags.
+	// The octave count is compiled into the noise source (see FWGNoiseContext).
+	// pBiome is nullptr if the biomes are disabled.
+	typedef void (FWGChunkGenerator::*FWGChunkKernel)(FWGChunkData& data, long long iX, long long iY, const FWGNoiseContext& noise,
+		const FWGChunkBorder& border, const FWGChunkBiome* pBiome, FVector vStartLocation, double fx, double fy) const;
+
+	template <bool bInvert, bool bUnderwaterSecondMaterial, typename TReal>
+	void  generateChunkVertices    (FWGChunkData& data, long long iX, long long iY, const FWGNoiseContext& noise,
+		const FWGChunkBorder& border, const FWGChunkBiome* pBiome, FVector vStartLocation, double fx, double fy) const;
+	FWGChunkKernel selectChunkKernel () const;
+
+	// Random from the seed and the chunk coordinates, so a chunk is blended the same every time it is generated.
+	void  blendWorldMaterialsMore  (FWGChunkData& data, long long iX, long long iY) const;
+	void  applySlopeDependentBlend (FWGChunkData& data) const;
+	void  compareHeightDifference  (FWGChunkData& data, float& fCurrentZ, size_t iCompareToIndex, float& fSteepSlopeMinHeightDiff) const;
+
+	static bool areEqual           (float a, float b, float eps);
+
+
+	std::shared_ptr<const FWGNoiseContext> pNoiseContext;
+
+	// nullptr if the biomes are disabled (safe to use from any thread).
+	std::shared_ptr<FWGBiomeMap>           pBiomeMap;
+
+	// Picked for the flags above.
+	FWGChunkKernel                         pChunkKernel;
+};
@@ -0,0 +1,139 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkIndexBuffer.h"
+
+
+FWGChunkIndexBuffer::FWGChunkIndexBuffer(int32 iRowCount, int32 iColumnCount, bool bSkirt)
+	: iRowCount(iRowCount), iColumnCount(iColumnCount)
+{
+	if (bSkirt && (iRowCount > 1) && (iColumnCount > 1))
+	{
+		// Around the chunk: row 0, last column, last row backwards, column 0 backwards.
+
+		vSkirtVertices.Reserve(2 * (iRowCount - 1) + 2 * (iColumnCount - 1));
+
+		for (int32 j = 0; j < iColumnCount - 1; j++)
+		{
+			vSkirtVertices.Add(j);
+		}
+
+		for (int32 i = 0; i < iRowCount - 1; i++)
+		{
+			vSkirtVertices.Add(i * iColumnCount + iColumnCount - 1);
+		}
+
+		for (int32 j = iColumnCount - 1; j > 0; j--)
+		{
+			vSkirtVertices.Add((iRowCount - 1) * iColumnCount + j);
+		}
+
+		for (int32 i = iRowCount - 1; i > 0; i--)
+		{
+			vSkirtVertices.Add(i * iColumnCount);
+		}
+	}
+
+	vIndices.Reserve((iRowCount - 1) * (iColumnCount - 1) * 6 + vSkirtVertices.Num() * 12);
+
+	for (int32 i = 1; i < iRowCount; i++)
+	{
+		//     j = 0,   1,   2,   3  ...
+		// i = 0:  +----+----+----+- ...
+		//         |   /|   /|   /|
+		//         |  / |  / |  / |
+		//         | /  | /  | /  |
+		// i = 1:  +----+----+----+- ...
+
+		int32 iFirstIndexInRow = (i - 1) * iColumnCount;
+
+		// Add triangle #1
+		vIndices.Add(iFirstIndexInRow);
+		vIndices.Add(i * iColumnCount);
+		vIndices.Add(iFirstIndexInRow + 1);
+
+		for (int32 j = 1; j < iColumnCount; j++)
+		{
+			// Add triangle #2
+			vIndices.Add(iFirstIndexInRow + j);
+			vIndices.Add(i * iColumnCount + j - 1);
+			vIndices.Add(i * iColumnCount + j);
+
+			if (j < (iColumnCount - 1))
+			{
+				// Add triangle #1
+				vIndices.Add(iFirstIndexInRow + j);
+				vIndices.Add(i * iColumnCount + j);
+				vIndices.Add(iFirstIndexInRow + j + 1);
+			}
+		}
+	}
+
+	// Skirt: a quad between every two neighbour border vertices and their copies below them.
+	// Both sides are added, the skirt is seen from the chunk and from its neighbour.
+
+	const int32 iFirstSkirtIndex = iRowCount * iColumnCount;
+
+	for (int32 k = 0; k < vSkirtVertices.Num(); k++)
+	{
+		const int32 iNext = (k + 1) % vSkirtVertices.Num();
+
+		const int32 a      = vSkirtVertices[k];
+		const int32 b      = vSkirtVertices[iNext];
+		const int32 aSkirt = iFirstSkirtIndex + k;
+		const int32 bSkirt = iFirstSkirtIndex + iNext;
+
+		vIndices.Add(a);
+		vIndices.Add(b);
+		vIndices.Add(bSkirt);
+
+		vIndices.Add(a);
+		vIndices.Add(bSkirt);
+		vIndices.Add(aSkirt);
+
+		vIndices.Add(a);
+		vIndices.Add(bSkirt);
+		vIndices.Add(b);
+
+		vIndices.Add(a);
+		vIndices.Add(aSkirt);
+		vIndices.Add(bSkirt);
+	}
+
+	if (is16Bit())
+	{
+		vIndices16.SetNumUninitialized(vIndices.Num());
+
+		for (int32 i = 0; i < vIndices.Num(); i++)
+		{
+			vIndices16[i] = static_cast<uint16>(vIndices[i]);
+		}
+	}
+}
+
+int32 FWGChunkIndexBuffer::getVertexCount() const
+{
+	return iRowCount * iColumnCount + vSkirtVertices.Num();
+}
+
+bool FWGChunkIndexBuffer::is16Bit() const
+{
+	return getVertexCount() <= 65536;
+}
+
+const TArray<int32>& FWGChunkIndexBuffer::getIndices() const
+{
+	return vIndices;
+}
+
+const TArray<uint16>& FWGChunkIndexBuffer::getIndices16() const
+{
+	return vIndices16;
+}
+
+const TArray<int32>& FWGChunkIndexBuffer::getSkirtVertices() const
+{
+	return vSkirtVertices;
+}
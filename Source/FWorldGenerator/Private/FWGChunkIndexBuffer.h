@@ -0,0 +1,48 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+// Triangles of a chunk of iRowCount x iColumnCount vertices (vertex (i, j) is i * iColumnCount + j).
+// They are the same for every chunk of this size, so they are built once by GenerateWorld() and
+// shared by all chunk sections instead of being generated for every chunk.
+// With bSkirt the border vertices (see getSkirtVertices()) are repeated after the grid and connected
+// to the border by a vertical strip of triangles, this is what the chunk LODs (FWGChunkLod) use.
+class FWGChunkIndexBuffer
+{
+public:
+
+	FWGChunkIndexBuffer(int32 iRowCount, int32 iColumnCount, bool bSkirt = false);
+
+	// Grid vertices plus skirt vertices.
+	int32                  getVertexCount () const;
+
+	// True if the chunk has at most 65536 vertices and getIndices16() can be used.
+	bool                   is16Bit      () const;
+
+	// For UProceduralMeshComponent.
+	const TArray<int32>&   getIndices   () const;
+
+	// Half the size, empty if is16Bit() is false.
+	const TArray<uint16>&  getIndices16 () const;
+
+	// Grid vertices of the border, around the chunk, starting at (0, 0). Skirt vertex k is the copy of the k-th of them
+	// and has the index iRowCount * iColumnCount + k. Empty without bSkirt.
+	const TArray<int32>&   getSkirtVertices () const;
+
+
+	const int32            iRowCount;
+	const int32            iColumnCount;
+
+private:
+
+	TArray<int32>          vSkirtVertices;
+
+	TArray<int32>          vIndices;
+	TArray<uint16>         vIndices16;
+};
@@ -0,0 +1,410 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkJobQueue.h"
+
+// UE
+#include "Async/Async.h"
+#include "HAL/PlatformTime.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+// Custom
+#include "FWGChunk.h"
+
+std::shared_ptr<FWGChunkResult> FWGChunkJobQueue::newJob(const FWGChunkBorder& border)
+{
+	std::shared_ptr<FWGChunkResult> pJob;
+
+	{
+		std::lock_guard<std::mutex> lock(mtxQueues);
+
+		if (vFreeResults.empty() == false)
+		{
+			pJob = std::move(vFreeResults.back());
+			vFreeResults.pop_back();
+		}
+	}
+
+	if (pJob == nullptr)
+	{
+		pJob = std::make_shared<FWGChunkResult>();
+	}
+
+	border.copyInto(pJob->job.border);
+
+	return pJob;
+}
+
+void FWGChunkJobQueue::addJob(std::shared_ptr<FWGChunkResult> pJob)
+{
+	{
+		std::lock_guard<std::mutex> lock(mtxQueues);
+
+		const FWGChunkJob& job = pJob->job;
+
+		if ((job.bPrefetch == false) && (job.pHorizon == nullptr))
+		{
+			// Its result would be thrown away anyway.
+			cancelJobsOfChunk(job.pChunk);
+		}
+
+		pJob->job.iEpoch = iEpoch;
+
+		vJobs.push_back(std::move(pJob));
+	}
+
+	std::shared_ptr<FWGChunkJobQueue> pQueue = shared_from_this();
+
+	Async(EAsyncExecution::ThreadPool, [pQueue]()
+	{
+		pQueue->runJob();
+	});
+}
+
+bool FWGChunkJobQueue::adoptJob(long long iX, long long iY, const FWGChunkGenerator* pGenerator, AFWGChunk* pChunk, uint32 iRequest, float fPriority)
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	FWGChunkJob* pJob = nullptr;
+
+	for (size_t i = 0; (i < vJobs.size()) && (pJob == nullptr); i++)
+	{
+		FWGChunkJob& job = vJobs[i]->job;
+
+		if (job.bPrefetch && (job.iX == iX) && (job.iY == iY) && (job.pGenerator.get() == pGenerator))
+		{
+			pJob = &job;
+		}
+	}
+
+	for (size_t i = 0; (i < vRunningJobs.size()) && (pJob == nullptr); i++)
+	{
+		if (vRunningJobs[i]->bPrefetch && (vRunningJobs[i]->iX == iX) && (vRunningJobs[i]->iY == iY)
+			&& (vRunningJobs[i]->pGenerator.get() == pGenerator) && (vRunningJobs[i]->bCancelled == false))
+		{
+			pJob = vRunningJobs[i];
+		}
+	}
+
+	if (pJob == nullptr)
+	{
+		return false;
+	}
+
+	cancelJobsOfChunk(pChunk);
+
+	pJob->pChunk    = pChunk;
+	pJob->iRequest  = iRequest;
+	pJob->fPriority = fPriority;
+	pJob->bPrefetch = false;
+
+	return true;
+}
+
+void FWGChunkJobQueue::cancelJobs(AFWGChunk* pChunk)
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	cancelJobsOfChunk(pChunk);
+}
+
+bool FWGChunkJobQueue::hasJob(long long iX, long long iY) const
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	for (size_t i = 0; i < vJobs.size(); i++)
+	{
+		if ((vJobs[i]->job.iX == iX) && (vJobs[i]->job.iY == iY) && (vJobs[i]->job.pHorizon == nullptr))
+		{
+			return true;
+		}
+	}
+
+	for (size_t i = 0; i < vRunningJobs.size(); i++)
+	{
+		if ((vRunningJobs[i]->iX == iX) && (vRunningJobs[i]->iY == iY) && (vRunningJobs[i]->pHorizon == nullptr)
+			&& (vRunningJobs[i]->bCancelled == false))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::shared_ptr<FWGChunkResult> FWGChunkJobQueue::getResult()
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	if (vResults.empty())
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<FWGChunkResult> pResult = std::move(vResults.front());
+	vResults.pop_front();
+
+	return pResult;
+}
+
+void FWGChunkJobQueue::updateJobs(long long iCentralX, long long iCentralY, long long iRadius)
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	for (size_t i = 0; i < vJobs.size(); )
+	{
+		FWGChunkJob& job = vJobs[i]->job;
+
+		if (isOutOfRadius(job, iCentralX, iCentralY, iRadius))
+		{
+			cancelJob(i);
+		}
+		else
+		{
+			job.fPriority = getPriority(job.iX, job.iY, iCentralX, iCentralY);
+
+			i++;
+		}
+	}
+
+	for (size_t i = 0; i < vRunningJobs.size(); i++)
+	{
+		if (isOutOfRadius(*vRunningJobs[i], iCentralX, iCentralY, iRadius))
+		{
+			vRunningJobs[i]->bCancelled = true;
+		}
+	}
+}
+
+void FWGChunkJobQueue::clear()
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	// The running jobs stop at their next check.
+	iEpoch++;
+
+	// Their tasks find no job and return.
+	while (vJobs.empty() == false)
+	{
+		cancelJob(vJobs.size() - 1);
+	}
+
+	for (size_t i = 0; i < vResults.size(); i++)
+	{
+		addFreeResult(std::move(vResults[i]));
+	}
+
+	vResults.clear();
+}
+
+int32 FWGChunkJobQueue::getJobCount() const
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	return static_cast<int32>(vJobs.size() + vRunningJobs.size() + vResults.size());
+}
+
+void FWGChunkJobQueue::recycleResult(std::shared_ptr<FWGChunkResult> pResult)
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	addFreeResult(std::move(pResult));
+}
+
+void FWGChunkJobQueue::setMaxFreeResults(size_t iMaxCount)
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	iMaxFreeResults = iMaxCount;
+
+	if (vFreeResults.size() > iMaxFreeResults)
+	{
+		vFreeResults.resize(iMaxFreeResults);
+	}
+
+	vFreeResults.reserve(iMaxFreeResults);
+}
+
+FWGChunkJobStats FWGChunkJobQueue::getStats() const
+{
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	return stats;
+}
+
+float FWGChunkJobQueue::getPriority(long long iX, long long iY, long long iCentralX, long long iCentralY)
+{
+	const double fDistanceX = static_cast<double>(iX - iCentralX);
+	const double fDistanceY = static_cast<double>(iY - iCentralY);
+
+	return static_cast<float>(std::sqrt(fDistanceX * fDistanceX + fDistanceY * fDistanceY));
+}
+
+void FWGChunkJobQueue::runJob()
+{
+	std::shared_ptr<FWGChunkResult> pResult;
+
+	{
+		std::lock_guard<std::mutex> lock(mtxQueues);
+
+		if (vJobs.empty())
+		{
+			// Cancelled or removed by clear() (or run by an earlier task).
+			return;
+		}
+
+		// The closest chunk first.
+		size_t iClosestJob = 0;
+
+		for (size_t i = 1; i < vJobs.size(); i++)
+		{
+			if (vJobs[i]->job.fPriority < vJobs[iClosestJob]->job.fPriority)
+			{
+				iClosestJob = i;
+			}
+		}
+
+		// generate() only resets the arrays of the (recycled) result, they keep their memory if it is enough for the chunk.
+		pResult = std::move(vJobs[iClosestJob]);
+		vJobs.erase(vJobs.begin() + iClosestJob);
+
+		vRunningJobs.push_back(&pResult->job);
+	}
+
+	const FWGChunkJob& job = pResult->job;
+
+	const double fStartTime = FPlatformTime::Seconds();
+
+	const std::function<bool()> isJobCancelled = [this, &job]()
+	{
+		return isCancelled(job);
+	};
+
+	bool bFinished = false;
+
+	if (job.pHorizon)
+	{
+		bFinished = job.pGenerator->generateHorizon(pResult->data, job.iX, job.iY, job.pHorizon->iResolution,
+			job.pHorizon->getIndexBuffer(), isJobCancelled);
+	}
+	else
+	{
+		bFinished = job.pGenerator->generate(pResult->data, job.iX, job.iY, job.border, isJobCancelled);
+	}
+
+	pResult->fGenerationTime = FPlatformTime::Seconds() - fStartTime;
+
+	// Cancelled after the last check.
+	bFinished = bFinished && (isCancelled(job) == false);
+
+	std::lock_guard<std::mutex> lock(mtxQueues);
+
+	vRunningJobs.erase(std::find(vRunningJobs.begin(), vRunningJobs.end(), &job));
+
+	if (bFinished == false)
+	{
+		stats.iCancelledJobCount++;
+		stats.fSavedTime += std::max(0.0, fAverageJobTime - pResult->fGenerationTime);
+
+		addFreeResult(std::move(pResult));
+
+		return;
+	}
+
+	if (iFinishedJobCount == 0)
+	{
+		fAverageJobTime = pResult->fGenerationTime;
+	}
+	else
+	{
+		fAverageJobTime = fAverageJobTime * 0.9 + pResult->fGenerationTime * 0.1;
+	}
+
+	iFinishedJobCount++;
+
+	vResults.push_back(std::move(pResult));
+}
+
+bool FWGChunkJobQueue::isCancelled(const FWGChunkJob& job) const
+{
+	return job.bCancelled || (job.iEpoch != iEpoch);
+}
+
+void FWGChunkJobQueue::cancelJob(size_t iJobIndex)
+{
+	stats.iCancelledJobCount++;
+	stats.fSavedTime += fAverageJobTime;
+
+	addFreeResult(std::move(vJobs[iJobIndex]));
+
+	vJobs.erase(vJobs.begin() + iJobIndex);
+}
+
+void FWGChunkJobQueue::cancelJobsOfChunk(const TWeakObjectPtr<AFWGChunk>& pChunk)
+{
+	for (size_t i = 0; i < vJobs.size(); )
+	{
+		if ((vJobs[i]->job.bPrefetch == false) && (vJobs[i]->job.pChunk == pChunk))
+		{
+			cancelJob(i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	for (size_t i = 0; i < vRunningJobs.size(); i++)
+	{
+		if ((vRunningJobs[i]->bPrefetch == false) && (vRunningJobs[i]->pChunk == pChunk))
+		{
+			vRunningJobs[i]->bCancelled = true;
+		}
+	}
+}
+
+void FWGChunkJobQueue::addFreeResult(std::shared_ptr<FWGChunkResult> pResult)
+{
+	if (vFreeResults.size() >= iMaxFreeResults)
+	{
+		return;
+	}
+
+	// The job of the next newJob(), its border is copied then.
+	FWGChunkJob& job = pResult->job;
+
+	job.pChunk        = nullptr;
+	job.iRequest      = 0;
+	job.fPriority     = 0.0f;
+	job.bPrefetch     = false;
+	job.pHorizon      = nullptr;
+	job.iHorizonChunk = 0;
+	job.pGenerator    = nullptr;
+	job.bCancelled    = false;
+
+	pResult->fGenerationTime = 0.0;
+	pResult->commitStep      = EFWGCommitStep::Mesh;
+
+	vFreeResults.push_back(std::move(pResult));
+}
+
+bool FWGChunkJobQueue::isOutOfRadius(const FWGChunkJob& job, long long iCentralX, long long iCentralY, long long iRadius)
+{
+	// The prefetch jobs are for the chunks just out of the view distance.
+	if (job.bPrefetch)
+	{
+		iRadius++;
+	}
+
+	if (job.pHorizon)
+	{
+		iRadius = job.pHorizon->iOuterDistance;
+	}
+
+	return (std::abs(job.iX - iCentralX) > iRadius) || (std::abs(job.iY - iCentralY) > iRadius);
+}
@@ -0,0 +1,192 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Custom
+#include "FWGChunkBorderCache.h"
+#include "FWGChunkGenerator.h"
+#include "FWGHorizon.h"
+
+
+class AFWGChunk;
+
+
+// Chunk to generate on a worker thread: everything it needs is copied, nothing in it belongs to the game thread.
+// Part of its FWGChunkResult, which is reused for other jobs (see FWGChunkJobQueue::newJob()).
+struct FWGChunkJob
+{
+	FWGChunkJob() : iRequest(0), iX(0), iY(0), fPriority(0.0f), iEpoch(0), bPrefetch(false), iHorizonChunk(0), border(0, 0), bCancelled(false)
+	{
+	}
+
+	// The chunk actor the result is for (only used on the game thread, see AFWGen::commitChunkStep()), none if bPrefetch.
+	TWeakObjectPtr<AFWGChunk> pChunk;
+
+	// AFWGChunk::iLoadRequest when the job was added, the result is thrown away if the chunk was moved again.
+	uint32          iRequest;
+
+	long long       iX;
+	long long       iY;
+
+	// Distance (in chunks) from the chunk to the central chunk, the pending job with the smallest one runs first.
+	float           fPriority;
+
+	// FWGChunkJobQueue::clear() count when the job was added (set by addJob()), the job stops if the world was cleared since.
+	uint32          iEpoch;
+
+	// Generated before the chunk is loaded, the result goes to FWGChunkPrefetcher (unless a chunk takes the job, see adoptJob()).
+	bool            bPrefetch;
+
+	// Set for a chunk of the horizon ring (see FWGChunkGenerator::generateHorizon()), pChunk is none then
+	// and iRequest is FWGHorizonChunk::iLoadRequest of vChunks[iHorizonChunk] of the ring.
+	std::shared_ptr<FWGHorizon> pHorizon;
+	size_t          iHorizonChunk;
+
+	// Vertices the neighbours of the chunk had generated when the job was added (its own copy).
+	FWGChunkBorder  border;
+
+	std::shared_ptr<const FWGChunkGenerator> pGenerator;
+
+	// Set on the game thread when the chunk is not needed anymore, the worker checks it between the generation stages.
+	std::atomic<bool>                        bCancelled;
+};
+
+// Steps of committing a result on the game thread, AFWGen::Tick() runs as many of them per frame as fit into ChunkCommitBudget.
+enum class EFWGCommitStep
+{
+	Mesh,       // arrays, border cache, drawn mesh, water plane, trigger box
+	Collision,  // collision of the chunk (see AFWGen::updateChunkCollision()), the cooking or the heightfield runs on the thread pool
+	Spawn       // despawned objects are spawned again
+};
+
+// The job and what it generated, created by FWGChunkJobQueue::newJob() and given back by FWGChunkJobQueue::recycleResult().
+struct FWGChunkResult
+{
+	FWGChunkResult() : fGenerationTime(0.0), commitStep(EFWGCommitStep::Mesh)
+	{
+	}
+
+	FWGChunkJob     job;
+	FWGChunkData    data;
+
+	// Seconds the worker spent on the job.
+	double          fGenerationTime;
+
+	// Next step of the commit (only used on the game thread).
+	EFWGCommitStep  commitStep;
+};
+
+struct FWGChunkJobStats
+{
+	// Jobs that were removed before they started or stopped between the generation stages.
+	int32   iCancelledJobCount = 0;
+
+	// Seconds of worker time the cancelled jobs did not spend, estimated from the average time of the finished jobs.
+	double  fSavedTime = 0.0;
+};
+
+// Chunk jobs that run on the thread pool and their results, that the game thread takes and commits.
+// Every job is one thread pool task, which runs the closest pending job (not necessarily its own).
+// The queues are only locked to add or to take an item, so a running job never blocks the game thread.
+// Kept by std::shared_ptr: the tasks keep it alive, so AFWGen can be destroyed while they run.
+class FWGChunkJobQueue : public std::enable_shared_from_this<FWGChunkJobQueue>
+{
+public:
+
+	// Game thread. Job with a copy of border, its other fields are set by the caller before addJob().
+	// A recycled result if there is one (its arrays and its copy of the border keep their memory), a new one otherwise.
+	std::shared_ptr<FWGChunkResult> newJob (const FWGChunkBorder& border);
+
+	// Game thread. pJob->job is generated on the thread pool (pJob comes from newJob()).
+	// Cancels the older job of the same chunk (the chunk was moved again before it finished).
+	void  addJob      (std::shared_ptr<FWGChunkResult> pJob);
+
+	// Game thread. If there is a prefetch job for (iX, iY) made by pGenerator, it becomes the job of the chunk
+	// (as if addJob() was called) and true is returned.
+	bool  adoptJob    (long long iX, long long iY, const FWGChunkGenerator* pGenerator, AFWGChunk* pChunk, uint32 iRequest, float fPriority);
+
+	// Game thread. Cancels the jobs of the chunk (it got its vertices elsewhere).
+	void  cancelJobs  (AFWGChunk* pChunk);
+
+	// Game thread. A job for the chunk (iX, iY) is pending or running (the horizon jobs are not counted).
+	bool  hasJob      (long long iX, long long iY) const;
+
+	// Game thread, nullptr if no job has finished since the last call.
+	std::shared_ptr<FWGChunkResult> getResult ();
+
+	// Game thread, after the central chunk moved: sets the priorities for the new central chunk
+	// and cancels the jobs of the chunks farther than iRadius chunks from it (iRadius + 1 for the prefetch jobs,
+	// the outer distance of the ring for the horizon jobs).
+	void  updateJobs  (long long iCentralX, long long iCentralY, long long iRadius);
+
+	// Removes the jobs that have not started yet and the results that were not taken,
+	// the running jobs stop at their next check (new epoch).
+	void  clear       ();
+
+	// Jobs that were added and whose results were not taken yet.
+	int32 getJobCount () const;
+
+	// Game thread. Gives back a result that was committed (its data has the old arrays of the chunk, see AFWGChunk::setMeshData())
+	// or thrown away, newJob() reuses it and the job fills its arrays instead of allocating new ones.
+	// Freed if iMaxFreeResults results are already kept.
+	void  recycleResult (std::shared_ptr<FWGChunkResult> pResult);
+
+	// Game thread. How many recycled results are kept (the chunks that can be generated at once without allocating).
+	void  setMaxFreeResults (size_t iMaxCount);
+
+	FWGChunkJobStats getStats () const;
+
+	static float getPriority (long long iX, long long iY, long long iCentralX, long long iCentralY);
+
+private:
+
+	// Worker thread, runs the closest job.
+	void  runJob      ();
+
+	bool  isCancelled (const FWGChunkJob& job) const;
+
+	// Locked. Removes the pending job.
+	void  cancelJob   (size_t iJobIndex);
+
+	// Locked. Drops what the job referenced, the arrays are kept.
+	void  addFreeResult (std::shared_ptr<FWGChunkResult> pResult);
+
+	// Locked. Cancels the pending and the running jobs of the chunk.
+	void  cancelJobsOfChunk (const TWeakObjectPtr<AFWGChunk>& pChunk);
+
+	static bool isOutOfRadius (const FWGChunkJob& job, long long iCentralX, long long iCentralY, long long iRadius);
+
+
+	// Pending (the closest one is taken from the middle).
+	std::vector<std::shared_ptr<FWGChunkResult>> vJobs;
+	std::deque<std::shared_ptr<FWGChunkResult>>  vResults;
+
+	// Jobs the workers run now (they own them). adoptJob() changes their fields the workers do not read.
+	std::vector<FWGChunkJob*>                    vRunningJobs;
+
+	// Results given back by recycleResult() and of the cancelled jobs, newJob() takes one (if any).
+	std::vector<std::shared_ptr<FWGChunkResult>> vFreeResults;
+	size_t                                       iMaxFreeResults = 0;
+
+	std::atomic<uint32>                          iEpoch {0};
+
+	FWGChunkJobStats                             stats;
+
+	// Of the finished jobs (seconds).
+	double                                       fAverageJobTime = 0.0;
+	int32                                        iFinishedJobCount = 0;
+
+	mutable std::mutex                           mtxQueues;
+};
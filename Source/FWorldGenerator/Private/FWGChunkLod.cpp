@@ -0,0 +1,122 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkLod.h"
+
+// Custom
+#include "FWGChunk.h"
+
+
+// Every iStride-th of iCount lines, the last one is always kept.
+static TArray<int32> pickLines(int32 iCount, int32 iStride)
+{
+	TArray<int32> vLines;
+	vLines.Reserve(iCount / iStride + 2);
+
+	for (int32 i = 0; i < iCount - 1; i += iStride)
+	{
+		vLines.Add(i);
+	}
+
+	vLines.Add(iCount - 1);
+
+	return vLines;
+}
+
+// Max Z distance between the vertices of a border line (iFirst, iFirst + iStep, ...)
+// and the straight segments between the kept ones.
+static float getLineError(const TArray<FVector>& vVertices, int32 iFirst, int32 iStep, const TArray<int32>& vKept)
+{
+	float fMaxError = 0.0f;
+
+	for (int32 k = 1; k < vKept.Num(); k++)
+	{
+		const int32 iLength = vKept[k] - vKept[k - 1];
+
+		const float fStartZ = vVertices[iFirst + vKept[k - 1] * iStep].Z;
+		const float fEndZ   = vVertices[iFirst + vKept[k]     * iStep].Z;
+
+		for (int32 t = 1; t < iLength; t++)
+		{
+			const float fLodZ = fStartZ + (fEndZ - fStartZ) * t / iLength;
+
+			fMaxError = FMath::Max(fMaxError, FMath::Abs(vVertices[iFirst + (vKept[k - 1] + t) * iStep].Z - fLodZ));
+		}
+	}
+
+	return fMaxError;
+}
+
+
+FWGChunkLod::FWGChunkLod(int32 iRowCount, int32 iColumnCount, int32 iLevel)
+	: iLevel(iLevel), iRowCount(iRowCount), iColumnCount(iColumnCount),
+	vRows(pickLines(iRowCount, 1 << iLevel)), vColumns(pickLines(iColumnCount, 1 << iLevel)),
+	indexBuffer(vRows.Num(), vColumns.Num(), true)
+{
+}
+
+float FWGChunkLod::getBorderError(const TArray<FVector>& vVertices) const
+{
+	float fMaxError = 0.0f;
+
+	// First and last row.
+	fMaxError = FMath::Max(fMaxError, getLineError(vVertices, 0, 1, vColumns));
+	fMaxError = FMath::Max(fMaxError, getLineError(vVertices, (iRowCount - 1) * iColumnCount, 1, vColumns));
+
+	// First and last column.
+	fMaxError = FMath::Max(fMaxError, getLineError(vVertices, 0, iColumnCount, vRows));
+	fMaxError = FMath::Max(fMaxError, getLineError(vVertices, iColumnCount - 1, iColumnCount, vRows));
+
+	return fMaxError;
+}
+
+void FWGChunkLod::build(AFWGChunk* pChunk, float fSkirtDepth) const
+{
+	const int32 iVertexCount = indexBuffer.getVertexCount();
+
+	pChunk->vLodVertices     .SetNumUninitialized(iVertexCount, false);
+	pChunk->vLodNormals      .SetNumUninitialized(iVertexCount, false);
+	pChunk->vLodVertexColors .SetNumUninitialized(iVertexCount, false);
+
+	// The UV comes from the location of the vertex in the full resolution grid (see FWGTerrainVertexFactory),
+	// the material tiles the same way on every level.
+
+	int32 k = 0;
+
+	for (int32 i = 0; i < vRows.Num(); i++)
+	{
+		for (int32 j = 0; j < vColumns.Num(); j++)
+		{
+			const int32 iSource = vRows[i] * iColumnCount + vColumns[j];
+
+			pChunk->vLodVertices     [k] = pChunk->vVertices     [iSource];
+			pChunk->vLodNormals      [k] = pChunk->vNormals      [iSource];
+			pChunk->vLodVertexColors [k] = pChunk->vVertexColors [iSource];
+
+			k++;
+		}
+	}
+
+	// The skirt has the normal and the material of the border, so it looks like the terrain it hides.
+
+	const TArray<int32>& vSkirtVertices = indexBuffer.getSkirtVertices();
+
+	for (int32 s = 0; s < vSkirtVertices.Num(); s++)
+	{
+		const int32 iSource = vSkirtVertices[s];
+
+		pChunk->vLodVertices     [k] = pChunk->vLodVertices     [iSource];
+		pChunk->vLodVertices     [k].Z -= fSkirtDepth;
+		pChunk->vLodNormals      [k] = pChunk->vLodNormals      [iSource];
+		pChunk->vLodVertexColors [k] = pChunk->vLodVertexColors [iSource];
+
+		k++;
+	}
+}
+
+const FWGChunkIndexBuffer& FWGChunkLod::getIndexBuffer() const
+{
+	return indexBuffer;
+}
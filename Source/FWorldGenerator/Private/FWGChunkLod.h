@@ -0,0 +1,59 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Custom
+#include "FWGChunkIndexBuffer.h"
+
+
+class AFWGChunk;
+
+
+// Highest LOD level: every 64th vertex row and column.
+#define FWG_LOD_MAX_LEVEL 6
+// Skirts are at least this part of the chunk piece size deep, so that the skirts between two chunks
+// of the same level (no crack to hide) still cover the rounding gaps of the rasterizer.
+#define FWG_LOD_MIN_SKIRT_DEPTH 0.1f
+
+
+// One LOD level of a chunk: every 2^iLevel-th vertex row and column of the full resolution chunk
+// (the last row and column are always kept), plus a skirt hanging down from the border.
+// Levels of the neighbour chunks differ by at most 1, the skirts are deep enough to cover the crack
+// between the borders of two such levels (see AFWGen::updateChunkMesh()).
+// The LOD is resampled from the vertices the chunk already has, no noise is evaluated, so changing
+// the level of a chunk (when the central chunk moves) costs about as much as a mesh update.
+class FWGChunkLod
+{
+public:
+
+	// iRowCount x iColumnCount - vertices of the full resolution chunk.
+	FWGChunkLod(int32 iRowCount, int32 iColumnCount, int32 iLevel);
+
+	// Max Z distance between the full resolution border of the chunk and the border of this level.
+	float   getBorderError  (const TArray<FVector>& vVertices) const;
+
+	// Fills the vLod* arrays of the chunk from its full resolution arrays, their memory is reused.
+	// The skirt vertices are fSkirtDepth below the border.
+	void    build           (AFWGChunk* pChunk, float fSkirtDepth) const;
+
+	const FWGChunkIndexBuffer& getIndexBuffer () const;
+
+
+	const int32            iLevel;
+
+	const int32            iRowCount;
+	const int32            iColumnCount;
+
+private:
+
+	// Rows (columns) of the full resolution chunk this level keeps.
+	const TArray<int32>    vRows;
+	const TArray<int32>    vColumns;
+
+	const FWGChunkIndexBuffer indexBuffer;
+};
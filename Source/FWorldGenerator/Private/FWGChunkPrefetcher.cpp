@@ -0,0 +1,177 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkPrefetcher.h"
+
+// STL
+#include <cmath>
+
+FWGChunkPrefetcher::FWGChunkPrefetcher(const std::shared_ptr<FWGChunkJobQueue>& pJobs) : pJobs(pJobs)
+{
+}
+
+void FWGChunkPrefetcher::addPathPoint(const FVector& vLocation, double fTime)
+{
+	if ((vPath.empty() == false) && (fTime < vPath.back().fTime))
+	{
+		vPath.clear();
+	}
+
+	FPathPoint point;
+	point.vLocation = vLocation;
+	point.fTime     = fTime;
+
+	vPath.push_back(point);
+
+	while ((vPath.size() > 2) && ((fTime - vPath[1].fTime) >= FWG_PREFETCH_PATH_TIME))
+	{
+		vPath.pop_front();
+	}
+}
+
+FVector FWGChunkPrefetcher::predictLocation(const FVector& vVelocity, float fLookahead) const
+{
+	if (vPath.empty())
+	{
+		return FVector(0.0f, 0.0f, 0.0f);
+	}
+
+	FVector vPredictedVelocity = vVelocity;
+
+	const double fPathTime = vPath.back().fTime - vPath.front().fTime;
+
+	if (fPathTime >= FWG_PREFETCH_MIN_PATH_TIME)
+	{
+		const FVector vPathVelocity = (vPath.back().vLocation - vPath.front().vLocation) / static_cast<float>(fPathTime);
+
+		vPredictedVelocity = (vVelocity + vPathVelocity) / 2.0f;
+	}
+
+	return vPath.back().vLocation + vPredictedVelocity * fLookahead;
+}
+
+void FWGChunkPrefetcher::clearPath()
+{
+	vPath.clear();
+}
+
+void FWGChunkPrefetcher::addResult(std::shared_ptr<FWGChunkResult> pResult)
+{
+	const FChunkKey key(pResult->job.iX, pResult->job.iY);
+
+	auto it = mResults.find(key);
+
+	if (it != mResults.end())
+	{
+		// Prefetched again after the world was generated again.
+		iWastedCount++;
+
+		throwAway(std::move(it->second));
+
+		it->second = std::move(pResult);
+	}
+	else
+	{
+		mResults[key] = std::move(pResult);
+	}
+
+	iPrefetchedCount++;
+}
+
+bool FWGChunkPrefetcher::hasResult(long long iX, long long iY) const
+{
+	return mResults.find(FChunkKey(iX, iY)) != mResults.end();
+}
+
+std::shared_ptr<FWGChunkResult> FWGChunkPrefetcher::takeResult(long long iX, long long iY, const FWGChunkGenerator* pGenerator)
+{
+	auto it = mResults.find(FChunkKey(iX, iY));
+
+	if (it == mResults.end())
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<FWGChunkResult> pResult = std::move(it->second);
+	mResults.erase(it);
+
+	if (pResult->job.pGenerator.get() != pGenerator)
+	{
+		// Made for the world before the last GenerateWorld().
+		iWastedCount++;
+
+		throwAway(std::move(pResult));
+
+		return nullptr;
+	}
+
+	return pResult;
+}
+
+void FWGChunkPrefetcher::removeFarResults(long long iCentralX, long long iCentralY, long long iRadius)
+{
+	for (auto it = mResults.begin(); it != mResults.end(); )
+	{
+		if ((std::abs(it->first.first - iCentralX) > iRadius) || (std::abs(it->first.second - iCentralY) > iRadius))
+		{
+			throwAway(std::move(it->second));
+
+			it = mResults.erase(it);
+
+			iWastedCount++;
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void FWGChunkPrefetcher::clear()
+{
+	for (auto it = mResults.begin(); it != mResults.end(); ++it)
+	{
+		throwAway(std::move(it->second));
+	}
+
+	mResults.clear();
+
+	vPath.clear();
+}
+
+void FWGChunkPrefetcher::addLoad(bool bHit)
+{
+	iLoadCount++;
+
+	if (bHit)
+	{
+		iHitCount++;
+	}
+}
+
+float FWGChunkPrefetcher::getHitRatio() const
+{
+	if (iLoadCount == 0)
+	{
+		return 0.0f;
+	}
+
+	return static_cast<float>(iHitCount) / iLoadCount;
+}
+
+float FWGChunkPrefetcher::getWasteRatio() const
+{
+	if (iPrefetchedCount == 0)
+	{
+		return 0.0f;
+	}
+
+	return static_cast<float>(iWastedCount) / iPrefetchedCount;
+}
+
+void FWGChunkPrefetcher::throwAway(std::shared_ptr<FWGChunkResult> pResult)
+{
+	pJobs->recycleResult(std::move(pResult));
+}
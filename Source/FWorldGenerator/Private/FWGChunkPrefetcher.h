@@ -0,0 +1,92 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <deque>
+#include <map>
+#include <memory>
+
+// Custom
+#include "FWGChunkJobQueue.h"
+
+
+// Seconds of the path of the streaming source used to predict where it goes.
+#define FWG_PREFETCH_PATH_TIME     0.5
+// Shorter paths are not used (the source has just started to move or was teleported).
+#define FWG_PREFETCH_MIN_PATH_TIME 0.1
+
+
+// Where the streaming source (the player) is going and the chunks generated for it before they are loaded.
+// AFWGen::Tick() adds the prefetch jobs for the chunks that would be loaded if the source were where it is predicted to be
+// after PrefetchLookahead seconds, their results wait here (never committed) until the chunk is loaded or goes out of range.
+// Game thread only.
+class FWGChunkPrefetcher
+{
+public:
+
+	// The results that are thrown away go back to pJobs (see FWGChunkJobQueue::recycleResult()).
+	FWGChunkPrefetcher(const std::shared_ptr<FWGChunkJobQueue>& pJobs);
+
+
+	// Adds the current location of the streaming source to its path (forgets the path if fTime goes back).
+	void    addPathPoint     (const FVector& vLocation, double fTime);
+
+	// Where the streaming source is expected to be in fLookahead seconds: the average of its velocity
+	// and of the velocity along its recent path (the velocity reacts to turns at once, the path smooths out the jitter).
+	FVector predictLocation  (const FVector& vVelocity, float fLookahead) const;
+	void    clearPath        ();
+
+
+	// Result of a prefetch job.
+	void    addResult        (std::shared_ptr<FWGChunkResult> pResult);
+	bool    hasResult        (long long iX, long long iY) const;
+
+	// Game thread, the chunk (iX, iY) is loaded: its prefetched result if it was made by pGenerator, nullptr otherwise.
+	std::shared_ptr<FWGChunkResult> takeResult (long long iX, long long iY, const FWGChunkGenerator* pGenerator);
+
+	// Throws away the results farther than iRadius chunks from the central chunk (wasted).
+	void    removeFarResults (long long iCentralX, long long iCentralY, long long iRadius);
+
+	// Throws away all results (not counted as wasted: the world was cleared).
+	void    clear            ();
+
+
+	// A chunk was loaded, bHit - it was prefetched (its result was taken or its prefetch job was adopted).
+	void    addLoad          (bool bHit);
+
+	// Part of the loaded chunks that were prefetched.
+	float   getHitRatio      () const;
+	// Part of the prefetched chunks that were thrown away.
+	float   getWasteRatio    () const;
+
+private:
+
+	struct FPathPoint
+	{
+		FVector  vLocation;
+		double   fTime;
+	};
+
+	typedef std::pair<long long, long long> FChunkKey;
+
+
+	void    throwAway        (std::shared_ptr<FWGChunkResult> pResult);
+
+
+	std::deque<FPathPoint>                               vPath;
+
+	std::map<FChunkKey, std::shared_ptr<FWGChunkResult>> mResults;
+
+	std::shared_ptr<FWGChunkJobQueue>                    pJobs;
+
+	int32                                                iLoadCount       = 0;
+	int32                                                iHitCount        = 0;
+	int32                                                iPrefetchedCount = 0;
+	int32                                                iWastedCount     = 0;
+};
@@ -0,0 +1,281 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGChunkRtin.h"
+
+// Custom
+#include "FWGChunk.h"
+
+
+FWGChunkRtin::FWGChunkRtin(int32 iRowCount, int32 iColumnCount)
+	: iRowCount(iRowCount), iColumnCount(iColumnCount),
+	iGridSize(static_cast<int32>(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(iRowCount, iColumnCount) - 1))) + 1)
+{
+	const int32 iTileSize      = iGridSize - 1;
+	const int32 iTriangleCount = iTileSize * iTileSize * 2 - 2;
+
+	iParentTriangleCount = iTriangleCount - iTileSize * iTileSize;
+
+	vTriangleCoords.resize(static_cast<size_t>(iTriangleCount) * 4);
+
+	// Triangle id: the 2 top triangles are 2 and 3, the children of the triangle k are 2k and 2k + 1,
+	// the bits of the id after the first one are the path from the top triangle.
+
+	for (int32 i = 0; i < iTriangleCount; i++)
+	{
+		int32 iId = i + 2;
+
+		int32 ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+
+		if (iId & 1)
+		{
+			bx = by = cx = iTileSize;
+		}
+		else
+		{
+			ax = ay = cy = iTileSize;
+		}
+
+		while ((iId >>= 1) > 1)
+		{
+			const int32 mx = (ax + bx) >> 1;
+			const int32 my = (ay + by) >> 1;
+
+			if (iId & 1)
+			{
+				bx = ax;
+				by = ay;
+				ax = cx;
+				ay = cy;
+			}
+			else
+			{
+				ax = bx;
+				ay = by;
+				bx = cx;
+				by = cy;
+			}
+
+			cx = mx;
+			cy = my;
+		}
+
+		vTriangleCoords[i * 4 + 0] = static_cast<uint16>(ax);
+		vTriangleCoords[i * 4 + 1] = static_cast<uint16>(ay);
+		vTriangleCoords[i * 4 + 2] = static_cast<uint16>(bx);
+		vTriangleCoords[i * 4 + 3] = static_cast<uint16>(by);
+	}
+}
+
+void FWGChunkRtin::triangulate(const TArray<FVector>& vVertices, float fMaxError, TArray<int32>& vTriangles) const
+{
+	// Reused by the next chunk of this thread.
+	static thread_local std::vector<float> vHeights;
+	static thread_local std::vector<float> vErrors;
+
+	vHeights.resize(static_cast<size_t>(iGridSize) * iGridSize);
+	vErrors.assign(static_cast<size_t>(iGridSize) * iGridSize, 0.0f);
+
+	// Outside of the chunk the grid repeats the nearest chunk vertex, this adds no error
+	// to the triangles of the chunk.
+	for (int32 y = 0; y < iGridSize; y++)
+	{
+		const int32 iRow = FMath::Min(y, iRowCount - 1) * iColumnCount;
+
+		for (int32 x = 0; x < iGridSize; x++)
+		{
+			vHeights[y * iGridSize + x] = vVertices[iRow + FMath::Min(x, iColumnCount - 1)].Z;
+		}
+	}
+
+	// The border of the chunk keeps all vertices, so no triangle crosses it.
+
+	for (int32 x = 0; x < iColumnCount; x++)
+	{
+		vErrors[x]                                  = MAX_flt;
+		vErrors[(iRowCount - 1) * iGridSize + x]    = MAX_flt;
+	}
+
+	for (int32 y = 0; y < iRowCount; y++)
+	{
+		vErrors[y * iGridSize]                      = MAX_flt;
+		vErrors[y * iGridSize + iColumnCount - 1]   = MAX_flt;
+	}
+
+	// From the smallest triangles to the biggest: the error of the middle of a hypotenuse is the max
+	// of its own error and the errors of the middles of the two children, so that a vertex is never
+	// used without the vertices of the triangles above it.
+
+	const int32 iTriangleCount = static_cast<int32>(vTriangleCoords.size() / 4);
+
+	for (int32 i = iTriangleCount - 1; i >= 0; i--)
+	{
+		const int32 ax = vTriangleCoords[i * 4 + 0];
+		const int32 ay = vTriangleCoords[i * 4 + 1];
+		const int32 bx = vTriangleCoords[i * 4 + 2];
+		const int32 by = vTriangleCoords[i * 4 + 3];
+
+		const int32 mx = (ax + bx) >> 1;
+		const int32 my = (ay + by) >> 1;
+		const int32 cx = mx + my - ay;
+		const int32 cy = my + ax - mx;
+
+		const int32 iMiddle = my * iGridSize + mx;
+
+		const float fInterpolated = (vHeights[ay * iGridSize + ax] + vHeights[by * iGridSize + bx]) / 2.0f;
+
+		float fError = FMath::Max(vErrors[iMiddle], FMath::Abs(fInterpolated - vHeights[iMiddle]));
+
+		if (i < iParentTriangleCount)
+		{
+			const int32 iLeftChild  = ((ay + cy) >> 1) * iGridSize + ((ax + cx) >> 1);
+			const int32 iRightChild = ((by + cy) >> 1) * iGridSize + ((bx + cx) >> 1);
+
+			fError = FMath::Max(fError, FMath::Max(vErrors[iLeftChild], vErrors[iRightChild]));
+		}
+
+		vErrors[iMiddle] = fError;
+	}
+
+	vTriangles.Reset();
+
+	const int32 iMax = iGridSize - 1;
+
+	splitTriangle(0, 0, iMax, iMax, iMax, 0, vErrors.data(), fMaxError, vTriangles);
+	splitTriangle(iMax, iMax, 0, 0, 0, iMax, vErrors.data(), fMaxError, vTriangles);
+}
+
+int32 FWGChunkRtin::build(AFWGChunk* pChunk, float fMaxError, TArray<int32>& vTriangles) const
+{
+	triangulate(pChunk->vVertices, fMaxError, vTriangles);
+
+	// Index of the chunk vertex in the vLod* arrays, -1 if not used yet.
+	static thread_local std::vector<int32> vVertexMap;
+
+	vVertexMap.assign(static_cast<size_t>(iRowCount) * iColumnCount, -1);
+
+	pChunk->vLodVertices     .Reset();
+	pChunk->vLodNormals      .Reset();
+	pChunk->vLodVertexColors .Reset();
+
+	for (int32 k = 0; k < vTriangles.Num(); k++)
+	{
+		const int32 iSource = vTriangles[k];
+
+		int32& iLodIndex = vVertexMap[iSource];
+
+		if (iLodIndex == -1)
+		{
+			iLodIndex = pChunk->vLodVertices.Num();
+
+			pChunk->vLodVertices     .Add(pChunk->vVertices     [iSource]);
+			pChunk->vLodNormals      .Add(pChunk->vNormals      [iSource]);
+			pChunk->vLodVertexColors .Add(pChunk->vVertexColors [iSource]);
+		}
+
+		vTriangles[k] = iLodIndex;
+	}
+
+	return vTriangles.Num() / 3;
+}
+
+float FWGChunkRtin::getMaxError(const TArray<FVector>& vVertices, const TArray<int32>& vTriangles) const
+{
+	float fMaxError = 0.0f;
+
+	for (int32 t = 0; t + 2 < vTriangles.Num(); t += 3)
+	{
+		const int32 ax = vTriangles[t]     % iColumnCount, ay = vTriangles[t]     / iColumnCount;
+		const int32 bx = vTriangles[t + 1] % iColumnCount, by = vTriangles[t + 1] / iColumnCount;
+		const int32 cx = vTriangles[t + 2] % iColumnCount, cy = vTriangles[t + 2] / iColumnCount;
+
+		const float fArea = static_cast<float>((bx - ax) * (cy - ay) - (by - ay) * (cx - ax));
+
+		const float az = vVertices[vTriangles[t]].Z;
+		const float bz = vVertices[vTriangles[t + 1]].Z;
+		const float cz = vVertices[vTriangles[t + 2]].Z;
+
+		// Every vertex in the bounding box that is inside of the triangle (barycentric coordinates).
+
+		for (int32 y = FMath::Min3(ay, by, cy); y <= FMath::Max3(ay, by, cy); y++)
+		{
+			for (int32 x = FMath::Min3(ax, bx, cx); x <= FMath::Max3(ax, bx, cx); x++)
+			{
+				const float u = ((cx - bx) * (y - by) - (cy - by) * (x - bx)) / fArea;
+				const float v = ((ax - cx) * (y - cy) - (ay - cy) * (x - cx)) / fArea;
+				const float w = 1.0f - u - v;
+
+				if ((u < 0.0f) || (v < 0.0f) || (w < 0.0f))
+				{
+					continue;
+				}
+
+				const float fZ = u * az + v * bz + w * cz;
+
+				fMaxError = FMath::Max(fMaxError, FMath::Abs(vVertices[y * iColumnCount + x].Z - fZ));
+			}
+		}
+	}
+
+	return fMaxError;
+}
+
+int32 FWGChunkRtin::getFullTriangleCount() const
+{
+	return (iRowCount - 1) * (iColumnCount - 1) * 2;
+}
+
+void FWGChunkRtin::splitTriangle(int32 ax, int32 ay, int32 bx, int32 by, int32 cx, int32 cy,
+	const float* pErrors, float fMaxError, TArray<int32>& vTriangles) const
+{
+	// a - b is the hypotenuse, c is the right angle.
+
+	if ((ax >= iColumnCount) && (bx >= iColumnCount) && (cx >= iColumnCount))
+	{
+		// Outside of the chunk.
+		return;
+	}
+
+	if ((ay >= iRowCount) && (by >= iRowCount) && (cy >= iRowCount))
+	{
+		return;
+	}
+
+	const int32 mx = (ax + bx) >> 1;
+	const int32 my = (ay + by) >> 1;
+
+	if ((FMath::Abs(ax - cx) + FMath::Abs(ay - cy) > 1) && (pErrors[my * iGridSize + mx] > fMaxError))
+	{
+		splitTriangle(cx, cy, ax, ay, mx, my, pErrors, fMaxError, vTriangles);
+		splitTriangle(bx, by, cx, cy, mx, my, pErrors, fMaxError, vTriangles);
+
+		return;
+	}
+
+	if ((FMath::Max3(ax, bx, cx) >= iColumnCount) || (FMath::Max3(ay, by, cy) >= iRowCount))
+	{
+		// Outside of the chunk (the border of the chunk is never crossed).
+		return;
+	}
+
+	// Same winding as the regular grid (FWGChunkIndexBuffer).
+
+	const int32 iA = ay * iColumnCount + ax;
+	const int32 iB = by * iColumnCount + bx;
+	const int32 iC = cy * iColumnCount + cx;
+
+	if ((bx - ax) * (cy - ay) - (by - ay) * (cx - ax) < 0)
+	{
+		vTriangles.Add(iA);
+		vTriangles.Add(iB);
+		vTriangles.Add(iC);
+	}
+	else
+	{
+		vTriangles.Add(iA);
+		vTriangles.Add(iC);
+		vTriangles.Add(iB);
+	}
+}
@@ -0,0 +1,64 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <vector>
+
+
+class AFWGChunk;
+
+
+// Right-triangulated irregular network (RTIN) of a chunk: the grid is split into right triangles
+// by halving their hypotenuse, only where the height in the middle of the hypotenuse is more than
+// fMaxError away from the straight line (the error of a vertex includes the errors of the vertices
+// under it, so the triangles always fit together). Flat ground is covered by a few big triangles.
+// RTIN needs a square grid of 2^n + 1 vertices, the chunk is placed in the corner of the smallest
+// such grid and the triangles outside of the chunk are dropped. The border of the chunk always keeps
+// all of its vertices, so it is exactly the border of the neighbour chunks whatever their triangles are.
+// The triangle order of the grid only depends on the chunk size and is built once.
+class FWGChunkRtin
+{
+public:
+
+	// iRowCount x iColumnCount - vertices of the chunk.
+	FWGChunkRtin(int32 iRowCount, int32 iColumnCount);
+
+	// Writes the triangles (3 chunk vertex indices each, same winding as FWGChunkIndexBuffer) to vTriangles.
+	// Only Z of vVertices is used.
+	void   triangulate    (const TArray<FVector>& vVertices, float fMaxError, TArray<int32>& vTriangles) const;
+
+	// Triangulates the chunk and fills its vLod* arrays with the vertices the triangles use,
+	// the triangles are written to vTriangles (indices of the vLod* arrays). Returns the triangle count.
+	int32  build          (AFWGChunk* pChunk, float fMaxError, TArray<int32>& vTriangles) const;
+
+	// Max Z distance between the chunk vertices and the triangles (chunk vertex indices).
+	float  getMaxError    (const TArray<FVector>& vVertices, const TArray<int32>& vTriangles) const;
+
+	// Triangles of the chunk as a regular grid.
+	int32  getFullTriangleCount () const;
+
+
+	const int32             iRowCount;
+	const int32             iColumnCount;
+
+	// Vertices per side of the RTIN grid, 2^n + 1.
+	const int32             iGridSize;
+
+private:
+
+	void   splitTriangle  (int32 ax, int32 ay, int32 bx, int32 by, int32 cx, int32 cy,
+		const float* pErrors, float fMaxError, TArray<int32>& vTriangles) const;
+
+
+	// Hypotenuse (ax, ay, bx, by) of every triangle of the RTIN grid, the smallest triangles last.
+	std::vector<uint16>     vTriangleCoords;
+
+	// The triangles before this one have children.
+	int32                   iParentTriangleCount;
+};
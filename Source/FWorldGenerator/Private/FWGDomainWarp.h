@@ -0,0 +1,249 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <vector>
+
+// Custom
+#include "FWGNoise.h"
+
+
+// Vertices between two samples of the warp field.
+#define FWG_DOMAIN_WARP_LATTICE_STEP 8
+// The warp field only needs the first (slowest) octaves.
+#define FWG_DOMAIN_WARP_OCTAVES 2
+
+// Noise of one chunk, row by row, like FWGNoiseContext::octaveNoise0_1RowDerivatives(), but sampled at
+// coordinates moved by a low frequency vector field (domain warping), which breaks up the grid-like
+// look of the octaves.
+// The field is two octave noises of the same source far from the terrain samples, evaluated only on a lattice
+// of every FWG_DOMAIN_WARP_LATTICE_STEP vertices and bilinearly interpolated, so it costs a small part of
+// the terrain noise. The derivatives of the result include the derivatives of the field (chain rule).
+//
+// Lattice points are placed at multiples of the step in global vertex indices, so that
+// neighbour chunks interpolate their common edge from the same samples.
+template <typename TReal>
+class TFWGDomainWarp
+{
+public:
+
+	// iFirstColumn  - global index of the first column (vertex) of the chunk, same for rows.
+	// fOriginX      - noise x of the global column 0, fStepX - noise x between two columns, same for y.
+	// fStrengthX    - max offset along x in noise units, same for y, 0 - no warping.
+	// fFrequency    - frequency of the field relative to the first octave of the terrain noise.
+	TFWGDomainWarp(const FWGNoiseContext& noise, int32 iColumnCount, int32 iRowCount, long long iFirstColumn, long long iFirstRow,
+		double fOriginX, double fOriginY, double fStepX, double fStepY, double fStrengthX, double fStrengthY, double fFrequency)
+		: noise(noise), iColumnCount(iColumnCount), bEnabled((fStrengthX > 0.0) && (fStrengthY > 0.0))
+	{
+		if (bEnabled == false)
+		{
+			return;
+		}
+
+		columns = makeAxis(iFirstColumn, iColumnCount);
+		rows    = makeAxis(iFirstRow,    iRowCount);
+
+		sampleLattice(fOriginX, fOriginY, fStepX, fStepY, fStrengthX, fStrengthY, fFrequency);
+
+		vWarpedX .resize(iColumnCount);
+		vWarpedY .resize(iColumnCount);
+		vWarpedDx.resize(iColumnCount);
+		vWarpedDy.resize(iColumnCount);
+	}
+
+	bool isEnabled() const
+	{
+		return bEnabled;
+	}
+
+	// Row iRow with the noise x pX and y, the same outputs as FWGNoiseContext::octaveNoise0_1RowDerivatives().
+	void sampleRow(int32 iRow, const TReal* pX, TReal y, TReal* pOut, TReal* pOutDx, TReal* pOutDy)
+	{
+		const int32 iTap = rows.vTaps[iRow];
+		const TReal t    = rows.vWeights[iRow];
+
+		const size_t iRow0 = static_cast<size_t>(iTap) * iColumnCount;
+		const size_t iRow1 = iRow0 + iColumnCount;
+
+		const TReal* pField[FIELD_COUNT];
+
+		for (int32 k = 0; k < FIELD_COUNT; k++)
+		{
+			pField[k] = vField[k].data();
+		}
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			vWarpedX[j] = pX[j] + lerp(t, pField[WARP_X][iRow0 + j], pField[WARP_X][iRow1 + j]);
+			vWarpedY[j] = y     + lerp(t, pField[WARP_Y][iRow0 + j], pField[WARP_Y][iRow1 + j]);
+		}
+
+		noise.octaveNoise0_1PointsDerivatives(vWarpedX.data(), vWarpedY.data(), iColumnCount, pOut, vWarpedDx.data(), vWarpedDy.data());
+
+		// d/dx noise(x + wx(x, y), y + wy(x, y)) = noise_x * (1 + wx_x) + noise_y * wy_x, same for y.
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			const TReal fWarpXDx = lerp(t, pField[WARP_X_DX][iRow0 + j], pField[WARP_X_DX][iRow1 + j]);
+			const TReal fWarpXDy = lerp(t, pField[WARP_X_DY][iRow0 + j], pField[WARP_X_DY][iRow1 + j]);
+			const TReal fWarpYDx = lerp(t, pField[WARP_Y_DX][iRow0 + j], pField[WARP_Y_DX][iRow1 + j]);
+			const TReal fWarpYDy = lerp(t, pField[WARP_Y_DY][iRow0 + j], pField[WARP_Y_DY][iRow1 + j]);
+
+			pOutDx[j] = vWarpedDx[j] * (1 + fWarpXDx) + vWarpedDy[j] * fWarpYDx;
+			pOutDy[j] = vWarpedDx[j] * fWarpXDy + vWarpedDy[j] * (1 + fWarpYDy);
+		}
+	}
+
+private:
+
+	// The offsets and their derivatives by the original x and y.
+	enum
+	{
+		WARP_X,
+		WARP_Y,
+		WARP_X_DX,
+		WARP_X_DY,
+		WARP_Y_DX,
+		WARP_Y_DY,
+		FIELD_COUNT
+	};
+
+	// Linear taps of every vertex along one axis.
+	struct FAxis
+	{
+		long long           iFirstLattice;  // Global lattice index of the lattice point 0.
+		int32               iLatticeCount;
+
+		std::vector<int32>  vTaps;          // First of the 2 lattice points used by the vertex.
+		std::vector<TReal>  vWeights;       // Weight of the second one.
+	};
+
+
+	static TReal lerp(TReal t, TReal a, TReal b)
+	{
+		return a + t * (b - a);
+	}
+
+	static long long floorDivide(long long iValue, long long iDivisor)
+	{
+		return (iValue >= 0) ? (iValue / iDivisor) : -((-iValue + iDivisor - 1) / iDivisor);
+	}
+
+	static FAxis makeAxis(long long iFirst, int32 iCount)
+	{
+		FAxis axis;
+
+		axis.iFirstLattice = floorDivide(iFirst, FWG_DOMAIN_WARP_LATTICE_STEP);
+		axis.iLatticeCount = static_cast<int32>(floorDivide(iFirst + iCount - 1, FWG_DOMAIN_WARP_LATTICE_STEP) + 1 - axis.iFirstLattice + 1);
+
+		axis.vTaps.resize(iCount);
+		axis.vWeights.resize(iCount);
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			const long long iCell = floorDivide(iFirst + i, FWG_DOMAIN_WARP_LATTICE_STEP);
+
+			axis.vTaps[i]    = static_cast<int32>(iCell - axis.iFirstLattice);
+			axis.vWeights[i] = static_cast<TReal>(static_cast<double>(iFirst + i - iCell * FWG_DOMAIN_WARP_LATTICE_STEP) / FWG_DOMAIN_WARP_LATTICE_STEP);
+		}
+
+		return axis;
+	}
+
+	// Samples the field on the lattice and interpolates every lattice row along x right away,
+	// so that a vertex only needs the interpolation between two rows.
+	void sampleLattice(double fOriginX, double fOriginY, double fStepX, double fStepY, double fStrengthX, double fStrengthY, double fFrequency)
+	{
+		const int32 iOctaveCount = FMath::Min(noise.iOctaves, FWG_DOMAIN_WARP_OCTAVES);
+
+		const int32 iLatticeColumnCount = columns.iLatticeCount;
+
+		// Far from each other and from the terrain samples, so that the components look unrelated.
+		const double vOffsetX[2] = { 5.2, 1.7 };
+		const double vOffsetY[2] = { 1.3, 9.2 };
+
+		std::vector<TReal> vLatticeX[2];
+
+		for (int32 c = 0; c < 2; c++)
+		{
+			vLatticeX[c].resize(iLatticeColumnCount);
+
+			for (int32 k = 0; k < iLatticeColumnCount; k++)
+			{
+				const double x = fOriginX + static_cast<double>((columns.iFirstLattice + k) * FWG_DOMAIN_WARP_LATTICE_STEP) * fStepX;
+
+				vLatticeX[c][k] = static_cast<TReal>(x * fFrequency + vOffsetX[c]);
+			}
+		}
+
+		std::vector<TReal> vValue(iLatticeColumnCount);
+		std::vector<TReal> vDx(iLatticeColumnCount);
+		std::vector<TReal> vDy(iLatticeColumnCount);
+
+		for (int32 f = 0; f < FIELD_COUNT; f++)
+		{
+			vField[f].resize(static_cast<size_t>(rows.iLatticeCount) * iColumnCount);
+		}
+
+		for (int32 k = 0; k < rows.iLatticeCount; k++)
+		{
+			const double y = fOriginY + static_cast<double>((rows.iFirstLattice + k) * FWG_DOMAIN_WARP_LATTICE_STEP) * fStepY;
+
+			const size_t iRowStart = static_cast<size_t>(k) * iColumnCount;
+
+			for (int32 c = 0; c < 2; c++)
+			{
+				noise.octaveNoiseRowDerivatives(vLatticeX[c].data(), static_cast<TReal>(y * fFrequency + vOffsetY[c]), iLatticeColumnCount,
+					0, iOctaveCount, vValue.data(), vDx.data(), vDy.data());
+
+				// The field is sampled at x * fFrequency, so its derivatives by x are fFrequency times bigger.
+				const double fStrength = (c == 0) ? fStrengthX : fStrengthY;
+				const TReal  fSlope    = static_cast<TReal>(fStrength * fFrequency);
+
+				for (int32 i = 0; i < iLatticeColumnCount; i++)
+				{
+					vValue[i] *= static_cast<TReal>(fStrength);
+					vDx[i]    *= fSlope;
+					vDy[i]    *= fSlope;
+				}
+
+				upsampleRow(vValue.data(), &vField[(c == 0) ? WARP_X    : WARP_Y]   [iRowStart]);
+				upsampleRow(vDx   .data(), &vField[(c == 0) ? WARP_X_DX : WARP_Y_DX][iRowStart]);
+				upsampleRow(vDy   .data(), &vField[(c == 0) ? WARP_X_DY : WARP_Y_DY][iRowStart]);
+			}
+		}
+	}
+
+	void upsampleRow(const TReal* pLattice, TReal* pOut) const
+	{
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			const int32 iTap = columns.vTaps[j];
+
+			pOut[j] = lerp(columns.vWeights[j], pLattice[iTap], pLattice[iTap + 1]);
+		}
+	}
+
+
+	const FWGNoiseContext&  noise;
+
+	const int32             iColumnCount;
+	const bool              bEnabled;
+
+	FAxis                   columns;
+	FAxis                   rows;
+
+	// Lattice rows already interpolated along x: rows.iLatticeCount rows of iColumnCount values.
+	std::vector<TReal>      vField[FIELD_COUNT];
+
+	// Warped coordinates of the current row and the noise derivatives there.
+	std::vector<TReal>      vWarpedX;
+	std::vector<TReal>      vWarpedY;
+	std::vector<TReal>      vWarpedDx;
+	std::vector<TReal>      vWarpedDy;
+};
@@ -0,0 +1,266 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGHeightfieldComponent.h"
+
+// UE
+#include "Engine/World.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+#define FWG_WITH_HEIGHTFIELD 1
+
+#include "PhysXPublic.h"
+#include "PhysicsPublic.h"
+#include "IPhysXCookingModule.h"
+#include "IPhysXCooking.h"
+#include "Physics/PhysicsFiltering.h"
+#else
+#define FWG_WITH_HEIGHTFIELD 0
+#endif // WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+
+// STL
+#include <vector>
+
+
+// Samples are 16 bit, the highest vertex of the chunk gets this height.
+#define FWG_HEIGHTFIELD_MAX_SAMPLE_HEIGHT 32767.0f
+
+// Height of the sample 1 of a flat chunk (the physics engine does not allow 0).
+#define FWG_HEIGHTFIELD_MIN_HEIGHT_SCALE  0.01f
+
+
+FWGHeightfield::FWGHeightfield(const TArray<FVector>& vVertices, int32 iRowCount, int32 iColumnCount, int32 iStep, IPhysXCookingModule* pCookingModule)
+	: pHeightField(nullptr), iSampleRowCount(0), iSampleColumnCount(0), vOrigin(0.0f, 0.0f, 0.0f),
+	fRowScale(0.0f), fColumnScale(0.0f), fHeightScale(0.0f), bounds(ForceInit)
+{
+#if FWG_WITH_HEIGHTFIELD
+	if ((iRowCount < 2) || (iColumnCount < 2) || (vVertices.Num() != iRowCount * iColumnCount) || (pCookingModule == nullptr))
+	{
+		return;
+	}
+
+	iStep = FMath::Max(iStep, 1);
+
+	// The samples are evenly spaced, not farther than iStep vertices from each other.
+
+	iSampleRowCount    = (iRowCount    + iStep - 2) / iStep + 1;
+	iSampleColumnCount = (iColumnCount + iStep - 2) / iStep + 1;
+
+	std::vector<int32> vSampleRows(iSampleRowCount);
+	std::vector<int32> vSampleColumns(iSampleColumnCount);
+
+	for (int32 r = 0; r < iSampleRowCount; r++)
+	{
+		vSampleRows[r] = FMath::RoundToInt(static_cast<float>(r) * (iRowCount - 1) / (iSampleRowCount - 1));
+	}
+
+	for (int32 c = 0; c < iSampleColumnCount; c++)
+	{
+		vSampleColumns[c] = FMath::RoundToInt(static_cast<float>(c) * (iColumnCount - 1) / (iSampleColumnCount - 1));
+	}
+
+	// The heights are offsets from the lowest sampled vertex.
+
+	float fMinZ = MAX_flt;
+	float fMaxZ = -MAX_flt;
+
+	for (int32 r = 0; r < iSampleRowCount; r++)
+	{
+		const FVector* pRow = &vVertices[vSampleRows[r] * iColumnCount];
+
+		for (int32 c = 0; c < iSampleColumnCount; c++)
+		{
+			fMinZ = FMath::Min(fMinZ, pRow[vSampleColumns[c]].Z);
+			fMaxZ = FMath::Max(fMaxZ, pRow[vSampleColumns[c]].Z);
+		}
+	}
+
+	const FVector& vFirst = vVertices[0];
+	const FVector& vLast  = vVertices.Last();
+
+	vOrigin      = FVector(vFirst.X, vFirst.Y, fMinZ);
+	fRowScale    = (vLast.Y - vFirst.Y) / (iSampleRowCount - 1);
+	fColumnScale = (vLast.X - vFirst.X) / (iSampleColumnCount - 1);
+	fHeightScale = FMath::Max((fMaxZ - fMinZ) / FWG_HEIGHTFIELD_MAX_SAMPLE_HEIGHT, FWG_HEIGHTFIELD_MIN_HEIGHT_SCALE);
+
+	bounds = FBox(vOrigin, FVector(vLast.X, vLast.Y, fMaxZ));
+
+	// Material 0 on both triangles of a cell. The tessellation flag is not set: the diagonal goes from
+	// sample (r, c + 1) to (r + 1, c), like in FWGChunkIndexBuffer.
+
+	TArray<physx::PxHeightFieldSample> vSamples;
+	vSamples.SetNumZeroed(iSampleRowCount * iSampleColumnCount);
+
+	for (int32 r = 0; r < iSampleRowCount; r++)
+	{
+		const FVector* pRow = &vVertices[vSampleRows[r] * iColumnCount];
+
+		for (int32 c = 0; c < iSampleColumnCount; c++)
+		{
+			vSamples[r * iSampleColumnCount + c].height =
+				static_cast<physx::PxI16>(FMath::RoundToInt((pRow[vSampleColumns[c]].Z - fMinZ) / fHeightScale));
+		}
+	}
+
+	// X - columns, Y - rows.
+	TArray<uint8> vCookedData;
+
+	if (pCookingModule->GetPhysXCooking()->CookHeightField(FName(FPlatformProperties::GetPhysicsFormat()),
+		FIntPoint(iSampleColumnCount, iSampleRowCount), vSamples.GetData(), vSamples.GetTypeSize(), vCookedData) == false)
+	{
+		return;
+	}
+
+	physx::PxDefaultMemoryInputData cookedStream(vCookedData.GetData(), vCookedData.Num());
+
+	pHeightField = GPhysXSDK->createHeightField(cookedStream);
+#endif // FWG_WITH_HEIGHTFIELD
+}
+
+FWGHeightfield::~FWGHeightfield()
+{
+#if FWG_WITH_HEIGHTFIELD
+	// The shapes that use it keep their own reference.
+	if (pHeightField)
+	{
+		pHeightField->release();
+	}
+#endif // FWG_WITH_HEIGHTFIELD
+}
+
+bool FWGHeightfield::isValid() const
+{
+	return pHeightField != nullptr;
+}
+
+int32 FWGHeightfield::getSize() const
+{
+#if FWG_WITH_HEIGHTFIELD
+	return iSampleRowCount * iSampleColumnCount * sizeof(physx::PxHeightFieldSample);
+#else
+	return 0;
+#endif // FWG_WITH_HEIGHTFIELD
+}
+
+bool FWGHeightfield::isSupported()
+{
+	return FWG_WITH_HEIGHTFIELD != 0;
+}
+
+IPhysXCookingModule* FWGHeightfield::loadCookingModule()
+{
+	check(IsInGameThread());
+
+#if FWG_WITH_HEIGHTFIELD
+	return GetPhysXCookingModule();
+#else
+	return nullptr;
+#endif // FWG_WITH_HEIGHTFIELD
+}
+
+
+UFWGHeightfieldComponent::UFWGHeightfieldComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Like the procedural mesh component of AFWGen.
+	BodyInstance.SetCollisionProfileName(TEXT("BlockAll"));
+}
+
+void UFWGHeightfieldComponent::setHeightfield(const FWGHeightfieldPtr& pNewHeightfield)
+{
+	pHeightfield = pNewHeightfield;
+
+	UpdateBounds();
+
+	// The physics actor is created again with the new heightfield (or just destroyed).
+	RecreatePhysicsState();
+}
+
+const FWGHeightfieldPtr& UFWGHeightfieldComponent::getHeightfield() const
+{
+	return pHeightfield;
+}
+
+bool UFWGHeightfieldComponent::ShouldCreatePhysicsState() const
+{
+	return pHeightfield.IsValid() && pHeightfield->isValid() && Super::ShouldCreatePhysicsState();
+}
+
+void UFWGHeightfieldComponent::OnCreatePhysicsState()
+{
+	// Not UPrimitiveComponent::OnCreatePhysicsState(), there is no body setup to create the body from.
+	UActorComponent::OnCreatePhysicsState();
+
+#if FWG_WITH_HEIGHTFIELD
+	UWorld* pWorld = GetWorld();
+
+	if ((pWorld == nullptr) || (pWorld->GetPhysicsScene() == nullptr) || BodyInstance.IsValidBodyInstance())
+	{
+		return;
+	}
+
+	const FTransform& componentToWorld = GetComponentTransform();
+	const FVector     vScale           = componentToWorld.GetScale3D();
+
+	// The rows of a heightfield go along x of its shape, the heights along y and the columns along z,
+	// the shape is turned so that they go along Y, Z and X of the chunk.
+	static const FQuat heightfieldAxes(FMatrix(FVector(0.0f, 1.0f, 0.0f), FVector(0.0f, 0.0f, 1.0f), FVector(1.0f, 0.0f, 0.0f), FVector::ZeroVector));
+
+	const FTransform pose(componentToWorld.GetRotation() * heightfieldAxes, componentToWorld.TransformPosition(pHeightfield->vOrigin));
+
+	const physx::PxHeightFieldGeometry geometry(pHeightfield->pHeightField, physx::PxMeshGeometryFlags(),
+		pHeightfield->fHeightScale * vScale.Z, pHeightfield->fRowScale * vScale.Y, pHeightfield->fColumnScale * vScale.X);
+
+	physx::PxMaterial* pMaterial = BodyInstance.GetSimplePhysicalMaterial()->GetPhysicsMaterial().Material;
+
+	physx::PxShape* pShape = GPhysXSDK->createShape(geometry, *pMaterial, true);
+
+	FCollisionFilterData queryFilterData;
+	FCollisionFilterData simFilterData;
+
+	CreateShapeFilterData(GetCollisionObjectType(), FMaskFilter(0), GetOwner()->GetUniqueID(), GetCollisionResponseToChannels(),
+		GetUniqueID(), 0, queryFilterData, simFilterData, true, false, true);
+
+	// Traces of both kinds hit it.
+	queryFilterData.Word3 |= (EPDF_SimpleCollision | EPDF_ComplexCollision);
+	simFilterData.Word3   |= (EPDF_SimpleCollision | EPDF_ComplexCollision);
+
+	pShape->setQueryFilterData(U2PFilterData(queryFilterData));
+	pShape->setSimulationFilterData(U2PFilterData(simFilterData));
+	pShape->setFlag(physx::PxShapeFlag::eSCENE_QUERY_SHAPE, true);
+	pShape->setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, true);
+
+	physx::PxRigidStatic* pActor = GPhysXSDK->createRigidStatic(U2PTransform(pose));
+
+	// The actor keeps the shape.
+	pActor->attachShape(*pShape);
+	pShape->release();
+
+	// Hits find this component through the body instance, it also releases the actor (TermBody() in OnDestroyPhysicsState()).
+	BodyInstance.OwnerComponent        = this;
+	BodyInstance.PhysicsUserData       = FPhysicsUserData(&BodyInstance);
+	BodyInstance.ActorHandle.SyncActor = pActor;
+
+	pActor->userData = &BodyInstance.PhysicsUserData;
+
+	physx::PxScene* pScene = pWorld->GetPhysicsScene()->GetPxScene();
+
+	SCOPED_SCENE_WRITE_LOCK(pScene);
+	pScene->addActor(*pActor);
+#endif // FWG_WITH_HEIGHTFIELD
+}
+
+FBoxSphereBounds UFWGHeightfieldComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if ((pHeightfield.IsValid() == false) || (pHeightfield->bounds.IsValid == false))
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+	}
+
+	return FBoxSphereBounds(pHeightfield->bounds).TransformBy(LocalToWorld);
+}
@@ -0,0 +1,96 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// UE
+#include "Components/PrimitiveComponent.h"
+
+#include "FWGHeightfieldComponent.generated.h"
+
+namespace physx
+{
+	class PxHeightField;
+}
+
+class IPhysXCookingModule;
+
+
+// Collision of one chunk as a physics heightfield: a grid of 16 bit heights instead of a triangle mesh,
+// so there are no triangles to cook and it takes 4 bytes per sample.
+// Built from the generated vertices of the chunk, every iStep-th vertex row and column becomes a sample
+// (the first and the last rows and columns always are, so the samples of neighbour chunks meet).
+// Immutable after it is built, so it can be built on any thread and shared with the game thread.
+class FWGHeightfield
+{
+public:
+
+	// vVertices - iRowCount x iColumnCount vertices (row by row, X grows along a row and Y from row to row).
+	// pCookingModule - see loadCookingModule(), the heightfield is not built if it is nullptr.
+	FWGHeightfield(const TArray<FVector>& vVertices, int32 iRowCount, int32 iColumnCount, int32 iStep, IPhysXCookingModule* pCookingModule);
+
+	~FWGHeightfield();
+
+	// False if the heightfield could not be built (the physics engine does not support it, for example).
+	bool   isValid     () const;
+
+	// Memory of the samples (bytes).
+	int32  getSize     () const;
+
+	// False if this build has no heightfields (not PhysX), the chunks then collide with the triangle mesh.
+	static bool isSupported ();
+
+	// Game thread (the module manager only loads the modules there, on the other threads it returns nullptr
+	// for a module that is not loaded yet). nullptr if the cooking module is not available.
+	static IPhysXCookingModule* loadCookingModule ();
+
+
+	physx::PxHeightField* pHeightField;
+
+	int32  iSampleRowCount;
+	int32  iSampleColumnCount;
+
+	// Sample (r, c) is at vOrigin + (c * fColumnScale, r * fRowScale, height * fHeightScale) in the space of the chunk mesh.
+	FVector vOrigin;
+	float  fRowScale;
+	float  fColumnScale;
+	float  fHeightScale;
+
+	FBox   bounds;
+};
+
+typedef TSharedPtr<const FWGHeightfield, ESPMode::ThreadSafe> FWGHeightfieldPtr;
+
+
+// Collision of one chunk section (AFWGen keeps one per section, like the terrain components), not visible.
+// Creates a static physics actor with the heightfield shape instead of a body from a UBodySetup.
+UCLASS()
+class UFWGHeightfieldComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UFWGHeightfieldComponent(const FObjectInitializer& ObjectInitializer);
+
+	// nullptr removes the collision.
+	void  setHeightfield (const FWGHeightfieldPtr& pNewHeightfield);
+
+	const FWGHeightfieldPtr& getHeightfield () const;
+
+
+	// UActorComponent
+	virtual bool ShouldCreatePhysicsState () const override;
+	virtual void OnCreatePhysicsState     () override;
+
+	// USceneComponent
+	virtual FBoxSphereBounds CalcBounds (const FTransform& LocalToWorld) const override;
+
+private:
+
+	FWGHeightfieldPtr  pHeightfield;
+};
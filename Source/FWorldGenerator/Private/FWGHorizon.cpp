@@ -0,0 +1,89 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGHorizon.h"
+
+// STL
+#include <set>
+#include <utility>
+
+
+FWGHorizon::FWGHorizon(int32 iResolution, int32 iInnerDistance, int32 iOuterDistance)
+	: iResolution(iResolution), iInnerDistance(iInnerDistance), iOuterDistance(iOuterDistance),
+	indexBuffer(iResolution, iResolution, true), bPlaced(false)
+{
+	const int32 iOuterSide = iOuterDistance * 2 + 1;
+	const int32 iInnerSide = iInnerDistance * 2 + 1;
+
+	vChunks.resize(static_cast<size_t>(iOuterSide) * iOuterSide - static_cast<size_t>(iInnerSide) * iInnerSide);
+
+	for (size_t i = 0; i < vChunks.size(); i++)
+	{
+		vChunks[i].iX            = 0;
+		vChunks[i].iY            = 0;
+		vChunks[i].iSectionIndex = static_cast<int32>(i);
+		vChunks[i].iLoadRequest  = 0;
+		vChunks[i].bHasSection   = false;
+	}
+}
+
+void FWGHorizon::moveCenter(long long iCentralX, long long iCentralY, std::vector<FWGHorizonChunk*>& vChangedChunks)
+{
+	vChangedChunks.clear();
+
+	// Chunks that stay in the ring, the others are free.
+
+	std::set<std::pair<long long, long long>> kept;
+	std::vector<FWGHorizonChunk*>             vFree;
+
+	for (size_t i = 0; i < vChunks.size(); i++)
+	{
+		if (bPlaced && isInRing(vChunks[i].iX, vChunks[i].iY, iCentralX, iCentralY))
+		{
+			kept.insert(std::make_pair(vChunks[i].iX, vChunks[i].iY));
+		}
+		else
+		{
+			vFree.push_back(&vChunks[i]);
+		}
+	}
+
+	// The ring has the same size everywhere, so there is exactly one free chunk for every new place.
+
+	size_t iNextFree = 0;
+
+	for (long long y = iCentralY - iOuterDistance; y <= iCentralY + iOuterDistance; y++)
+	{
+		for (long long x = iCentralX - iOuterDistance; x <= iCentralX + iOuterDistance; x++)
+		{
+			if ((isInRing(x, y, iCentralX, iCentralY) == false) || (kept.find(std::make_pair(x, y)) != kept.end()))
+			{
+				continue;
+			}
+
+			FWGHorizonChunk* pChunk = vFree[iNextFree];
+			iNextFree++;
+
+			pChunk->iX = x;
+			pChunk->iY = y;
+
+			vChangedChunks.push_back(pChunk);
+		}
+	}
+
+	bPlaced = true;
+}
+
+const FWGChunkIndexBuffer& FWGHorizon::getIndexBuffer() const
+{
+	return indexBuffer;
+}
+
+bool FWGHorizon::isInRing(long long iX, long long iY, long long iCentralX, long long iCentralY) const
+{
+	const long long iDistance = FMath::Max(FMath::Abs(iX - iCentralX), FMath::Abs(iY - iCentralY));
+
+	return (iDistance > iInnerDistance) && (iDistance <= iOuterDistance);
+}
@@ -0,0 +1,73 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <vector>
+
+// Custom
+#include "FWGChunkIndexBuffer.h"
+
+
+// Vertices per side of a horizon chunk.
+#define FWG_HORIZON_MIN_RESOLUTION 2
+#define FWG_HORIZON_MAX_RESOLUTION 64
+
+
+struct FWGHorizonChunk
+{
+	long long  iX;
+	long long  iY;
+
+	// Horizon component of the chunk (see AFWGen::getHorizonComponent()), the same for the whole life of the ring.
+	int32      iSectionIndex;
+
+	// Incremented when the chunk is moved, a job result with another value is thrown away.
+	uint32     iLoadRequest;
+
+	bool       bHasSection;
+};
+
+
+// Ring of very low resolution chunks around the loaded chunks:
+// iInnerDistance < max(|x - central x|, |y - central y|) <= iOuterDistance.
+// The ring has the same chunk count wherever the central chunk is, when it moves the chunks that left
+// the ring take the places that entered it (with their mesh sections), so only those are generated again.
+// The horizon chunks have no collision, no spawned objects, no blends and no border cache,
+// the skirts hanging down from their borders hide the cracks to the full resolution chunks.
+// They are generated by the chunk jobs (see FWGChunkGenerator::generateHorizon()) and committed in one step.
+class FWGHorizon
+{
+public:
+
+	// iResolution x iResolution vertices per chunk.
+	FWGHorizon(int32 iResolution, int32 iInnerDistance, int32 iOuterDistance);
+
+	// Puts the ring around the central chunk, returns the chunks that were not in the ring before.
+	// The first call places every chunk.
+	void   moveCenter      (long long iCentralX, long long iCentralY, std::vector<FWGHorizonChunk*>& vChangedChunks);
+
+	const FWGChunkIndexBuffer& getIndexBuffer () const;
+
+
+	const int32                   iResolution;
+	const int32                   iInnerDistance;
+	const int32                   iOuterDistance;
+
+	// Never resized, the jobs refer to the chunks by their index (see FWGChunkJob::iHorizonChunk).
+	std::vector<FWGHorizonChunk>  vChunks;
+
+private:
+
+	bool   isInRing        (long long iX, long long iY, long long iCentralX, long long iCentralY) const;
+
+
+	const FWGChunkIndexBuffer     indexBuffer;
+
+	bool                          bPlaced;
+};
@@ -0,0 +1,255 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Custom
+#include "FWGNoise.h"
+
+
+// With a smaller spacing upsampling an octave costs about as much as evaluating it.
+#define FWG_MULTI_RESOLUTION_MIN_STRIDE 3
+
+// Noise of one chunk, row by row, like FWGNoiseContext::octaveNoise0_1RowDerivatives(), but the octaves
+// that change slowly compared to the vertex spacing are evaluated only on a coarser grid and upsampled
+// with bicubic Catmull-Rom splines. Each octave gets the largest grid spacing that keeps its
+// interpolation error (see IFWGNoiseSource::getCubicErrorFactor()) within its share of fMaxError,
+// the octaves that cannot use a spacing of at least FWG_MULTI_RESOLUTION_MIN_STRIDE vertices are evaluated
+// for every vertex.
+// The derivatives are upsampled the same way.
+//
+// Coarse grid points are placed at multiples of the spacing in global vertex indices, so that
+// neighbour chunks interpolate their common edge from the same samples.
+template <typename TReal>
+class TFWGMultiResolutionNoise
+{
+public:
+
+	// pX            - noise x of the iColumnCount vertices in a row.
+	// iFirstColumn  - global index of the first column (vertex) of the chunk, same for rows.
+	// fOriginX      - noise x of the global column 0, fStepX - noise x between two columns, same for y.
+	// fMaxError     - max difference from the full evaluation, in the [0, 1] units of the noise.
+	TFWGMultiResolutionNoise(const FWGNoiseContext& noise, const TReal* pX, int32 iColumnCount, int32 iRowCount,
+		long long iFirstColumn, long long iFirstRow, double fOriginX, double fOriginY, double fStepX, double fStepY, double fMaxError)
+		: noise(noise), pX(pX), iColumnCount(iColumnCount), iFirstFullOctave(0)
+	{
+		if (fMaxError <= 0.0)
+		{
+			return;
+		}
+
+		const double fErrorShare = fMaxError / noise.iOctaves;
+		const double fErrorFactor = noise.pNoiseSource->getCubicErrorFactor();
+
+		const int32 iMaxStride = FMath::Max(iColumnCount, iRowCount);
+
+		for (; iFirstFullOctave < noise.iOctaves; iFirstFullOctave++)
+		{
+			const double fFrequency = static_cast<double>(1 << iFirstFullOctave);
+
+			// Octave o adds noise * 0.5^o to the sum and the sum is mapped to [0, 1] by * 0.5.
+			const double fAmplitude = 0.5 / fFrequency;
+
+			// Vertex spacing in the units of this octave.
+			const double fSpacing = FMath::Max(fStepX, fStepY) * fFrequency;
+
+			// C * fAmplitude * (iStride * fSpacing)^3 <= fErrorShare, the bound only holds for a spacing up to 1.
+			const double fMaxSpacing = FMath::Min(std::cbrt(fErrorShare / (fErrorFactor * fAmplitude)), 1.0);
+
+			const int32 iStride = static_cast<int32>(FMath::Min(fMaxSpacing / fSpacing, static_cast<double>(iMaxStride)));
+
+			if (iStride < FWG_MULTI_RESOLUTION_MIN_STRIDE)
+			{
+				break;
+			}
+
+			vCoarseOctaves.push_back(FCoarseOctave());
+
+			FCoarseOctave& octave = vCoarseOctaves.back();
+
+			octave.columns = makeAxis(iFirstColumn, iColumnCount, iStride);
+			octave.rows    = makeAxis(iFirstRow,    iRowCount,    iStride);
+
+			sampleOctave(octave, iFirstFullOctave, iStride, fOriginX, fOriginY, fStepX, fStepY);
+		}
+	}
+
+	// True if at least one octave is sampled on a coarse grid, otherwise there is nothing to gain.
+	bool isMultiResolution() const
+	{
+		return vCoarseOctaves.empty() == false;
+	}
+
+	// Row iRow with the noise y, the same outputs as FWGNoiseContext::octaveNoise0_1RowDerivatives().
+	void sampleRow(int32 iRow, TReal y, TReal* pOut, TReal* pOutDx, TReal* pOutDy) const
+	{
+		if (iFirstFullOctave < noise.iOctaves)
+		{
+			noise.octaveNoiseRowDerivatives(pX, y, iColumnCount, iFirstFullOctave, noise.iOctaves - iFirstFullOctave, pOut, pOutDx, pOutDy);
+		}
+		else
+		{
+			std::fill(pOut,   pOut   + iColumnCount, TReal(0));
+			std::fill(pOutDx, pOutDx + iColumnCount, TReal(0));
+			std::fill(pOutDy, pOutDy + iColumnCount, TReal(0));
+		}
+
+		for (const FCoarseOctave& octave : vCoarseOctaves)
+		{
+			const int32  iTap     = octave.rows.vTaps[iRow];
+			const TReal* pWeights = &octave.rows.vWeights[iRow * 4];
+
+			addWeightedRows(octave.vValue.data(), iTap, pWeights, pOut);
+			addWeightedRows(octave.vDx   .data(), iTap, pWeights, pOutDx);
+			addWeightedRows(octave.vDy   .data(), iTap, pWeights, pOutDy);
+		}
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			pOut[j] = pOut[j] * TReal(0.5) + TReal(0.5);
+			pOutDx[j] *= TReal(0.5);
+			pOutDy[j] *= TReal(0.5);
+		}
+	}
+
+private:
+
+	// Catmull-Rom taps of every vertex along one axis.
+	struct FAxis
+	{
+		long long           iFirstCoarse;  // Global coarse index of the coarse point 0.
+		int32               iCoarseCount;
+
+		std::vector<int32>  vTaps;         // First of the 4 coarse points used by the vertex.
+		std::vector<TReal>  vWeights;      // 4 per vertex.
+	};
+
+	struct FCoarseOctave
+	{
+		FAxis               columns;
+		FAxis               rows;
+
+		// Coarse rows already upsampled along x: rows.iCoarseCount rows of iColumnCount values.
+		std::vector<TReal>  vValue;
+		std::vector<TReal>  vDx;
+		std::vector<TReal>  vDy;
+	};
+
+
+	static long long floorDivide(long long iValue, long long iDivisor)
+	{
+		return (iValue >= 0) ? (iValue / iDivisor) : -((-iValue + iDivisor - 1) / iDivisor);
+	}
+
+	static FAxis makeAxis(long long iFirst, int32 iCount, int32 iStride)
+	{
+		FAxis axis;
+
+		// One more coarse point on each side for the outer taps.
+		axis.iFirstCoarse = floorDivide(iFirst, iStride) - 1;
+		axis.iCoarseCount = static_cast<int32>(floorDivide(iFirst + iCount - 1, iStride) + 2 - axis.iFirstCoarse + 1);
+
+		axis.vTaps.resize(iCount);
+		axis.vWeights.resize(iCount * 4);
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			const long long iCell = floorDivide(iFirst + i, iStride);
+
+			const TReal t = static_cast<TReal>(static_cast<double>(iFirst + i - iCell * iStride) / iStride);
+
+			axis.vTaps[i] = static_cast<int32>(iCell - 1 - axis.iFirstCoarse);
+
+			axis.vWeights[i * 4 + 0] = TReal(0.5) * (t * (t * (2 - t) - 1));
+			axis.vWeights[i * 4 + 1] = TReal(0.5) * (t * t * (3 * t - 5) + 2);
+			axis.vWeights[i * 4 + 2] = TReal(0.5) * (t * (t * (4 - 3 * t) + 1));
+			axis.vWeights[i * 4 + 3] = TReal(0.5) * (t * t * (t - 1));
+		}
+
+		return axis;
+	}
+
+	void sampleOctave(FCoarseOctave& octave, int32 iOctave, int32 iStride, double fOriginX, double fOriginY, double fStepX, double fStepY) const
+	{
+		const int32 iCoarseColumnCount = octave.columns.iCoarseCount;
+		const int32 iCoarseRowCount    = octave.rows.iCoarseCount;
+
+		std::vector<TReal> vCoarseX(iCoarseColumnCount);
+
+		for (int32 k = 0; k < iCoarseColumnCount; k++)
+		{
+			vCoarseX[k] = static_cast<TReal>(fOriginX + static_cast<double>((octave.columns.iFirstCoarse + k) * iStride) * fStepX);
+		}
+
+		std::vector<TReal> vCoarseValue(iCoarseColumnCount);
+		std::vector<TReal> vCoarseDx(iCoarseColumnCount);
+		std::vector<TReal> vCoarseDy(iCoarseColumnCount);
+
+		octave.vValue.resize(static_cast<size_t>(iCoarseRowCount) * iColumnCount);
+		octave.vDx   .resize(static_cast<size_t>(iCoarseRowCount) * iColumnCount);
+		octave.vDy   .resize(static_cast<size_t>(iCoarseRowCount) * iColumnCount);
+
+		for (int32 k = 0; k < iCoarseRowCount; k++)
+		{
+			const TReal y = static_cast<TReal>(fOriginY + static_cast<double>((octave.rows.iFirstCoarse + k) * iStride) * fStepY);
+
+			noise.octaveNoiseRowDerivatives(vCoarseX.data(), y, iCoarseColumnCount, iOctave, 1,
+				vCoarseValue.data(), vCoarseDx.data(), vCoarseDy.data());
+
+			// Upsample along x.
+			const size_t iRowStart = static_cast<size_t>(k) * iColumnCount;
+
+			upsampleRow(octave.columns, vCoarseValue.data(), &octave.vValue[iRowStart]);
+			upsampleRow(octave.columns, vCoarseDx   .data(), &octave.vDx   [iRowStart]);
+			upsampleRow(octave.columns, vCoarseDy   .data(), &octave.vDy   [iRowStart]);
+		}
+	}
+
+	void upsampleRow(const FAxis& columns, const TReal* pCoarse, TReal* pOut) const
+	{
+		const int32* pTaps    = columns.vTaps.data();
+		const TReal* pWeights = columns.vWeights.data();
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			const TReal* pPoints = pCoarse + pTaps[j];
+			const TReal* pW      = pWeights + j * 4;
+
+			pOut[j] = pPoints[0] * pW[0] + pPoints[1] * pW[1] + pPoints[2] * pW[2] + pPoints[3] * pW[3];
+		}
+	}
+
+	// pOut[j] += sum of pWeights[q] * row (iTap + q) [j].
+	void addWeightedRows(const TReal* pRows, int32 iTap, const TReal* pWeights, TReal* pOut) const
+	{
+		const TReal* pRow0 = pRows + static_cast<size_t>(iTap) * iColumnCount;
+		const TReal* pRow1 = pRow0 + iColumnCount;
+		const TReal* pRow2 = pRow1 + iColumnCount;
+		const TReal* pRow3 = pRow2 + iColumnCount;
+
+		for (int32 j = 0; j < iColumnCount; j++)
+		{
+			pOut[j] += pRow0[j] * pWeights[0] + pRow1[j] * pWeights[1] + pRow2[j] * pWeights[2] + pRow3[j] * pWeights[3];
+		}
+	}
+
+
+	const FWGNoiseContext&      noise;
+
+	const TReal*                pX;
+	const int32                 iColumnCount;
+
+	// Octaves from this one are evaluated for every vertex.
+	int32                       iFirstFullOctave;
+
+	std::vector<FCoarseOctave>  vCoarseOctaves;
+};
@@ -0,0 +1,32 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGNoise.h"
+
+// Custom
+#include "FWGOpenSimplex2.h"
+#include "FWGValueNoise.h"
+
+FWGNoiseContext::FWGNoiseContext(uint32 iSeed, int32 iOctaves, EFWGNoiseType noiseType)
+	: pNoiseSource(createNoiseSource(noiseType, iSeed, iOctaves)),
+	iSeed(iSeed), iOctaves(FMath::Clamp(iOctaves, 1, FWG_MAX_OCTAVES)), noiseType(noiseType),
+	simdLevel(siv::DetectSimdLevel())
+{
+}
+
+std::unique_ptr<IFWGNoiseSource> FWGNoiseContext::createNoiseSource(EFWGNoiseType noiseType, uint32 iSeed, int32 iOctaves)
+{
+	// getCubicErrorFactor(): measured about 2.6 for Perlin and value noise and 19 for OpenSimplex2.
+
+	switch (noiseType)
+	{
+	case EFWGNoiseType::OpenSimplex2:
+		return std::unique_ptr<IFWGNoiseSource>(new TFWGNoiseSource<FWGOpenSimplex2>(iSeed, iOctaves, siv::SimdLevel::Scalar, 32.0));
+	case EFWGNoiseType::Value:
+		return std::unique_ptr<IFWGNoiseSource>(new TFWGNoiseSource<FWGValueNoise>(iSeed, iOctaves, siv::SimdLevel::Scalar, 4.0));
+	default:
+		return std::unique_ptr<IFWGNoiseSource>(new TFWGNoiseSource<siv::PerlinNoise>(iSeed, iOctaves, siv::SimdLevel::AVX2, 4.0));
+	}
+}
@@ -0,0 +1,316 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FWGNoiseType.h"
+
+// STL
+#include <memory>
+#include <utility>
+
+// External
+#include "PerlinNoise.hpp"
+
+
+#define FWG_MAX_OCTAVES 16
+
+
+// Noise the terrain height is generated from, created for one seed and octave count.
+class IFWGNoiseSource
+{
+public:
+
+	virtual ~IFWGNoiseSource() = default;
+
+	// Octave noise mapped to [0, 1] (like siv::PerlinNoise::octaveNoise0_1()) of (pX[i], y) for a whole row.
+	virtual void   octaveNoise0_1Row (const double* pX, double y, int32 iCount, double* pOut, siv::SimdLevel level) const = 0;
+	virtual void   octaveNoise0_1Row (const float*  pX, float  y, int32 iCount, float*  pOut, siv::SimdLevel level) const = 0;
+
+	// octaveNoise0_1Row() that also writes the partial derivatives of the result by x (pOutDx) and by y (pOutDy).
+	virtual void   octaveNoise0_1RowDerivatives (const double* pX, double y, int32 iCount, double* pOut, double* pOutDx, double* pOutDy,
+		siv::SimdLevel level) const = 0;
+	virtual void   octaveNoise0_1RowDerivatives (const float*  pX, float  y, int32 iCount, float*  pOut, float*  pOutDx, float*  pOutDy,
+		siv::SimdLevel level) const = 0;
+
+	// Sum of the octaves [iFirstOctave, iFirstOctave + iOctaveCount) with the derivatives, before the mapping to [0, 1]
+	// (octaveNoise0_1 = sum * 0.5 + 0.5). Lets the octaves be sampled separately.
+	virtual void   octaveNoiseRowDerivatives (const double* pX, double y, int32 iCount, int32 iFirstOctave, int32 iOctaveCount,
+		double* pOut, double* pOutDx, double* pOutDy, siv::SimdLevel level) const = 0;
+	virtual void   octaveNoiseRowDerivatives (const float*  pX, float  y, int32 iCount, int32 iFirstOctave, int32 iOctaveCount,
+		float*  pOut, float*  pOutDx, float*  pOutDy, siv::SimdLevel level) const = 0;
+
+	// octaveNoise0_1RowDerivatives() for samples (pX[i], pY[i]) that do not lie on one row (warped coordinates).
+	virtual void   octaveNoise0_1PointsDerivatives (const double* pX, const double* pY, int32 iCount, double* pOut, double* pOutDx, double* pOutDy,
+		siv::SimdLevel level) const = 0;
+	virtual void   octaveNoise0_1PointsDerivatives (const float*  pX, const float*  pY, int32 iCount, float*  pOut, float*  pOutDx, float*  pOutDy,
+		siv::SimdLevel level) const = 0;
+
+	// One sample, the reference for the row version.
+	virtual double octaveNoise0_1    (double x, double y) const = 0;
+
+	// Best instruction set the row version can use.
+	virtual siv::SimdLevel getMaxSimdLevel () const = 0;
+
+	// Bound C of the error of a single octave (amplitude 1) interpolated by bicubic Catmull-Rom splines from
+	// samples spaced h apart (in the units of the octave, h <= 1): error <= C * h^3. Measured, with a margin.
+	virtual double getCubicErrorFactor     () const = 0;
+};
+
+// IFWGNoiseSource for a noise class with the row API of siv::PerlinNoise:
+// octaveNoise0_1Row<Octaves>(pX, y, iCount, pFrequency, pAmplitude, pOut, level),
+// octaveNoise0_1RowDerivatives<Octaves>(..., pOut, pOutDx, pOutDy, level),
+// octaveNoiseRowDerivatives<Octaves>(pX, y, iCount, iFirstOctave, pFrequency, pAmplitude, pOut, pOutDx, pOutDy, level),
+// octaveNoise0_1PointsDerivatives<Octaves>(pX, pY, iCount, pFrequency, pAmplitude, pOut, pOutDx, pOutDy, level)
+// and octaveNoise0_1(x, y, iOctaves).
+// The instantiation for the octave count is picked once here.
+template <class TNoise>
+class alignas(PLATFORM_CACHE_LINE_SIZE) TFWGNoiseSource : public IFWGNoiseSource
+{
+public:
+
+	TFWGNoiseSource(uint32 iSeed, int32 iOctaves, siv::SimdLevel maxSimdLevel, double fCubicErrorFactor)
+		: noise(iSeed), iOctaves(FMath::Clamp(iOctaves, 1, FWG_MAX_OCTAVES)), maxSimdLevel(maxSimdLevel),
+		fCubicErrorFactor(fCubicErrorFactor)
+	{
+		// Same values as the x *= 2, amp *= 0.5 steps of siv::PerlinNoise::octaveNoise().
+		// Powers of two, exact in float as well.
+
+		double fFrequency = 1.0;
+		double fAmplitude = 1.0;
+
+		for (int32 i = 0; i < FWG_MAX_OCTAVES; i++)
+		{
+			vFrequency[i] = fFrequency;
+			vAmplitude[i] = fAmplitude;
+
+			vFrequencyFloat[i] = static_cast<float>(fFrequency);
+			vAmplitudeFloat[i] = static_cast<float>(fAmplitude);
+
+			fFrequency *= 2.0;
+			fAmplitude *= 0.5;
+		}
+
+		pRow      = getRowFunction<double>(this->iOctaves, FOctaves());
+		pRowFloat = getRowFunction<float> (this->iOctaves, FOctaves());
+
+		pRowDerivatives      = getRowDerivativesFunction<double>(this->iOctaves, FOctaves());
+		pRowDerivativesFloat = getRowDerivativesFunction<float> (this->iOctaves, FOctaves());
+
+		pPointsDerivatives      = getPointsDerivativesFunction<double>(this->iOctaves, FOctaves());
+		pPointsDerivativesFloat = getPointsDerivativesFunction<float> (this->iOctaves, FOctaves());
+	}
+
+	// Default operator new only guarantees 16 bytes of alignment.
+	void* operator new(size_t iSize)
+	{
+		return FMemory::Malloc(iSize, alignof(TFWGNoiseSource));
+	}
+
+	void operator delete(void* pMemory)
+	{
+		FMemory::Free(pMemory);
+	}
+
+	virtual void octaveNoise0_1Row(const double* pX, double y, int32 iCount, double* pOut, siv::SimdLevel level) const override
+	{
+		(noise.*pRow)(pX, y, iCount, vFrequency, vAmplitude, pOut, level);
+	}
+
+	virtual void octaveNoise0_1Row(const float* pX, float y, int32 iCount, float* pOut, siv::SimdLevel level) const override
+	{
+		(noise.*pRowFloat)(pX, y, iCount, vFrequencyFloat, vAmplitudeFloat, pOut, level);
+	}
+
+	virtual void octaveNoise0_1RowDerivatives(const double* pX, double y, int32 iCount, double* pOut, double* pOutDx, double* pOutDy,
+		siv::SimdLevel level) const override
+	{
+		(noise.*pRowDerivatives)(pX, y, iCount, vFrequency, vAmplitude, pOut, pOutDx, pOutDy, level);
+	}
+
+	virtual void octaveNoise0_1RowDerivatives(const float* pX, float y, int32 iCount, float* pOut, float* pOutDx, float* pOutDy,
+		siv::SimdLevel level) const override
+	{
+		(noise.*pRowDerivativesFloat)(pX, y, iCount, vFrequencyFloat, vAmplitudeFloat, pOut, pOutDx, pOutDy, level);
+	}
+
+	virtual void octaveNoiseRowDerivatives(const double* pX, double y, int32 iCount, int32 iFirstOctave, int32 iOctaveCount,
+		double* pOut, double* pOutDx, double* pOutDy, siv::SimdLevel level) const override
+	{
+		(noise.*getOctaveRowFunction<double>(iOctaveCount, FOctaves()))
+			(pX, y, iCount, iFirstOctave, vFrequency, vAmplitude, pOut, pOutDx, pOutDy, level);
+	}
+
+	virtual void octaveNoiseRowDerivatives(const float* pX, float y, int32 iCount, int32 iFirstOctave, int32 iOctaveCount,
+		float* pOut, float* pOutDx, float* pOutDy, siv::SimdLevel level) const override
+	{
+		(noise.*getOctaveRowFunction<float>(iOctaveCount, FOctaves()))
+			(pX, y, iCount, iFirstOctave, vFrequencyFloat, vAmplitudeFloat, pOut, pOutDx, pOutDy, level);
+	}
+
+	virtual void octaveNoise0_1PointsDerivatives(const double* pX, const double* pY, int32 iCount, double* pOut, double* pOutDx, double* pOutDy,
+		siv::SimdLevel level) const override
+	{
+		(noise.*pPointsDerivatives)(pX, pY, iCount, vFrequency, vAmplitude, pOut, pOutDx, pOutDy, level);
+	}
+
+	virtual void octaveNoise0_1PointsDerivatives(const float* pX, const float* pY, int32 iCount, float* pOut, float* pOutDx, float* pOutDy,
+		siv::SimdLevel level) const override
+	{
+		(noise.*pPointsDerivativesFloat)(pX, pY, iCount, vFrequencyFloat, vAmplitudeFloat, pOut, pOutDx, pOutDy, level);
+	}
+
+	virtual double octaveNoise0_1(double x, double y) const override
+	{
+		return noise.octaveNoise0_1(x, y, iOctaves);
+	}
+
+	virtual siv::SimdLevel getMaxSimdLevel() const override
+	{
+		return maxSimdLevel;
+	}
+
+	virtual double getCubicErrorFactor() const override
+	{
+		return fCubicErrorFactor;
+	}
+
+private:
+
+	using FOctaves = std::make_integer_sequence<int32, FWG_MAX_OCTAVES>;
+
+	template <typename TReal>
+	using FRowFunction = void (TNoise::*)(const TReal*, TReal, int32, const TReal*, const TReal*, TReal*, siv::SimdLevel) const;
+
+	template <typename TReal, int32... iOctaveIndex>
+	static FRowFunction<TReal> getRowFunction(int32 iOctaves, std::integer_sequence<int32, iOctaveIndex...>)
+	{
+		static const FRowFunction<TReal> vRowFunctions[] =
+		{
+			&TNoise::template octaveNoise0_1Row<iOctaveIndex + 1, TReal>...
+		};
+
+		return vRowFunctions[iOctaves - 1];
+	}
+
+	template <typename TReal>
+	using FRowDerivativesFunction = void (TNoise::*)(const TReal*, TReal, int32, const TReal*, const TReal*, TReal*, TReal*, TReal*,
+		siv::SimdLevel) const;
+
+	template <typename TReal, int32... iOctaveIndex>
+	static FRowDerivativesFunction<TReal> getRowDerivativesFunction(int32 iOctaves, std::integer_sequence<int32, iOctaveIndex...>)
+	{
+		static const FRowDerivativesFunction<TReal> vRowFunctions[] =
+		{
+			&TNoise::template octaveNoise0_1RowDerivatives<iOctaveIndex + 1, TReal>...
+		};
+
+		return vRowFunctions[iOctaves - 1];
+	}
+
+	template <typename TReal>
+	using FOctaveRowFunction = void (TNoise::*)(const TReal*, TReal, int32, int32, const TReal*, const TReal*, TReal*, TReal*, TReal*,
+		siv::SimdLevel) const;
+
+	template <typename TReal, int32... iOctaveIndex>
+	static FOctaveRowFunction<TReal> getOctaveRowFunction(int32 iOctaveCount, std::integer_sequence<int32, iOctaveIndex...>)
+	{
+		static const FOctaveRowFunction<TReal> vRowFunctions[] =
+		{
+			&TNoise::template octaveNoiseRowDerivatives<iOctaveIndex + 1, TReal>...
+		};
+
+		return vRowFunctions[iOctaveCount - 1];
+	}
+
+	template <typename TReal>
+	using FPointsDerivativesFunction = void (TNoise::*)(const TReal*, const TReal*, int32, const TReal*, const TReal*, TReal*, TReal*, TReal*,
+		siv::SimdLevel) const;
+
+	template <typename TReal, int32... iOctaveIndex>
+	static FPointsDerivativesFunction<TReal> getPointsDerivativesFunction(int32 iOctaves, std::integer_sequence<int32, iOctaveIndex...>)
+	{
+		static const FPointsDerivativesFunction<TReal> vPointsFunctions[] =
+		{
+			&TNoise::template octaveNoise0_1PointsDerivatives<iOctaveIndex + 1, TReal>...
+		};
+
+		return vPointsFunctions[iOctaves - 1];
+	}
+
+
+	const TNoise          noise;
+
+	const int32           iOctaves;
+	const siv::SimdLevel  maxSimdLevel;
+	const double          fCubicErrorFactor;
+
+	FRowFunction<double>  pRow;
+	FRowFunction<float>   pRowFloat;
+
+	FRowDerivativesFunction<double> pRowDerivatives;
+	FRowDerivativesFunction<float>  pRowDerivativesFloat;
+
+	FPointsDerivativesFunction<double> pPointsDerivatives;
+	FPointsDerivativesFunction<float>  pPointsDerivativesFloat;
+
+	double                vFrequency[FWG_MAX_OCTAVES];
+	double                vAmplitude[FWG_MAX_OCTAVES];
+
+	float                 vFrequencyFloat[FWG_MAX_OCTAVES];
+	float                 vAmplitudeFloat[FWG_MAX_OCTAVES];
+};
+
+
+// Everything the terrain noise needs for one seed: the selected noise source with its tables
+// and per-octave frequency and amplitude. Built once per seed in AFWGen::generateSeed()
+// and then only read (from any thread) by the chunk generation.
+class FWGNoiseContext
+{
+public:
+
+	FWGNoiseContext(uint32 iSeed, int32 iOctaves, EFWGNoiseType noiseType);
+
+	static std::unique_ptr<IFWGNoiseSource> createNoiseSource(EFWGNoiseType noiseType, uint32 iSeed, int32 iOctaves);
+
+	// Octave noise of the selected type for a whole row, TReal is double or float.
+	template <typename TReal>
+	void octaveNoise0_1Row(const TReal* pX, TReal y, int32 iCount, TReal* pOut) const
+	{
+		pNoiseSource->octaveNoise0_1Row(pX, y, iCount, pOut, simdLevel);
+	}
+
+	// Same values as octaveNoise0_1Row() plus the partial derivatives by x and by y.
+	template <typename TReal>
+	void octaveNoise0_1RowDerivatives(const TReal* pX, TReal y, int32 iCount, TReal* pOut, TReal* pOutDx, TReal* pOutDy) const
+	{
+		pNoiseSource->octaveNoise0_1RowDerivatives(pX, y, iCount, pOut, pOutDx, pOutDy, simdLevel);
+	}
+
+	// Same as octaveNoise0_1RowDerivatives() for samples (pX[i], pY[i]) anywhere.
+	template <typename TReal>
+	void octaveNoise0_1PointsDerivatives(const TReal* pX, const TReal* pY, int32 iCount, TReal* pOut, TReal* pOutDx, TReal* pOutDy) const
+	{
+		pNoiseSource->octaveNoise0_1PointsDerivatives(pX, pY, iCount, pOut, pOutDx, pOutDy, simdLevel);
+	}
+
+	// Octaves [iFirstOctave, iFirstOctave + iOctaveCount) before the mapping to [0, 1], see IFWGNoiseSource.
+	template <typename TReal>
+	void octaveNoiseRowDerivatives(const TReal* pX, TReal y, int32 iCount, int32 iFirstOctave, int32 iOctaveCount,
+		TReal* pOut, TReal* pOutDx, TReal* pOutDy) const
+	{
+		pNoiseSource->octaveNoiseRowDerivatives(pX, y, iCount, iFirstOctave, iOctaveCount, pOut, pOutDx, pOutDy, simdLevel);
+	}
+
+
+	const std::unique_ptr<const IFWGNoiseSource> pNoiseSource;
+
+	const uint32           iSeed;
+	const int32            iOctaves;
+	const EFWGNoiseType    noiseType;
+
+	const siv::SimdLevel   simdLevel;
+};
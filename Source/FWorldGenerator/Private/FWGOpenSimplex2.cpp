@@ -0,0 +1,50 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGOpenSimplex2.h"
+
+FWGOpenSimplex2::FWGOpenSimplex2(uint32 iSeed) : iSeed(iSeed)
+{
+	// 24 unit directions: every 45 degrees starting from 22.5, and 7.5 degrees to each side of every 45 degrees.
+	static const double vDirections[] =
+	{
+		 0.38268343236509,   0.923879532511287,
+		 0.923879532511287,  0.38268343236509,
+		 0.923879532511287, -0.38268343236509,
+		 0.38268343236509,  -0.923879532511287,
+		-0.38268343236509,  -0.923879532511287,
+		-0.923879532511287, -0.38268343236509,
+		-0.923879532511287,  0.38268343236509,
+		-0.38268343236509,   0.923879532511287,
+
+		 0.130526192220052,  0.99144486137381,
+		 0.608761429008721,  0.793353340291235,
+		 0.793353340291235,  0.608761429008721,
+		 0.99144486137381,   0.130526192220051,
+		 0.99144486137381,  -0.130526192220051,
+		 0.793353340291235, -0.60876142900872,
+		 0.608761429008721, -0.793353340291235,
+		 0.130526192220052, -0.99144486137381,
+		-0.130526192220052, -0.99144486137381,
+		-0.608761429008721, -0.793353340291235,
+		-0.793353340291235, -0.608761429008721,
+		-0.99144486137381,  -0.130526192220052,
+		-0.99144486137381,   0.130526192220051,
+		-0.793353340291235,  0.608761429008721,
+		-0.608761429008721,  0.793353340291235,
+		-0.130526192220052,  0.99144486137381
+	};
+
+	// Scales the output to about [-1, 1].
+	const double fNormalizer = 0.01001634121365712;
+
+	const int32 iDirectionCount = sizeof(vDirections) / sizeof(vDirections[0]);
+
+	for (int32 i = 0; i < GRADIENT_COUNT * 2; i++)
+	{
+		vGradients[i]      = vDirections[i % iDirectionCount] / fNormalizer;
+		vGradientsFloat[i] = static_cast<float>(vGradients[i]);
+	}
+}
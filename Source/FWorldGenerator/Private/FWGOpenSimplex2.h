@@ -0,0 +1,274 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// External
+#include "PerlinNoise.hpp"
+
+
+// 2D OpenSimplex2 noise (the "fast" variant by K.jpg, github.com/KdotJPG/OpenSimplex2, public domain).
+// Sums three simplex corners instead of interpolating four square corners and needs no
+// permutation table. Has no axis aligned artifacts, but the hashes cannot be shared between
+// the samples of a row, so with many octaves it is not faster than Perlin noise.
+class FWGOpenSimplex2
+{
+public:
+
+	explicit FWGOpenSimplex2(uint32 iSeed);
+
+	// About [-1, 1].
+	template <typename TReal>
+	TReal noise(TReal x, TReal y, int32 iOctave = 0) const
+	{
+		// Skew to the square lattice.
+		const TReal s = TReal(SKEW_2D) * (x + y);
+
+		TReal fDx, fDy;
+		return noiseUnskewedBase<false>(x + s, y + s, static_cast<uint64>(iSeed) + static_cast<uint64>(iOctave), fDx, fDy);
+	}
+
+	// noise() that also writes the partial derivatives by x and by y.
+	template <typename TReal>
+	TReal noiseDerivatives(TReal x, TReal y, int32 iOctave, TReal& fDx, TReal& fDy) const
+	{
+		const TReal s = TReal(SKEW_2D) * (x + y);
+
+		return noiseUnskewedBase<true>(x + s, y + s, static_cast<uint64>(iSeed) + static_cast<uint64>(iOctave), fDx, fDy);
+	}
+
+	// Same octave sum as siv::PerlinNoise::octaveNoise0_1(), every octave uses its own seed.
+	double octaveNoise0_1(double x, double y, int32 iOctaves) const
+	{
+		double fResult = 0.0;
+		double fAmplitude = 1.0;
+
+		for (int32 i = 0; i < iOctaves; i++)
+		{
+			fResult += noise(x, y, i) * fAmplitude;
+			x *= 2.0;
+			y *= 2.0;
+			fAmplitude *= 0.5;
+		}
+
+		return fResult * 0.5 + 0.5;
+	}
+
+	// Row version of octaveNoise0_1() with the same signature as siv::PerlinNoise::octaveNoise0_1Row<Octaves>().
+	// There is no SIMD path (the hash needs 64 bit multiplications), the level is ignored.
+	template <int32 Octaves, typename TReal>
+	void octaveNoise0_1Row(const TReal* pX, TReal y, int32 iCount, const TReal* pFrequency, const TReal* pAmplitude,
+		TReal* pOut, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		for (int32 o = 0; o < Octaves; o++)
+		{
+			const TReal fY = y * pFrequency[o];
+
+			for (int32 i = 0; i < iCount; i++)
+			{
+				pOut[i] = ((o > 0) ? pOut[i] : TReal(0)) + noise(pX[i] * pFrequency[o], fY, o) * pAmplitude[o];
+			}
+		}
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			pOut[i] = pOut[i] * TReal(0.5) + TReal(0.5);
+		}
+	}
+
+	// octaveNoise0_1Row() that also writes the partial derivatives of the result by x and by y,
+	// same signature as siv::PerlinNoise::octaveNoise0_1RowDerivatives<Octaves>().
+	template <int32 Octaves, typename TReal>
+	void octaveNoise0_1RowDerivatives(const TReal* pX, TReal y, int32 iCount, const TReal* pFrequency, const TReal* pAmplitude,
+		TReal* pOut, TReal* pOutDx, TReal* pOutDy, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		octaveNoiseRowDerivatives<Octaves>(pX, y, iCount, 0, pFrequency, pAmplitude, pOut, pOutDx, pOutDy);
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			pOut[i] = pOut[i] * TReal(0.5) + TReal(0.5);
+			pOutDx[i] *= TReal(0.5);
+			pOutDy[i] *= TReal(0.5);
+		}
+	}
+
+	// Sum of the octaves [iFirstOctave, iFirstOctave + Octaves) with their derivatives, before the mapping to [0, 1],
+	// same signature as siv::PerlinNoise::octaveNoiseRowDerivatives<Octaves>().
+	template <int32 Octaves, typename TReal>
+	void octaveNoiseRowDerivatives(const TReal* pX, TReal y, int32 iCount, int32 iFirstOctave, const TReal* pFrequency,
+		const TReal* pAmplitude, TReal* pOut, TReal* pOutDx, TReal* pOutDy, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		for (int32 o = iFirstOctave; o < iFirstOctave + Octaves; o++)
+		{
+			const TReal fY = y * pFrequency[o];
+
+			// d/dx noise(x * frequency) = frequency * noise'.
+			const TReal fSlope = pAmplitude[o] * pFrequency[o];
+
+			for (int32 i = 0; i < iCount; i++)
+			{
+				TReal fDx, fDy;
+				const TReal fValue = noiseDerivatives(pX[i] * pFrequency[o], fY, o, fDx, fDy);
+
+				pOut[i]   = ((o > iFirstOctave) ? pOut[i]   : TReal(0)) + fValue * pAmplitude[o];
+				pOutDx[i] = ((o > iFirstOctave) ? pOutDx[i] : TReal(0)) + fDx * fSlope;
+				pOutDy[i] = ((o > iFirstOctave) ? pOutDy[i] : TReal(0)) + fDy * fSlope;
+			}
+		}
+	}
+
+	// octaveNoise0_1RowDerivatives() for samples (pX[i], pY[i]) that do not lie on one row,
+	// same signature as siv::PerlinNoise::octaveNoise0_1PointsDerivatives<Octaves>().
+	template <int32 Octaves, typename TReal>
+	void octaveNoise0_1PointsDerivatives(const TReal* pX, const TReal* pY, int32 iCount, const TReal* pFrequency, const TReal* pAmplitude,
+		TReal* pOut, TReal* pOutDx, TReal* pOutDy, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		for (int32 i = 0; i < iCount; i++)
+		{
+			TReal fResult = 0, fResultDx = 0, fResultDy = 0;
+
+			for (int32 o = 0; o < Octaves; o++)
+			{
+				TReal fDx, fDy;
+				const TReal fValue = noiseDerivatives(pX[i] * pFrequency[o], pY[i] * pFrequency[o], o, fDx, fDy);
+
+				const TReal fSlope = pAmplitude[o] * pFrequency[o];
+
+				fResult   += fValue * pAmplitude[o];
+				fResultDx += fDx * fSlope;
+				fResultDy += fDy * fSlope;
+			}
+
+			pOut[i]   = fResult * TReal(0.5) + TReal(0.5);
+			pOutDx[i] = fResultDx * TReal(0.5);
+			pOutDy[i] = fResultDy * TReal(0.5);
+		}
+	}
+
+private:
+
+	// The offsets to the vertices are the same in the skewed and the original space,
+	// so the derivatives of the (a^2 - |d|^2)^4 * dot(g, d) terms are taken directly.
+	template <bool bDerivatives, typename TReal>
+	TReal noiseUnskewedBase(TReal xs, TReal ys, uint64 iOctaveSeed, TReal& fDx, TReal& fDy) const
+	{
+		const TReal xsFloor = std::floor(xs);
+		const TReal ysFloor = std::floor(ys);
+
+		const TReal xi = xs - xsFloor;
+		const TReal yi = ys - ysFloor;
+
+		const uint64 xsbp = static_cast<uint64>(static_cast<int64>(xsFloor)) * PRIME_X;
+		const uint64 ysbp = static_cast<uint64>(static_cast<int64>(ysFloor)) * PRIME_Y;
+
+		// Unskew.
+		const TReal t = (xi + yi) * TReal(UNSKEW_2D);
+		const TReal dx0 = xi + t;
+		const TReal dy0 = yi + t;
+
+		TReal fValue = 0;
+
+		fDx = 0;
+		fDy = 0;
+
+		// First vertex.
+		const TReal a0 = TReal(RSQUARED_2D) - dx0 * dx0 - dy0 * dy0;
+		if (a0 > 0)
+		{
+			addVertex<bDerivatives>(iOctaveSeed, xsbp, ysbp, a0, dx0, dy0, fValue, fDx, fDy);
+		}
+
+		// Second vertex.
+		const TReal a1 = TReal(2 * (1 + 2 * UNSKEW_2D) * (1 / UNSKEW_2D + 2)) * t
+			+ (TReal(-2 * (1 + 2 * UNSKEW_2D) * (1 + 2 * UNSKEW_2D)) + a0);
+		if (a1 > 0)
+		{
+			const TReal dx1 = dx0 - TReal(1 + 2 * UNSKEW_2D);
+			const TReal dy1 = dy0 - TReal(1 + 2 * UNSKEW_2D);
+			addVertex<bDerivatives>(iOctaveSeed, xsbp + PRIME_X, ysbp + PRIME_Y, a1, dx1, dy1, fValue, fDx, fDy);
+		}
+
+		// Third vertex.
+		if (dy0 > dx0)
+		{
+			const TReal dx2 = dx0 - TReal(UNSKEW_2D);
+			const TReal dy2 = dy0 - TReal(UNSKEW_2D + 1);
+			const TReal a2 = TReal(RSQUARED_2D) - dx2 * dx2 - dy2 * dy2;
+			if (a2 > 0)
+			{
+				addVertex<bDerivatives>(iOctaveSeed, xsbp, ysbp + PRIME_Y, a2, dx2, dy2, fValue, fDx, fDy);
+			}
+		}
+		else
+		{
+			const TReal dx2 = dx0 - TReal(UNSKEW_2D + 1);
+			const TReal dy2 = dy0 - TReal(UNSKEW_2D);
+			const TReal a2 = TReal(RSQUARED_2D) - dx2 * dx2 - dy2 * dy2;
+			if (a2 > 0)
+			{
+				addVertex<bDerivatives>(iOctaveSeed, xsbp + PRIME_X, ysbp, a2, dx2, dy2, fValue, fDx, fDy);
+			}
+		}
+
+		return fValue;
+	}
+
+	template <bool bDerivatives, typename TReal>
+	void addVertex(uint64 iOctaveSeed, uint64 xsvp, uint64 ysvp, TReal a, TReal dx, TReal dy,
+		TReal& fValue, TReal& fDx, TReal& fDy) const
+	{
+		const TReal* pGradient = getGradients<TReal>() + gradientIndex(iOctaveSeed, xsvp, ysvp);
+
+		const TReal fGrad = pGradient[0] * dx + pGradient[1] * dy;
+		const TReal a2 = a * a;
+
+		fValue += a2 * a2 * fGrad;
+
+		if (bDerivatives)
+		{
+			// d/dx (a^4 * fGrad) = a^4 * gx + 4a^3 * (-2 * dx) * fGrad.
+			const TReal fFalloff = TReal(-8) * a2 * a * fGrad;
+
+			fDx += a2 * a2 * pGradient[0] + fFalloff * dx;
+			fDy += a2 * a2 * pGradient[1] + fFalloff * dy;
+		}
+	}
+
+	static int32 gradientIndex(uint64 iOctaveSeed, uint64 xsvp, uint64 ysvp)
+	{
+		uint64 iHash = (iOctaveSeed ^ xsvp ^ ysvp) * HASH_MULTIPLIER;
+		// Arithmetic shift, as in the reference implementation.
+		iHash ^= static_cast<uint64>(static_cast<int64>(iHash) >> (64 - GRADIENT_COUNT_EXPONENT + 1));
+
+		return static_cast<int32>(iHash) & ((GRADIENT_COUNT - 1) << 1);
+	}
+
+	template <typename TReal>
+	const TReal* getGradients() const;
+
+
+	static constexpr uint64 PRIME_X         = 0x5205402B9270C86FULL;
+	static constexpr uint64 PRIME_Y         = 0x598CD327003817B5ULL;
+	static constexpr uint64 HASH_MULTIPLIER = 0x53A3F72DEEC546F5ULL;
+
+	static constexpr double SKEW_2D         = 0.366025403784439;
+	static constexpr double UNSKEW_2D       = -0.21132486540518713;
+	static constexpr double RSQUARED_2D     = 0.5;
+
+	static constexpr int32  GRADIENT_COUNT_EXPONENT = 7;
+	static constexpr int32  GRADIENT_COUNT          = 1 << GRADIENT_COUNT_EXPONENT;
+
+
+	const uint32 iSeed;
+
+	// x, y pairs.
+	double vGradients     [GRADIENT_COUNT * 2];
+	float  vGradientsFloat[GRADIENT_COUNT * 2];
+};
+
+template <> inline const double* FWGOpenSimplex2::getGradients<double>() const { return vGradients; }
+template <> inline const float*  FWGOpenSimplex2::getGradients<float> () const { return vGradientsFloat; }
@@ -0,0 +1,102 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGPackedVertex.h"
+
+
+FWGVertexPacker::FWGVertexPacker(const FVector& vOrigin, float fStepX, float fStepY, float fHeightRange)
+	: vOrigin(vOrigin), fInvStepX(1.0f / fStepX), fInvStepY(1.0f / fStepY), fStepX(fStepX), fStepY(fStepY),
+	fHeightRange(fHeightRange), fHeightToUnits((fHeightRange > 0.0f) ? (65535.0f / fHeightRange) : 0.0f)
+{
+}
+
+void FWGVertexPacker::pack(const TArray<FVector>& vVertices, const TArray<FVector>& vNormals, const TArray<FLinearColor>& vVertexColors,
+	TArray<FWGPackedVertex>& vOut) const
+{
+	const int32 iVertexCount = vVertices.Num();
+
+	vOut.SetNumUninitialized(iVertexCount, false);
+
+	const FVector*      pVertices = vVertices.GetData();
+	const FVector*      pNormals  = vNormals.GetData();
+	const FLinearColor* pColors   = vVertexColors.GetData();
+
+	FWGPackedVertex*    pOut      = vOut.GetData();
+
+	for (int32 k = 0; k < iVertexCount; k++)
+	{
+		FWGPackedVertex& vertex = pOut[k];
+
+		vertex.iX      = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt((pVertices[k].X - vOrigin.X) * fInvStepX), 0, 65535));
+		vertex.iY      = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt((pVertices[k].Y - vOrigin.Y) * fInvStepY), 0, 65535));
+		vertex.iHeight = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt((pVertices[k].Z - vOrigin.Z) * fHeightToUnits), 0, 65535));
+
+		encodeOctahedral(pNormals[k], vertex.vNormal);
+
+		vertex.iLayer  = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(pColors[k].A * 65535.0f), 0, 65535));
+	}
+}
+
+FVector FWGVertexPacker::unpackLocation(const FWGPackedVertex& vertex) const
+{
+	return FVector(vOrigin.X + vertex.iX * fStepX, vOrigin.Y + vertex.iY * fStepY, vOrigin.Z + vertex.iHeight * (fHeightRange / 65535.0f));
+}
+
+FVector FWGVertexPacker::unpackNormal(const FWGPackedVertex& vertex)
+{
+	FVector vNormal(vertex.vNormal[0] / 32767.0f, vertex.vNormal[1] / 32767.0f, 0.0f);
+
+	vNormal.Z = 1.0f - FMath::Abs(vNormal.X) - FMath::Abs(vNormal.Y);
+
+	// Unfold the lower hemisphere.
+	const float t = FMath::Max(-vNormal.Z, 0.0f);
+
+	vNormal.X += (vNormal.X >= 0.0f) ? -t : t;
+	vNormal.Y += (vNormal.Y >= 0.0f) ? -t : t;
+
+	return vNormal.GetSafeNormal();
+}
+
+float FWGVertexPacker::unpackLayer(const FWGPackedVertex& vertex)
+{
+	return vertex.iLayer / 65535.0f;
+}
+
+float FWGVertexPacker::getMaxHeightError() const
+{
+	return fHeightRange / 65535.0f / 2.0f;
+}
+
+const FVector& FWGVertexPacker::getOrigin() const
+{
+	return vOrigin;
+}
+
+FVector FWGVertexPacker::getScale() const
+{
+	return FVector(fStepX * 65535.0f, fStepY * 65535.0f, fHeightRange);
+}
+
+void FWGVertexPacker::encodeOctahedral(const FVector& vNormal, int16* pOut)
+{
+	// Project on the octahedron |x| + |y| + |z| = 1, fold the lower half over the diagonals.
+
+	const float fInvLength = 1.0f / FMath::Max(FMath::Abs(vNormal.X) + FMath::Abs(vNormal.Y) + FMath::Abs(vNormal.Z), 1e-20f);
+
+	float x = vNormal.X * fInvLength;
+	float y = vNormal.Y * fInvLength;
+
+	if (vNormal.Z < 0.0f)
+	{
+		const float fFoldedX = (1.0f - FMath::Abs(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+		const float fFoldedY = (1.0f - FMath::Abs(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+
+		x = fFoldedX;
+		y = fFoldedY;
+	}
+
+	pOut[0] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(x, -1.0f, 1.0f) * 32767.0f));
+	pOut[1] = static_cast<int16>(FMath::RoundToInt(FMath::Clamp(y, -1.0f, 1.0f) * 32767.0f));
+}
@@ -0,0 +1,76 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+// Terrain vertex packed for the GPU, 12 bytes instead of the 64 bytes of the arrays the chunk is generated into
+// (location, normal, tangent, color and UV) and the 76 bytes of a FProcMeshVertex.
+// Everything else is constant or follows from the location in the grid:
+// the UV is (row, column), the tangent follows the row, the color only has the alpha.
+// The vertex buffer of a terrain component holds them as is, FWGTerrainVertexFactory reads them
+// as three pairs of 16 bit values (iX, iY), (vNormal) and (iHeight, iLayer), so their order matters.
+struct FWGPackedVertex
+{
+	// Location relative to the vertex (0, 0) of the chunk, in vertex steps (ChunkPieceSizeX / Y),
+	// so a vertex of the chunk grid is stored exactly.
+	uint16  iX;
+	uint16  iY;
+
+	// Unit normal in the octahedral encoding, snorm.
+	int16   vNormal[2];
+
+	// Z from the origin's Z (0) to the origin's Z + the height range (65535).
+	uint16  iHeight;
+
+	// Material layer (alpha of the vertex color), unorm.
+	uint16  iLayer;
+};
+
+static_assert(sizeof(FWGPackedVertex) == 12, "FWGPackedVertex must stay 12 bytes.");
+
+// Packs the vertices of one chunk into FWGPackedVertex and back (the decoding is what the vertex shader does).
+class FWGVertexPacker
+{
+public:
+
+	// vOrigin      - location of the vertex (0, 0) of the chunk, its Z is the lowest Z (the actor's Z or the bottom of the chunk).
+	// fStepX       - ChunkPieceSizeX, fStepY - ChunkPieceSizeY.
+	// fHeightRange - GenerationMaxZFromActorZ (or the height of the chunk).
+	FWGVertexPacker(const FVector& vOrigin, float fStepX, float fStepY, float fHeightRange);
+
+	// vOut is resized to the vertex count, its memory is reused.
+	void     pack           (const TArray<FVector>& vVertices, const TArray<FVector>& vNormals, const TArray<FLinearColor>& vVertexColors,
+		TArray<FWGPackedVertex>& vOut) const;
+
+	FVector  unpackLocation (const FWGPackedVertex& vertex) const;
+
+	static FVector unpackNormal (const FWGPackedVertex& vertex);
+	static float   unpackLayer  (const FWGPackedVertex& vertex);
+
+	// Max error of unpackLocation() along Z, X and Y are exact for the vertices of the grid.
+	float    getMaxHeightError () const;
+
+	// The vertex shader reads (iX, iY, iHeight) normalized to [0, 1], the location is vOrigin + them * getScale().
+	const FVector& getOrigin   () const;
+	FVector  getScale          () const;
+
+private:
+
+	static void    encodeOctahedral (const FVector& vNormal, int16* pOut);
+
+
+	const FVector  vOrigin;
+
+	const float    fInvStepX;
+	const float    fInvStepY;
+	const float    fStepX;
+	const float    fStepY;
+
+	const float    fHeightRange;
+	const float    fHeightToUnits;
+};
@@ -0,0 +1,474 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGTerrainComponent.h"
+
+// UE
+#include "PrimitiveSceneProxy.h"
+#include "SceneManagement.h"
+#include "MaterialShared.h"
+#include "Materials/Material.h"
+#include "Engine/Engine.h"
+#include "RenderResource.h"
+#include "RHI.h"
+
+// Custom
+#include "FWGTerrainVertexFactory.h"
+#include "FWGChunkIndexBuffer.h"
+
+
+// Vertex buffer of the chunk (FWGPackedVertex).
+class FWGTerrainVertexBuffer : public FVertexBuffer
+{
+public:
+
+	FWGTerrainVertexBuffer() : pData(nullptr), iVertexCount(0)
+	{
+	}
+
+	// Render thread. The data must live until the next setData().
+	void setData(const FWGPackedVertex* pNewData, int32 iNewVertexCount)
+	{
+		pData        = pNewData;
+		iVertexCount = iNewVertexCount;
+	}
+
+	// Render thread. Writes the data into the buffer that already has this vertex count.
+	void write()
+	{
+		const uint32 iSize = iVertexCount * sizeof(FWGPackedVertex);
+
+		void* pBuffer = RHILockVertexBuffer(VertexBufferRHI, 0, iSize, RLM_WriteOnly);
+		FMemory::Memcpy(pBuffer, pData, iSize);
+		RHIUnlockVertexBuffer(VertexBufferRHI);
+	}
+
+	int32 getVertexCount() const
+	{
+		return iVertexCount;
+	}
+
+	virtual void InitRHI() override
+	{
+		if (iVertexCount == 0)
+		{
+			return;
+		}
+
+		FRHIResourceCreateInfo createInfo;
+		VertexBufferRHI = RHICreateVertexBuffer(iVertexCount * sizeof(FWGPackedVertex), BUF_Dynamic, createInfo);
+
+		write();
+	}
+
+private:
+
+	const FWGPackedVertex*     pData;
+	int32                      iVertexCount;
+};
+
+
+class FWGTerrainIndexBuffer : public FIndexBuffer
+{
+public:
+
+	// Keeps a copy of the indices, InitRHI() can be called again (when the RHI is recreated).
+	FWGTerrainIndexBuffer(const TArray<int32>& vIndices) : iIndexCount(vIndices.Num()), iStride(sizeof(int32))
+	{
+		vData.SetNumUninitialized(vIndices.Num() * iStride);
+		FMemory::Memcpy(vData.GetData(), vIndices.GetData(), vData.Num());
+	}
+
+	FWGTerrainIndexBuffer(const TArray<uint16>& vIndices) : iIndexCount(vIndices.Num()), iStride(sizeof(uint16))
+	{
+		vData.SetNumUninitialized(vIndices.Num() * iStride);
+		FMemory::Memcpy(vData.GetData(), vIndices.GetData(), vData.Num());
+	}
+
+	int32 getIndexCount() const
+	{
+		return iIndexCount;
+	}
+
+	virtual void InitRHI() override
+	{
+		if (iIndexCount == 0)
+		{
+			return;
+		}
+
+		FRHIResourceCreateInfo createInfo;
+		IndexBufferRHI = RHICreateIndexBuffer(iStride, vData.Num(), BUF_Static, createInfo);
+
+		void* pBuffer = RHILockIndexBuffer(IndexBufferRHI, 0, vData.Num(), RLM_WriteOnly);
+		FMemory::Memcpy(pBuffer, vData.GetData(), vData.Num());
+		RHIUnlockIndexBuffer(IndexBufferRHI);
+	}
+
+private:
+
+	TArray<uint8>         vData;
+
+	const int32           iIndexCount;
+	const uint32          iStride;
+};
+
+
+// The resource must be released on the render thread, the last reference can be dropped on the game thread.
+static FWGTerrainIndicesPtr makeTerrainIndices(FWGTerrainIndexBuffer* pIndexBuffer)
+{
+	BeginInitResource(pIndexBuffer);
+
+	return FWGTerrainIndicesPtr(pIndexBuffer, [](FWGTerrainIndexBuffer* pBuffer)
+	{
+		if (IsInRenderingThread())
+		{
+			pBuffer->ReleaseResource();
+
+			delete pBuffer;
+
+			return;
+		}
+
+		ENQUEUE_RENDER_COMMAND(FWGReleaseTerrainIndices)(
+			[pBuffer](FRHICommandListImmediate& RHICmdList)
+			{
+				pBuffer->ReleaseResource();
+
+				delete pBuffer;
+			});
+	});
+}
+
+
+class FWGTerrainSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+
+	FWGTerrainSceneProxy(UFWGTerrainComponent* pComponent, const FWGTerrainMeshDataPtr& pMeshData, const FWGTerrainIndicesPtr& pIndices)
+		: FPrimitiveSceneProxy(pComponent),
+		vertexFactory(GetScene().GetFeatureLevel()),
+		pMeshData(pMeshData), pIndices(pIndices),
+		materialRelevance(pComponent->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+	{
+		pMaterial = pComponent->GetMaterial(0);
+
+		// The vertex factory has no shaders for the materials that are not terrain materials.
+		if ((pMaterial == nullptr) || (FWGTerrainVertexFactory::isTerrainMaterial(pMaterial->GetMaterial()->GetPathName()) == false))
+		{
+			pMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+
+			materialRelevance = pMaterial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
+		}
+	}
+
+	virtual ~FWGTerrainSceneProxy()
+	{
+		releaseVertexBuffers();
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t iUniquePointer;
+		return reinterpret_cast<size_t>(&iUniquePointer);
+	}
+
+	virtual void CreateRenderThreadResources() override
+	{
+		initVertexBuffers();
+	}
+
+	// Render thread. pNewIndices is nullptr if the triangles did not change.
+	void setMesh_RenderThread(const FWGTerrainMeshDataPtr& pNewMeshData, const FWGTerrainIndicesPtr& pNewIndices)
+	{
+		check(IsInRenderingThread());
+
+		const bool bSameVertexCount = (vertexBuffer.getVertexCount() > 0) && (pNewMeshData->vVertices.Num() == vertexBuffer.getVertexCount());
+
+		pMeshData = pNewMeshData;
+
+		if (bSameVertexCount)
+		{
+			// Same buffer, only its content and the packing of the chunk are written.
+
+			vertexBuffer.setData(pMeshData->vVertices.GetData(), pMeshData->vVertices.Num());
+			vertexBuffer.write();
+
+			vertexFactory.setPacking(pMeshData->vOrigin, pMeshData->vScale, pMeshData->vUVScale);
+		}
+		else
+		{
+			// The buffer and the vertex factory that points to it are created again.
+
+			releaseVertexBuffers();
+			initVertexBuffers();
+		}
+
+		if (pNewIndices.IsValid())
+		{
+			pIndices = pNewIndices;
+		}
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& vViews, const FSceneViewFamily& viewFamily,
+		uint32 iVisibilityMap, FMeshElementCollector& collector) const override
+	{
+		if ((pIndices->getIndexCount() == 0) || (vertexBuffer.getVertexCount() == 0))
+		{
+			return;
+		}
+
+		const bool bWireframe = AllowDebugViewmodes() && viewFamily.EngineShowFlags.Wireframe;
+
+		FMaterialRenderProxy* pMaterialProxy = nullptr;
+
+		if (bWireframe)
+		{
+			FColoredMaterialRenderProxy* pWireframeMaterial = new FColoredMaterialRenderProxy(
+				GEngine->WireframeMaterial ? GEngine->WireframeMaterial->GetRenderProxy() : nullptr, FLinearColor(0.0f, 0.5f, 1.0f));
+
+			collector.RegisterOneFrameMaterialProxy(pWireframeMaterial);
+
+			pMaterialProxy = pWireframeMaterial;
+		}
+		else
+		{
+			pMaterialProxy = pMaterial->GetRenderProxy();
+		}
+
+		for (int32 iViewIndex = 0; iViewIndex < vViews.Num(); iViewIndex++)
+		{
+			if ((iVisibilityMap & (1 << iViewIndex)) == 0)
+			{
+				continue;
+			}
+
+			FMeshBatch& mesh = collector.AllocateMesh();
+			FMeshBatchElement& element = mesh.Elements[0];
+
+			element.IndexBuffer = pIndices.Get();
+
+			mesh.bWireframe          = bWireframe;
+			mesh.VertexFactory       = &vertexFactory;
+			mesh.MaterialRenderProxy = pMaterialProxy;
+
+			bool bHasPrecomputedVolumetricLightmap;
+			FMatrix previousLocalToWorld;
+			int32 iSingleCaptureIndex;
+			bool bOutputVelocity;
+
+			GetScene().GetPrimitiveUniformShaderParameters_RenderThread(GetPrimitiveSceneInfo(), bHasPrecomputedVolumetricLightmap,
+				previousLocalToWorld, iSingleCaptureIndex, bOutputVelocity);
+
+			FDynamicPrimitiveUniformBuffer& primitiveUniformBuffer = collector.AllocateOneFrameResource<FDynamicPrimitiveUniformBuffer>();
+			primitiveUniformBuffer.Set(GetLocalToWorld(), previousLocalToWorld, GetBounds(), GetLocalBounds(), true,
+				bHasPrecomputedVolumetricLightmap, DrawsVelocity(), bOutputVelocity);
+
+			element.PrimitiveUniformBufferResource = &primitiveUniformBuffer.UniformBuffer;
+
+			element.FirstIndex     = 0;
+			element.NumPrimitives  = pIndices->getIndexCount() / 3;
+			element.MinVertexIndex = 0;
+			element.MaxVertexIndex = vertexBuffer.getVertexCount() - 1;
+
+			mesh.ReverseCulling             = IsLocalToWorldDeterminantNegative();
+			mesh.Type                       = PT_TriangleList;
+			mesh.DepthPriorityGroup         = SDPG_World;
+			mesh.bCanApplyViewModeOverrides = false;
+
+			collector.AddMesh(iViewIndex, mesh);
+		}
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* pView) const override
+	{
+		FPrimitiveViewRelevance result;
+
+		result.bDrawRelevance      = IsShown(pView);
+		result.bShadowRelevance    = IsShadowCast(pView);
+		result.bDynamicRelevance   = true;
+		result.bRenderInMainPass   = ShouldRenderInMainPass();
+		result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+		result.bRenderCustomDepth  = ShouldRenderCustomDepth();
+
+		materialRelevance.SetPrimitiveViewRelevance(result);
+
+		result.bVelocityRelevance  = IsMovable() && result.bOpaqueRelevance && result.bRenderInMainPass;
+
+		return result;
+	}
+
+	virtual bool CanBeOccluded() const override
+	{
+		return !materialRelevance.bDisableDepthTest;
+	}
+
+	virtual uint32 GetMemoryFootprint() const override
+	{
+		return sizeof(*this) + GetAllocatedSize();
+	}
+
+private:
+
+	void initVertexBuffers()
+	{
+		if ((pMeshData.IsValid() == false) || (pMeshData->vVertices.Num() == 0))
+		{
+			return;
+		}
+
+		vertexBuffer.setData(pMeshData->vVertices.GetData(), pMeshData->vVertices.Num());
+		vertexBuffer.InitResource();
+
+		vertexFactory.setVertexBuffer(&vertexBuffer);
+		vertexFactory.setPacking(pMeshData->vOrigin, pMeshData->vScale, pMeshData->vUVScale);
+		vertexFactory.InitResource();
+	}
+
+	void releaseVertexBuffers()
+	{
+		vertexFactory.ReleaseResource();
+
+		vertexBuffer.ReleaseResource();
+	}
+
+
+	FWGTerrainVertexFactory vertexFactory;
+
+	FWGTerrainVertexBuffer  vertexBuffer;
+
+	// The vertex buffer points into it.
+	FWGTerrainMeshDataPtr   pMeshData;
+
+	// Shared with the other chunks.
+	FWGTerrainIndicesPtr    pIndices;
+
+	UMaterialInterface*     pMaterial;
+	FMaterialRelevance      materialRelevance;
+};
+
+
+UFWGTerrainComponent::UFWGTerrainComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// The chunks collide through the procedural mesh component of AFWGen.
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	localBox = FBox(ForceInit);
+}
+
+void UFWGTerrainComponent::setMesh(const TArray<FVector>& vVertices, const TArray<FVector>& vNormals, const TArray<FLinearColor>& vVertexColors,
+	const FWGTerrainIndicesPtr& pTriangles, const FBox& bounds, float fStepX, float fStepY, const FVector2D& vUVScale)
+{
+	// A new array every time, the render thread may still read the previous one.
+	TSharedRef<FWGTerrainMeshData, ESPMode::ThreadSafe> pNewMeshData = MakeShared<FWGTerrainMeshData, ESPMode::ThreadSafe>();
+
+	// The heights are quantized over the height of this chunk (skirts included), not of the whole world.
+	const FWGVertexPacker packer(bounds.Min, fStepX, fStepY, bounds.Max.Z - bounds.Min.Z);
+
+	packer.pack(vVertices, vNormals, vVertexColors, pNewMeshData->vVertices);
+
+	pNewMeshData->vOrigin = packer.getOrigin();
+	pNewMeshData->vScale  = packer.getScale();
+
+	pNewMeshData->vUVScale = vUVScale;
+
+	localBox = bounds;
+
+	if (pTriangles.IsValid())
+	{
+		pIndices = pTriangles;
+	}
+
+	pMeshData = pNewMeshData;
+
+	UpdateBounds();
+
+	FWGTerrainSceneProxy* pProxy = static_cast<FWGTerrainSceneProxy*>(SceneProxy);
+
+	if (pProxy && (IsRenderStateDirty() == false))
+	{
+		FWGTerrainMeshDataPtr pData = pMeshData;
+
+		ENQUEUE_RENDER_COMMAND(FWGUpdateTerrainMesh)(
+			[pProxy, pData, pTriangles](FRHICommandListImmediate& RHICmdList)
+			{
+				pProxy->setMesh_RenderThread(pData, pTriangles);
+			});
+
+		// Only sends the new bounds to the proxy.
+		MarkRenderTransformDirty();
+	}
+	else
+	{
+		MarkRenderStateDirty();
+	}
+}
+
+void UFWGTerrainComponent::clearMesh()
+{
+	pMeshData = nullptr;
+	pIndices  = nullptr;
+
+	localBox = FBox(ForceInit);
+
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+FPrimitiveSceneProxy* UFWGTerrainComponent::CreateSceneProxy()
+{
+	if ((pMeshData.IsValid() == false) || (pIndices.IsValid() == false))
+	{
+		return nullptr;
+	}
+
+	return new FWGTerrainSceneProxy(this, pMeshData, pIndices);
+}
+
+int32 UFWGTerrainComponent::GetNumMaterials() const
+{
+	return 1;
+}
+
+FBoxSphereBounds UFWGTerrainComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (localBox.IsValid == false)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+	}
+
+	return FBoxSphereBounds(localBox).TransformBy(LocalToWorld);
+}
+
+FWGTerrainIndicesPtr UFWGTerrainComponent::createIndices(const FWGChunkIndexBuffer& indexBuffer)
+{
+	if (indexBuffer.is16Bit())
+	{
+		return makeTerrainIndices(new FWGTerrainIndexBuffer(indexBuffer.getIndices16()));
+	}
+
+	return makeTerrainIndices(new FWGTerrainIndexBuffer(indexBuffer.getIndices()));
+}
+
+FWGTerrainIndicesPtr UFWGTerrainComponent::createIndices(const TArray<int32>& vIndices, int32 iVertexCount)
+{
+	if (iVertexCount <= 65536)
+	{
+		TArray<uint16> vIndices16;
+		vIndices16.SetNumUninitialized(vIndices.Num());
+
+		for (int32 i = 0; i < vIndices.Num(); i++)
+		{
+			vIndices16[i] = static_cast<uint16>(vIndices[i]);
+		}
+
+		return makeTerrainIndices(new FWGTerrainIndexBuffer(vIndices16));
+	}
+
+	return makeTerrainIndices(new FWGTerrainIndexBuffer(vIndices));
+}
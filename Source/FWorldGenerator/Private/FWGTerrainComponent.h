@@ -0,0 +1,94 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// UE
+#include "Components/MeshComponent.h"
+
+// Custom
+#include "FWGPackedVertex.h"
+
+#include "FWGTerrainComponent.generated.h"
+
+
+// Vertices of a chunk in the layout the GPU reads them (FWGTerrainVertexFactory),
+// packed once on the game thread straight from the chunk arrays and copied by the render thread right into the vertex buffer.
+struct FWGTerrainMeshData
+{
+	TArray<FWGPackedVertex>  vVertices;
+
+	// Decode the vertices, see FWGVertexPacker::getOrigin() and getScale().
+	FVector                  vOrigin;
+	FVector                  vScale;
+
+	// Grid steps to the UV along X and Y (1 if the step is ChunkPieceSizeX / Y).
+	FVector2D                vUVScale;
+};
+
+// Index buffer on the GPU, 16 bit if the vertices allow it. Shared by the proxies of every chunk with the same triangles,
+// released on the render thread after the last of them (and AFWGen) dropped it.
+class FWGTerrainIndexBuffer;
+
+class FWGChunkIndexBuffer;
+
+typedef TSharedPtr<const FWGTerrainMeshData,  ESPMode::ThreadSafe> FWGTerrainMeshDataPtr;
+typedef TSharedPtr<FWGTerrainIndexBuffer,     ESPMode::ThreadSafe> FWGTerrainIndicesPtr;
+
+
+// Draws one chunk with its own scene proxy and GPU buffers (AFWGen keeps one per chunk section).
+// Unlike a section of UProceduralMeshComponent an update does not go through FProcMeshSection
+// and does not touch the other chunks: the vertices are packed into FWGTerrainMeshData (12 bytes per vertex) and a render command
+// writes them into the vertex buffer of this proxy, the proxy is only created again when the component is.
+// The triangles are an index buffer shared by the chunks (one per FWGChunkIndexBuffer), only the adaptive mesh
+// has the triangles of each chunk. No collision, see AFWGen::updateChunkMesh().
+UCLASS()
+class UFWGTerrainComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UFWGTerrainComponent(const FObjectInitializer& ObjectInitializer);
+
+	// pTriangles is nullptr if the triangles are the same as the last time, then only the vertex buffer is written.
+	// bounds - box around the vertices, known from the generation (see AFWGChunk::getMeshBounds()),
+	// every chunk is culled by it on its own, its min is the vertex (0, 0) of the grid and the lowest Z (see FWGVertexPacker).
+	// fStepX / fStepY - distance between two vertices of the grid. The UV and the tangents follow from the grid.
+	// vUVScale - UV of one grid step along X and Y, a horizon chunk has fewer, larger steps than ChunkPieceSizeX / Y
+	// but the material must tile the same way as on the other chunks.
+	// The arrays are not used after the call.
+	void  setMesh   (const TArray<FVector>& vVertices, const TArray<FVector>& vNormals, const TArray<FLinearColor>& vVertexColors,
+		const FWGTerrainIndicesPtr& pTriangles, const FBox& bounds, float fStepX, float fStepY, const FVector2D& vUVScale = FVector2D(1.0f, 1.0f));
+
+	void  clearMesh ();
+
+
+	// Game thread. Triangles shared by the chunks that have the vertices of indexBuffer.
+	static FWGTerrainIndicesPtr createIndices (const FWGChunkIndexBuffer& indexBuffer);
+
+	// Game thread. Triangles of one chunk of iVertexCount vertices (the adaptive mesh).
+	static FWGTerrainIndicesPtr createIndices (const TArray<int32>& vIndices, int32 iVertexCount);
+
+
+	// UPrimitiveComponent
+	virtual FPrimitiveSceneProxy* CreateSceneProxy () override;
+
+	// UMeshComponent
+	virtual int32 GetNumMaterials () const override;
+
+	// USceneComponent
+	virtual FBoxSphereBounds CalcBounds (const FTransform& LocalToWorld) const override;
+
+private:
+
+	// The last mesh, a new scene proxy (after the material changed, for example) is created from it.
+	FWGTerrainMeshDataPtr  pMeshData;
+	FWGTerrainIndicesPtr   pIndices;
+
+	FBox                   localBox;
+};
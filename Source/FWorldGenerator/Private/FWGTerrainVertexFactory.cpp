@@ -0,0 +1,155 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#include "FWGTerrainVertexFactory.h"
+
+// UE
+#include "MaterialShared.h"
+#include "MeshMaterialShader.h"
+#include "MeshBatch.h"
+#include "RHI.h"
+#include "Misc/ConfigCacheIni.h"
+
+// Custom
+#include "FWGPackedVertex.h"
+
+
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FWGTerrainVertexFactoryParameters, "FWGTerrainVF");
+
+
+// Binds the uniform buffer of the factory, everything else comes from the vertex buffer.
+class FWGTerrainVertexFactoryShaderParameters : public FVertexFactoryShaderParameters
+{
+public:
+
+	virtual void Bind(const FShaderParameterMap& parameterMap) override
+	{
+	}
+
+	virtual void Serialize(FArchive& ar) override
+	{
+	}
+
+	virtual void GetElementShaderBindings(const FSceneInterface* pScene, const FSceneView* pView, const FMeshMaterialShader* pShader,
+		const EVertexInputStreamType inputStreamType, ERHIFeatureLevel::Type featureLevel, const FVertexFactory* pVertexFactory,
+		const FMeshBatchElement& batchElement, FMeshDrawSingleShaderBindings& shaderBindings, FVertexInputStreamArray& vertexStreams) const override
+	{
+		const FWGTerrainVertexFactory* pTerrainFactory = static_cast<const FWGTerrainVertexFactory*>(pVertexFactory);
+
+		shaderBindings.Add(pShader->GetUniformBufferParameter<FWGTerrainVertexFactoryParameters>(), pTerrainFactory->getUniformBuffer());
+	}
+};
+
+
+FWGTerrainVertexFactory::FWGTerrainVertexFactory(ERHIFeatureLevel::Type featureLevel)
+	: FVertexFactory(featureLevel), pVertexBuffer(nullptr)
+{
+	parameters.Origin  = FVector4(0.0f, 0.0f, 0.0f, 0.0f);
+	parameters.Scale   = FVector4(0.0f, 0.0f, 0.0f, 0.0f);
+	parameters.UVScale = FVector4(1.0f, 1.0f, 0.0f, 0.0f);
+}
+
+void FWGTerrainVertexFactory::setVertexBuffer(const FVertexBuffer* pNewVertexBuffer)
+{
+	check(IsInRenderingThread());
+
+	pVertexBuffer = pNewVertexBuffer;
+}
+
+void FWGTerrainVertexFactory::setPacking(const FVector& vOrigin, const FVector& vScale, const FVector2D& vUVScale)
+{
+	check(IsInRenderingThread());
+
+	parameters.Origin  = FVector4(vOrigin, 0.0f);
+	parameters.Scale   = FVector4(vScale, 0.0f);
+	parameters.UVScale = FVector4(vUVScale.X, vUVScale.Y, 0.0f, 0.0f);
+
+	if (uniformBuffer.IsValid())
+	{
+		uniformBuffer.UpdateUniformBufferImmediate(parameters);
+	}
+}
+
+FRHIUniformBuffer* FWGTerrainVertexFactory::getUniformBuffer() const
+{
+	return uniformBuffer.GetReference();
+}
+
+bool FWGTerrainVertexFactory::isTerrainMaterial(const FString& sBaseMaterialPath)
+{
+	TArray<FString> vMaterials;
+
+	if (GConfig)
+	{
+		GConfig->GetArray(FWG_TERRAIN_MATERIALS_SECTION, TEXT("TerrainMaterials"), vMaterials, GEngineIni);
+	}
+
+	// "/Game/M_Terrain" or "/Game/M_Terrain.M_Terrain".
+	for (int32 i = 0; i < vMaterials.Num(); i++)
+	{
+		if ((sBaseMaterialPath == vMaterials[i]) || sBaseMaterialPath.StartsWith(vMaterials[i] + TEXT(".")))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FWGTerrainVertexFactory::ShouldCompilePermutation(EShaderPlatform platform, const FMaterial* pMaterial, const FShaderType* pShaderType)
+{
+	// The engine materials are needed for the default material and the wireframe, the terrain materials are an opaque
+	// or masked surface. Every other material would only add shaders that are never used.
+	if (pMaterial->IsSpecialEngineMaterial())
+	{
+		return true;
+	}
+
+	return (pMaterial->GetMaterialDomain() == MD_Surface) && (pMaterial->GetTessellationMode() == MTM_NoTessellation)
+		&& isTerrainMaterial(pMaterial->GetBaseMaterialPathName());
+}
+
+void FWGTerrainVertexFactory::ModifyCompilationEnvironment(const FVertexFactoryType* pType, EShaderPlatform platform, const FMaterial* pMaterial,
+	FShaderCompilerEnvironment& outEnvironment)
+{
+}
+
+FVertexFactoryShaderParameters* FWGTerrainVertexFactory::ConstructShaderParameters(EShaderFrequency shaderFrequency)
+{
+	if (shaderFrequency == SF_Vertex)
+	{
+		return new FWGTerrainVertexFactoryShaderParameters();
+	}
+
+	return nullptr;
+}
+
+void FWGTerrainVertexFactory::InitRHI()
+{
+	check(pVertexBuffer);
+
+	const uint32 iStride = sizeof(FWGPackedVertex);
+
+	// See FVertexFactoryInput in FWGTerrainVertexFactory.ush.
+	FVertexDeclarationElementList vElements;
+
+	vElements.Add(AccessStreamComponent(FVertexStreamComponent(pVertexBuffer, STRUCT_OFFSET(FWGPackedVertex, iX),      iStride, VET_UShort2N), 0));
+	vElements.Add(AccessStreamComponent(FVertexStreamComponent(pVertexBuffer, STRUCT_OFFSET(FWGPackedVertex, vNormal), iStride, VET_Short2N),  1));
+	vElements.Add(AccessStreamComponent(FVertexStreamComponent(pVertexBuffer, STRUCT_OFFSET(FWGPackedVertex, iHeight), iStride, VET_UShort2N), 2));
+
+	InitDeclaration(vElements);
+
+	uniformBuffer = TUniformBufferRef<FWGTerrainVertexFactoryParameters>::CreateUniformBufferImmediate(parameters, UniformBuffer_MultiFrame);
+}
+
+void FWGTerrainVertexFactory::ReleaseRHI()
+{
+	uniformBuffer.SafeRelease();
+
+	FVertexFactory::ReleaseRHI();
+}
+
+
+IMPLEMENT_VERTEX_FACTORY_TYPE(FWGTerrainVertexFactory, "/Plugin/FWorldGenerator/Private/FWGTerrainVertexFactory.ush", true, false, true, false, false);
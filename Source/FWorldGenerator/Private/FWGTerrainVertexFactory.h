@@ -0,0 +1,72 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// UE
+#include "VertexFactory.h"
+#include "UniformBuffer.h"
+#include "ShaderParameterMacros.h"
+
+
+#define FWG_TERRAIN_MATERIALS_SECTION TEXT("/Script/FWorldGenerator.FWGTerrain")
+
+
+// What decodes the FWGPackedVertex of one chunk: location = Origin + (iX, iY, iHeight) / 65535 * Scale (see FWGVertexPacker::getScale()).
+// The UV is (iY, iX) * UVScale.yx in grid steps (see UFWGTerrainComponent::setMesh()).
+// FVector4 so that the members do not cross the 16 byte boundaries of the constant buffer, W (and ZW of UVScale) is not used.
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FWGTerrainVertexFactoryParameters, )
+	SHADER_PARAMETER(FVector4, Origin)
+	SHADER_PARAMETER(FVector4, Scale)
+	SHADER_PARAMETER(FVector4, UVScale)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+
+
+// Vertex factory of UFWGTerrainComponent: one vertex buffer of FWGPackedVertex (12 bytes per vertex),
+// decoded by the vertex shader (Shaders/Private/FWGTerrainVertexFactory.ush). The UV is (row, column) of the grid,
+// the tangent follows the row and the vertex color only has the layer, like the arrays the chunk is generated into.
+// No static lighting, no tessellation.
+class FWGTerrainVertexFactory : public FVertexFactory
+{
+	DECLARE_VERTEX_FACTORY_TYPE(FWGTerrainVertexFactory);
+
+public:
+
+	FWGTerrainVertexFactory(ERHIFeatureLevel::Type featureLevel);
+
+	// Render thread. Before InitResource(), pVertexBuffer must outlive the factory (or the next InitResource()).
+	void  setVertexBuffer (const FVertexBuffer* pVertexBuffer);
+
+	// Render thread. The decoding of the vertices, can be changed while the factory is initialized.
+	void  setPacking      (const FVector& vOrigin, const FVector& vScale, const FVector2D& vUVScale);
+
+	FRHIUniformBuffer* getUniformBuffer () const;
+
+
+	// The shaders of the factory are only compiled for the engine materials and for the base materials listed in
+	// the TerrainMaterials array of the FWG_TERRAIN_MATERIALS_SECTION section of the engine config, for example
+	// +TerrainMaterials=/Game/Materials/M_Terrain in DefaultEngine.ini. The terrain has the default material otherwise.
+	static bool isTerrainMaterial (const FString& sBaseMaterialPath);
+
+
+	static bool ShouldCompilePermutation (EShaderPlatform platform, const FMaterial* pMaterial, const FShaderType* pShaderType);
+	static void ModifyCompilationEnvironment (const FVertexFactoryType* pType, EShaderPlatform platform, const FMaterial* pMaterial,
+		FShaderCompilerEnvironment& outEnvironment);
+	static FVertexFactoryShaderParameters* ConstructShaderParameters (EShaderFrequency shaderFrequency);
+
+
+	// FRenderResource
+	virtual void InitRHI    () override;
+	virtual void ReleaseRHI () override;
+
+private:
+
+	const FVertexBuffer*                                pVertexBuffer;
+
+	FWGTerrainVertexFactoryParameters                   parameters;
+	TUniformBufferRef<FWGTerrainVertexFactoryParameters> uniformBuffer;
+};
@@ -0,0 +1,301 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// External
+#include "PerlinNoise.hpp"
+
+
+// Value noise: a hashed random value in [-1, 1] on every integer lattice point, smoothly interpolated.
+// No gradients and no permutation table, so a sample costs a few multiplications and three lerps
+// (the lattice hashes are shared by all samples in one cell of a row). Blockier than Perlin noise
+// at the same frequency.
+class FWGValueNoise
+{
+public:
+
+	explicit FWGValueNoise(uint32 iSeed) : iSeed(iSeed)
+	{
+	}
+
+	// In [-1, 1].
+	template <typename TReal>
+	TReal noise(TReal x, TReal y, int32 iOctave = 0) const
+	{
+		const TReal xFloor = std::floor(x);
+		const TReal yFloor = std::floor(y);
+
+		const int32 X = static_cast<int32>(xFloor);
+		const int32 Y = static_cast<int32>(yFloor);
+
+		const uint32 iRowHash0 = hashRow(iOctave, Y);
+		const uint32 iRowHash1 = hashRow(iOctave, Y + 1);
+
+		const TReal u = fade(x - xFloor);
+		const TReal v = fade(y - yFloor);
+
+		return lerp(v, lerp(u, latticeValue<TReal>(iRowHash0, X), latticeValue<TReal>(iRowHash0, X + 1)),
+			lerp(u, latticeValue<TReal>(iRowHash1, X), latticeValue<TReal>(iRowHash1, X + 1)));
+	}
+
+	// Same octave sum as siv::PerlinNoise::octaveNoise0_1(), every octave uses its own lattice values.
+	double octaveNoise0_1(double x, double y, int32 iOctaves) const
+	{
+		double fResult = 0.0;
+		double fAmplitude = 1.0;
+
+		for (int32 i = 0; i < iOctaves; i++)
+		{
+			fResult += noise(x, y, i) * fAmplitude;
+			x *= 2.0;
+			y *= 2.0;
+			fAmplitude *= 0.5;
+		}
+
+		return fResult * 0.5 + 0.5;
+	}
+
+	// Row version of octaveNoise0_1() with the same signature as siv::PerlinNoise::octaveNoise0_1Row<Octaves>().
+	// There is no SIMD path, the level is ignored.
+	template <int32 Octaves, typename TReal>
+	void octaveNoise0_1Row(const TReal* pX, TReal y, int32 iCount, const TReal* pFrequency, const TReal* pAmplitude,
+		TReal* pOut, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		for (int32 o = 0; o < Octaves; o++)
+		{
+			const TReal fY = y * pFrequency[o];
+			const TReal fYFloor = std::floor(fY);
+
+			const int32 Y = static_cast<int32>(fYFloor);
+			const TReal v = fade(fY - fYFloor);
+
+			const uint32 iRowHash0 = hashRow(o, Y);
+			const uint32 iRowHash1 = hashRow(o, Y + 1);
+
+			bool  bCellReady = false;
+			int32 iLastX = 0;
+			TReal v00 = 0, v10 = 0, v01 = 0, v11 = 0;
+
+			for (int32 i = 0; i < iCount; i++)
+			{
+				const TReal x = pX[i] * pFrequency[o];
+				const TReal xFloor = std::floor(x);
+				const int32 X = static_cast<int32>(xFloor);
+
+				if ((bCellReady == false) || (X != iLastX))
+				{
+					v00 = latticeValue<TReal>(iRowHash0, X);
+					v10 = latticeValue<TReal>(iRowHash0, X + 1);
+					v01 = latticeValue<TReal>(iRowHash1, X);
+					v11 = latticeValue<TReal>(iRowHash1, X + 1);
+
+					iLastX = X;
+					bCellReady = true;
+				}
+
+				const TReal u = fade(x - xFloor);
+
+				const TReal fValue = lerp(v, lerp(u, v00, v10), lerp(u, v01, v11));
+
+				pOut[i] = ((o > 0) ? pOut[i] : TReal(0)) + fValue * pAmplitude[o];
+			}
+		}
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			pOut[i] = pOut[i] * TReal(0.5) + TReal(0.5);
+		}
+	}
+
+	// octaveNoise0_1Row() that also writes the partial derivatives of the result by x and by y,
+	// same signature as siv::PerlinNoise::octaveNoise0_1RowDerivatives<Octaves>().
+	template <int32 Octaves, typename TReal>
+	void octaveNoise0_1RowDerivatives(const TReal* pX, TReal y, int32 iCount, const TReal* pFrequency, const TReal* pAmplitude,
+		TReal* pOut, TReal* pOutDx, TReal* pOutDy, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		octaveNoiseRowDerivatives<Octaves>(pX, y, iCount, 0, pFrequency, pAmplitude, pOut, pOutDx, pOutDy);
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			pOut[i] = pOut[i] * TReal(0.5) + TReal(0.5);
+			pOutDx[i] *= TReal(0.5);
+			pOutDy[i] *= TReal(0.5);
+		}
+	}
+
+	// Sum of the octaves [iFirstOctave, iFirstOctave + Octaves) with their derivatives, before the mapping to [0, 1],
+	// same signature as siv::PerlinNoise::octaveNoiseRowDerivatives<Octaves>().
+	template <int32 Octaves, typename TReal>
+	void octaveNoiseRowDerivatives(const TReal* pX, TReal y, int32 iCount, int32 iFirstOctave, const TReal* pFrequency,
+		const TReal* pAmplitude, TReal* pOut, TReal* pOutDx, TReal* pOutDy, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		for (int32 o = iFirstOctave; o < iFirstOctave + Octaves; o++)
+		{
+			const TReal fY = y * pFrequency[o];
+			const TReal fYFloor = std::floor(fY);
+
+			const int32 Y = static_cast<int32>(fYFloor);
+			const TReal v = fade(fY - fYFloor);
+			const TReal dv = fadeDerivative(fY - fYFloor);
+
+			const uint32 iRowHash0 = hashRow(o, Y);
+			const uint32 iRowHash1 = hashRow(o, Y + 1);
+
+			// d/dx noise(x * frequency) = frequency * noise'.
+			const TReal fSlope = pAmplitude[o] * pFrequency[o];
+
+			bool  bCellReady = false;
+			int32 iLastX = 0;
+			TReal v00 = 0, v10 = 0, v01 = 0, v11 = 0;
+
+			for (int32 i = 0; i < iCount; i++)
+			{
+				const TReal x = pX[i] * pFrequency[o];
+				const TReal xFloor = std::floor(x);
+				const int32 X = static_cast<int32>(xFloor);
+
+				if ((bCellReady == false) || (X != iLastX))
+				{
+					v00 = latticeValue<TReal>(iRowHash0, X);
+					v10 = latticeValue<TReal>(iRowHash0, X + 1);
+					v01 = latticeValue<TReal>(iRowHash1, X);
+					v11 = latticeValue<TReal>(iRowHash1, X + 1);
+
+					iLastX = X;
+					bCellReady = true;
+				}
+
+				const TReal u = fade(x - xFloor);
+				const TReal du = fadeDerivative(x - xFloor);
+
+				const TReal fBottom = lerp(u, v00, v10);
+				const TReal fTop    = lerp(u, v01, v11);
+
+				const TReal fValue = lerp(v, fBottom, fTop);
+				const TReal fDx = du * lerp(v, v10 - v00, v11 - v01);
+				const TReal fDy = dv * (fTop - fBottom);
+
+				pOut[i]   = ((o > iFirstOctave) ? pOut[i]   : TReal(0)) + fValue * pAmplitude[o];
+				pOutDx[i] = ((o > iFirstOctave) ? pOutDx[i] : TReal(0)) + fDx * fSlope;
+				pOutDy[i] = ((o > iFirstOctave) ? pOutDy[i] : TReal(0)) + fDy * fSlope;
+			}
+		}
+	}
+
+	// octaveNoise0_1RowDerivatives() for samples (pX[i], pY[i]) that do not lie on one row, same signature as
+	// siv::PerlinNoise::octaveNoise0_1PointsDerivatives<Octaves>(). Neighbour samples mostly fall into the same
+	// cell, so the lattice values are still only hashed when the cell changes.
+	template <int32 Octaves, typename TReal>
+	void octaveNoise0_1PointsDerivatives(const TReal* pX, const TReal* pY, int32 iCount, const TReal* pFrequency, const TReal* pAmplitude,
+		TReal* pOut, TReal* pOutDx, TReal* pOutDy, siv::SimdLevel = siv::SimdLevel::Scalar) const
+	{
+		for (int32 o = 0; o < Octaves; o++)
+		{
+			// d/dx noise(x * frequency) = frequency * noise'.
+			const TReal fSlope = pAmplitude[o] * pFrequency[o];
+
+			bool  bCellReady = false;
+			int32 iLastX = 0;
+			int32 iLastY = 0;
+			TReal v00 = 0, v10 = 0, v01 = 0, v11 = 0;
+
+			for (int32 i = 0; i < iCount; i++)
+			{
+				const TReal x = pX[i] * pFrequency[o];
+				const TReal y = pY[i] * pFrequency[o];
+
+				const TReal xFloor = std::floor(x);
+				const TReal yFloor = std::floor(y);
+
+				const int32 X = static_cast<int32>(xFloor);
+				const int32 Y = static_cast<int32>(yFloor);
+
+				if ((bCellReady == false) || (X != iLastX) || (Y != iLastY))
+				{
+					const uint32 iRowHash0 = hashRow(o, Y);
+					const uint32 iRowHash1 = hashRow(o, Y + 1);
+
+					v00 = latticeValue<TReal>(iRowHash0, X);
+					v10 = latticeValue<TReal>(iRowHash0, X + 1);
+					v01 = latticeValue<TReal>(iRowHash1, X);
+					v11 = latticeValue<TReal>(iRowHash1, X + 1);
+
+					iLastX = X;
+					iLastY = Y;
+					bCellReady = true;
+				}
+
+				const TReal u = fade(x - xFloor);
+				const TReal du = fadeDerivative(x - xFloor);
+				const TReal v = fade(y - yFloor);
+				const TReal dv = fadeDerivative(y - yFloor);
+
+				const TReal fBottom = lerp(u, v00, v10);
+				const TReal fTop    = lerp(u, v01, v11);
+
+				const TReal fValue = lerp(v, fBottom, fTop);
+				const TReal fDx = du * lerp(v, v10 - v00, v11 - v01);
+				const TReal fDy = dv * (fTop - fBottom);
+
+				pOut[i]   = ((o > 0) ? pOut[i]   : TReal(0)) + fValue * pAmplitude[o];
+				pOutDx[i] = ((o > 0) ? pOutDx[i] : TReal(0)) + fDx * fSlope;
+				pOutDy[i] = ((o > 0) ? pOutDy[i] : TReal(0)) + fDy * fSlope;
+			}
+		}
+
+		for (int32 i = 0; i < iCount; i++)
+		{
+			pOut[i] = pOut[i] * TReal(0.5) + TReal(0.5);
+			pOutDx[i] *= TReal(0.5);
+			pOutDy[i] *= TReal(0.5);
+		}
+	}
+
+private:
+
+	template <typename TReal>
+	static TReal fade(TReal t)
+	{
+		return t * t * t * (t * (t * 6 - 15) + 10);
+	}
+
+	template <typename TReal>
+	static TReal fadeDerivative(TReal t)
+	{
+		return 30 * t * t * (t * (t - 2) + 1);
+	}
+
+	template <typename TReal>
+	static TReal lerp(TReal t, TReal a, TReal b)
+	{
+		return a + t * (b - a);
+	}
+
+	uint32 hashRow(int32 iOctave, int32 Y) const
+	{
+		return (iSeed + static_cast<uint32>(iOctave) * 0x9E3779B9u) ^ (static_cast<uint32>(Y) * 0x27D4EB2Du);
+	}
+
+	template <typename TReal>
+	static TReal latticeValue(uint32 iRowHash, int32 X)
+	{
+		// Murmur3 finalizer.
+		uint32 h = iRowHash ^ (static_cast<uint32>(X) * 0x165667B1u);
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+
+		// Top 24 bits (exact in float) to [-1, 1].
+		return static_cast<TReal>(static_cast<int32>(h >> 8)) * TReal(2.0 / 16777215.0) - 1;
+	}
+
+
+	const uint32 iSeed;
+};
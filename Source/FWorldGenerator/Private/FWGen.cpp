@@ -7,23 +7,56 @@
 
 // UE
 #include "Components/StaticMeshComponent.h"
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+#include "GameFramework/MovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Async/Async.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Materials/Material.h"
 #include <Runtime/Engine/Classes/Engine/Engine.h>
 
 // STL
+#include <algorithm>
 #include <ctime>
 #include <fstream>
 
 // Custom
 #include "FWGChunk.h"
-
-// External
-#include "PerlinNoise.hpp"
+#include "FWGBenchmark.h"
+#include "FWGNoise.h"
+#include "FWGChunkBorderCache.h"
+#include "FWGBiomeMap.h"
+#include "FWGChunkIndexBuffer.h"
+#include "FWGChunkLod.h"
+#include "FWGChunkRtin.h"
+#include "FWGHorizon.h"
+#include "FWGTerrainComponent.h"
+#include "FWGTerrainVertexFactory.h"
+#include "FWGHeightfieldComponent.h"
+#include "FWGChunkGenerator.h"
+#include "FWGChunkJobQueue.h"
+#include "FWGChunkPrefetcher.h"
 
 #if !UE_BUILD_SHIPPING
 #include "DrawDebugHelpers.h"
 #include <EngineGlobals.h>
 #endif // WITH_EDITOR
 
+DEFINE_LOG_CATEGORY(LogFWGen);
+
+// "stat FWGen" in the console.
+DECLARE_STATS_GROUP(TEXT("FWorldGenerator"), STATGROUP_FWGen, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chunk jobs"), STAT_FWGChunkJobs, STATGROUP_FWGen);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chunk jobs cancelled"), STAT_FWGChunkJobsCancelled, STATGROUP_FWGen);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Worker time saved by cancelled jobs (ms)"), STAT_FWGChunkJobsSavedTime, STATGROUP_FWGen);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chunk commits queued"), STAT_FWGChunkCommits, STATGROUP_FWGen);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chunk commit steps this frame"), STAT_FWGChunkCommitSteps, STATGROUP_FWGen);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Chunk commit time this frame (ms)"), STAT_FWGChunkCommitTime, STATGROUP_FWGen);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Prefetch hit ratio"), STAT_FWGPrefetchHitRatio, STATGROUP_FWGen);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Prefetch waste ratio"), STAT_FWGPrefetchWasteRatio, STATGROUP_FWGen);
+
 // --------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------
@@ -32,11 +65,16 @@
 
 AFWGen::AFWGen()
 {
-	PrimaryActorTick.bCanEverTick = false;
+	// Commits the chunks generated by the chunk jobs (see Tick()).
+	PrimaryActorTick.bCanEverTick = true;
 	bWorldCreated                 = false;
 
 
 	iGeneratedSeed                = 0;
+	iLodLevelCount                = 0;
+	bHeightfieldCollision         = false;
+	iHeightfieldCollisionStep     = 1;
+	pCookingModule                = nullptr;
 
 
 
@@ -45,19 +83,17 @@ AFWGen::AFWGen()
 	pRootNode = CreateDefaultSubobject<USceneComponent>("Root");
 	RootComponent = pRootNode;
 
-	pProcMeshComponent = CreateDefaultSubobject<UProceduralMeshComponent>("ProcMeshComp");
-	//pProcMeshComponent->bUseAsyncCooking = true;  // commented because the world should be generated after GenerateWorld() returned, and not calculate something after the function returned.
-	//pProcMeshComponent->RegisterComponent();
-	pProcMeshComponent->SetupAttachment(RootComponent);
-
-	// Enable collision
-	pProcMeshComponent->ContainsPhysicsTriMeshData(true);
+	// The chunks are drawn by the terrain components (see getTerrainComponent() and getHorizonComponent()) and collide
+	// with the collision components (see getCollisionComponent() and getHeightfieldComponent()).
 
 
 
 	pChunkMap = new FWGenChunkMap(this);
 	pCallbackToDespawn = nullptr;
 
+	pChunkJobs = std::make_shared<FWGChunkJobQueue>();
+	pPrefetcher = std::make_shared<FWGChunkPrefetcher>(pChunkJobs);
+
 
 
 
@@ -122,16 +158,6 @@ AFWGen::~AFWGen()
 
 
 
-	if (pProcMeshComponent->IsValidLowLevel())
-	{
-		if (pProcMeshComponent->IsPendingKill() == false)
-		{
-			pProcMeshComponent->DestroyComponent();
-		}
-	}
-
-
-
 	if (pBlockingVolumeX1->IsValidLowLevel())
 	{
 		if (pBlockingVolumeX1->IsPendingKill() == false)
@@ -254,6 +280,60 @@ void AFWGen::RemoveOverlapToActorClass(UClass* OverlapToClass)
 	}
 }
 
+void AFWGen::HoldUntilCollision(AActor* Actor)
+{
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	const FVector vLocation = Actor->GetActorLocation();
+
+	AFWGChunk* pChunk = getChunkByLocation(vLocation.X, vLocation.Y);
+
+	if ((pChunk == nullptr) || pChunk->bHasCollision)
+	{
+		return;
+	}
+
+	FWGHeldActor held;
+	held.pActor  = Actor;
+	held.iChunkX = pChunk->iX;
+	held.iChunkY = pChunk->iY;
+
+	UPrimitiveComponent* pRoot = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+
+	if (pRoot && pRoot->IsSimulatingPhysics())
+	{
+		pRoot->SetSimulatePhysics(false);
+
+		held.pPhysicsComponent = pRoot;
+	}
+
+	TInlineComponentArray<UMovementComponent*> vMovementComponents;
+	Actor->GetComponents(vMovementComponents);
+
+	for (int32 i = 0; i < vMovementComponents.Num(); i++)
+	{
+		if (vMovementComponents[i]->IsActive())
+		{
+			vMovementComponents[i]->Deactivate();
+
+			held.vMovementComponents.Add(vMovementComponents[i]);
+		}
+	}
+
+	vHeldActors.push_back(held);
+}
+
+void AFWGen::SetStreamingSource(AActor* Actor)
+{
+	pStreamingSource = Actor;
+
+	// The path of the previous source is not the path of this one.
+	pPrefetcher->clearPath();
+}
+
 FVector AFWGen::GetFreeCellLocation(float Layer, bool SetBlocking)
 {
 	FVector location;
@@ -279,6 +359,13 @@ FVector AFWGen::GetFreeCellLocation(float Layer, bool SetBlocking)
 		float fXCellSize = ChunkPieceColumnCount * ChunkPieceSizeX / DivideChunkXCount;
 		float fYCellSize = ChunkPieceRowCount    * ChunkPieceSizeY / DivideChunkYCount;
 
+		FWGChunkBiome biome;
+
+		if (pBiomeMap)
+		{
+			biome = pBiomeMap->getChunkBiome(pChunkMap->vChunks[i]->iX, pChunkMap->vChunks[i]->iY);
+		}
+
 
 		for (size_t y = 0; y < pChunkMap->vChunks[i]->vChunkCells.size(); y++)
 		{
@@ -293,18 +380,21 @@ FVector AFWGen::GetFreeCellLocation(float Layer, bool SetBlocking)
 				location.Y = fStartY + y * fYCellSize + fYCellSize / 2;
 				location.Z = GetActorLocation().Z;
 
-				FHitResult OutHit;
-				FVector TraceStart(location.X, location.Y, GetActorLocation().Z + GenerationMaxZFromActorZ + 5.0f);
-				FVector TraceEnd(location.X, location.Y, GetActorLocation().Z - 5.0f);
-				FCollisionQueryParams CollisionParams;
+				// Same layers as spawnObjects().
+				float fMaterialHeightShift = 0.0f;
 
-				// Get Z.
-				if (GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, CollisionParams))
+				if (pBiomeMap)
 				{
-					if (OutHit.bBlockingHit)
-					{
-						location.Z = OutHit.ImpactPoint.Z;
-					}
+					fMaterialHeightShift = FWGChunkBiome::interpolate(biome.vMaterialHeightShift,
+						(x + 0.5f) / pChunkMap->vChunks[i]->vChunkCells[y].size(), (y + 0.5f) / pChunkMap->vChunks[i]->vChunkCells.size());
+				}
+
+				// Get Z, from the vertices (the chunk may have no collision yet, see CollisionRadius).
+				float fTerrainZ = 0.0f;
+
+				if (getTerrainHeight(location.X, location.Y, fTerrainZ))
+				{
+					location.Z = fTerrainZ;
 				}
 
 				if ( CreateWater && (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * ZWaterLevelInWorld
@@ -322,7 +412,7 @@ FVector AFWGen::GetFreeCellLocation(float Layer, bool SetBlocking)
 						return location;
 					}
 				}
-				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * FirstMaterialMaxRelativeHeight)
+				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * (FirstMaterialMaxRelativeHeight + fMaterialHeightShift))
 				{
 					// First layer.
 
@@ -336,7 +426,7 @@ FVector AFWGen::GetFreeCellLocation(float Layer, bool SetBlocking)
 						return location;
 					}
 				}
-				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * SecondMaterialMaxRelativeHeight)
+				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * (SecondMaterialMaxRelativeHeight + fMaterialHeightShift))
 				{
 					// Second layer.
 
@@ -372,6 +462,52 @@ FVector AFWGen::GetFreeCellLocation(float Layer, bool SetBlocking)
 	return location;
 }
 
+// Comparable number of the version "FWG major.minor.patch", each field is read by the versions since the one it was added in.
+static constexpr int32 makeVersion(int32 iMajor, int32 iMinor, int32 iPatch)
+{
+	return iMajor * 10000 + iMinor * 100 + iPatch;
+}
+
+// -1 if sVersion is not "FWG major.minor.patch".
+static int32 parseVersion(const std::string& sVersion)
+{
+	if (sVersion.compare(0, 4, "FWG ") != 0)
+	{
+		return -1;
+	}
+
+	int32 vFields[3] = {0, 0, 0};
+	int32 iField     = 0;
+	bool  bDigit     = false;
+
+	for (size_t i = 4; i < sVersion.size(); i++)
+	{
+		const char c = sVersion[i];
+
+		if ((c >= '0') && (c <= '9'))
+		{
+			vFields[iField] = vFields[iField] * 10 + (c - '0');
+			bDigit = true;
+		}
+		else if ((c == '.') && bDigit && (iField < 2))
+		{
+			iField++;
+			bDigit = false;
+		}
+		else
+		{
+			return -1;
+		}
+	}
+
+	if ((iField != 2) || (bDigit == false))
+	{
+		return -1;
+	}
+
+	return makeVersion(vFields[0], vFields[1], vFields[2]);
+}
+
 void AFWGen::SaveWorldParamsToFile(FString PathToFile)
 {
 	PathToFile.Append(L".fwgs");
@@ -393,6 +529,18 @@ void AFWGen::SaveWorldParamsToFile(FString PathToFile)
 	saveFile.write(reinterpret_cast<char*>(&ChunkPieceSizeY), sizeof(ChunkPieceSizeY));
 	saveFile.write(reinterpret_cast<char*>(&ViewDistance), sizeof(ViewDistance));
 	saveFile.write(reinterpret_cast<char*>(&LoadUnloadChunkMaxZ), sizeof(LoadUnloadChunkMaxZ));
+	saveFile.write(reinterpret_cast<char*>(&LodDistance), sizeof(LodDistance));
+	saveFile.write(reinterpret_cast<char*>(&LodMaxLevel), sizeof(LodMaxLevel));
+	saveFile.write(reinterpret_cast<char*>(&AdaptiveMeshMaxError), sizeof(AdaptiveMeshMaxError));
+	saveFile.write(reinterpret_cast<char*>(&HorizonDistance), sizeof(HorizonDistance));
+	saveFile.write(reinterpret_cast<char*>(&HorizonResolution), sizeof(HorizonResolution));
+	saveFile.write(reinterpret_cast<char*>(&HeightfieldCollision), sizeof(HeightfieldCollision));
+	saveFile.write(reinterpret_cast<char*>(&HeightfieldCollisionStep), sizeof(HeightfieldCollisionStep));
+	saveFile.write(reinterpret_cast<char*>(&CollisionRadius), sizeof(CollisionRadius));
+	saveFile.write(reinterpret_cast<char*>(&ChunkCommitBudget), sizeof(ChunkCommitBudget));
+	saveFile.write(reinterpret_cast<char*>(&PrefetchLookahead), sizeof(PrefetchLookahead));
+	saveFile.write(reinterpret_cast<char*>(&UseTriggerBoxes), sizeof(UseTriggerBoxes));
+	saveFile.write(reinterpret_cast<char*>(&StreamingHysteresis), sizeof(StreamingHysteresis));
 
 	// Generation.
 	saveFile.write(reinterpret_cast<char*>(&GenerationFrequency), sizeof(GenerationFrequency));
@@ -400,6 +548,17 @@ void AFWGen::SaveWorldParamsToFile(FString PathToFile)
 	saveFile.write(reinterpret_cast<char*>(&GenerationSeed), sizeof(GenerationSeed));
 	saveFile.write(reinterpret_cast<char*>(&GenerationMaxZFromActorZ), sizeof(GenerationMaxZFromActorZ));
 	saveFile.write(reinterpret_cast<char*>(&InvertWorld), sizeof(InvertWorld));
+	saveFile.write(reinterpret_cast<char*>(&SinglePrecisionGeneration), sizeof(SinglePrecisionGeneration));
+	saveFile.write(reinterpret_cast<char*>(&GenerationNoiseType), sizeof(GenerationNoiseType));
+	saveFile.write(reinterpret_cast<char*>(&MultiResolutionMaxError), sizeof(MultiResolutionMaxError));
+	saveFile.write(reinterpret_cast<char*>(&DomainWarpStrength), sizeof(DomainWarpStrength));
+	saveFile.write(reinterpret_cast<char*>(&DomainWarpFrequency), sizeof(DomainWarpFrequency));
+
+	// Biomes.
+	saveFile.write(reinterpret_cast<char*>(&BiomeFrequency), sizeof(BiomeFrequency));
+	saveFile.write(reinterpret_cast<char*>(&BiomeHeightVariation), sizeof(BiomeHeightVariation));
+	saveFile.write(reinterpret_cast<char*>(&BiomeMaterialHeightShift), sizeof(BiomeMaterialHeightShift));
+	saveFile.write(reinterpret_cast<char*>(&BiomeSpawnVariation), sizeof(BiomeSpawnVariation));
 
 	// World.
 	saveFile.write(reinterpret_cast<char*>(&WorldSize), sizeof(WorldSize));
@@ -466,9 +625,9 @@ void AFWGen::LoadWorldParamsFromFile(FString PathToFile)
 	readFile.read(vVersionBuffer, VERSION_SIZE);
 
 
-	std::string sVersion(vVersionBuffer);
+	const int32 iVersion = parseVersion(std::string(vVersionBuffer, std::find(vVersionBuffer, vVersionBuffer + VERSION_SIZE, '\0')));
 
-	if (sVersion.substr(0, 3) != "FWG")
+	if (iVersion < 0)
 	{
 #if !UE_BUILD_SHIPPING
 		LastSaveLoadOperationStatus = false;
@@ -485,6 +644,94 @@ void AFWGen::LoadWorldParamsFromFile(FString PathToFile)
 	readFile.read(reinterpret_cast<char*>(&ViewDistance), sizeof(ViewDistance));
 	readFile.read(reinterpret_cast<char*>(&LoadUnloadChunkMaxZ), sizeof(LoadUnloadChunkMaxZ));
 
+	if (iVersion >= makeVersion(1, 4, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&LodDistance), sizeof(LodDistance));
+		readFile.read(reinterpret_cast<char*>(&LodMaxLevel), sizeof(LodMaxLevel));
+	}
+	else
+	{
+		// Written before the LODs.
+		LodDistance = 0;
+		LodMaxLevel = 3;
+	}
+
+	if (iVersion >= makeVersion(1, 5, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&AdaptiveMeshMaxError), sizeof(AdaptiveMeshMaxError));
+	}
+	else
+	{
+		// Written before the adaptive mesh.
+		AdaptiveMeshMaxError = 0.0f;
+	}
+
+	if (iVersion >= makeVersion(1, 6, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&HorizonDistance), sizeof(HorizonDistance));
+		readFile.read(reinterpret_cast<char*>(&HorizonResolution), sizeof(HorizonResolution));
+	}
+	else
+	{
+		// Written before the horizon.
+		HorizonDistance   = 0;
+		HorizonResolution = 16;
+	}
+
+	if (iVersion >= makeVersion(1, 7, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&HeightfieldCollision), sizeof(HeightfieldCollision));
+		readFile.read(reinterpret_cast<char*>(&HeightfieldCollisionStep), sizeof(HeightfieldCollisionStep));
+	}
+	else
+	{
+		// Written before the heightfield collision.
+		HeightfieldCollision     = false;
+		HeightfieldCollisionStep = 1;
+	}
+
+	if (iVersion >= makeVersion(1, 8, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&CollisionRadius), sizeof(CollisionRadius));
+	}
+	else
+	{
+		// Written before the collision radius.
+		CollisionRadius = -1;
+	}
+
+	if (iVersion >= makeVersion(1, 9, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&ChunkCommitBudget), sizeof(ChunkCommitBudget));
+	}
+	else
+	{
+		// Written before the commit budget.
+		ChunkCommitBudget = 4.0f;
+	}
+
+	if (iVersion >= makeVersion(1, 10, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&PrefetchLookahead), sizeof(PrefetchLookahead));
+	}
+	else
+	{
+		// Written before the prefetch.
+		PrefetchLookahead = 1.0f;
+	}
+
+	if (iVersion >= makeVersion(1, 11, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&UseTriggerBoxes), sizeof(UseTriggerBoxes));
+		readFile.read(reinterpret_cast<char*>(&StreamingHysteresis), sizeof(StreamingHysteresis));
+	}
+	else
+	{
+		// Written when the chunks were only loaded by the trigger boxes.
+		UseTriggerBoxes     = true;
+		StreamingHysteresis = 0.1f;
+	}
+
 	// Generation.
 	readFile.read(reinterpret_cast<char*>(&GenerationFrequency), sizeof(GenerationFrequency));
 	readFile.read(reinterpret_cast<char*>(&GenerationOctaves), sizeof(GenerationOctaves));
@@ -492,6 +739,65 @@ void AFWGen::LoadWorldParamsFromFile(FString PathToFile)
 	readFile.read(reinterpret_cast<char*>(&GenerationMaxZFromActorZ), sizeof(GenerationMaxZFromActorZ));
 	readFile.read(reinterpret_cast<char*>(&InvertWorld), sizeof(InvertWorld));
 
+	if (iVersion >= makeVersion(1, 12, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&SinglePrecisionGeneration), sizeof(SinglePrecisionGeneration));
+	}
+	else
+	{
+		// Written before the single precision generation.
+		SinglePrecisionGeneration = false;
+	}
+
+	if (iVersion >= makeVersion(1, 1, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&GenerationNoiseType), sizeof(GenerationNoiseType));
+	}
+	else
+	{
+		// Written before the noise type could be selected.
+		GenerationNoiseType = EFWGNoiseType::Perlin;
+	}
+
+	if (iVersion >= makeVersion(1, 12, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&MultiResolutionMaxError), sizeof(MultiResolutionMaxError));
+	}
+	else
+	{
+		// Written before the multi-resolution noise.
+		MultiResolutionMaxError = 0.0f;
+	}
+
+	if (iVersion >= makeVersion(1, 2, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&DomainWarpStrength), sizeof(DomainWarpStrength));
+		readFile.read(reinterpret_cast<char*>(&DomainWarpFrequency), sizeof(DomainWarpFrequency));
+	}
+	else
+	{
+		// Written before the domain warping.
+		DomainWarpStrength  = 0.0f;
+		DomainWarpFrequency = 0.5f;
+	}
+
+	// Biomes.
+	if (iVersion >= makeVersion(1, 3, 0))
+	{
+		readFile.read(reinterpret_cast<char*>(&BiomeFrequency), sizeof(BiomeFrequency));
+		readFile.read(reinterpret_cast<char*>(&BiomeHeightVariation), sizeof(BiomeHeightVariation));
+		readFile.read(reinterpret_cast<char*>(&BiomeMaterialHeightShift), sizeof(BiomeMaterialHeightShift));
+		readFile.read(reinterpret_cast<char*>(&BiomeSpawnVariation), sizeof(BiomeSpawnVariation));
+	}
+	else
+	{
+		// Written before the biomes.
+		BiomeFrequency           = 0.05f;
+		BiomeHeightVariation     = 0.0f;
+		BiomeMaterialHeightShift = 0.0f;
+		BiomeSpawnVariation      = 0.0f;
+	}
+
 	// World.
 	readFile.read(reinterpret_cast<char*>(&WorldSize), sizeof(WorldSize));
 
@@ -542,11 +848,89 @@ void AFWGen::GenerateWorld(int64 iCentralChunkX, int64 iCentralChunkY, AActor* p
 {
 	if (pChunkMap)
 	{
-		pChunkMap->clearWorld(pProcMeshComponent);
+		pChunkMap->clearWorld();
+	}
+
+	pHorizon = nullptr;
+
+	for (int32 i = 0; i < vHorizonComponents.Num(); i++)
+	{
+		vHorizonComponents[i]->clearMesh();
+	}
+
+	if (GroundMaterial && (FWGTerrainVertexFactory::isTerrainMaterial(GroundMaterial->GetMaterial()->GetPathName()) == false))
+	{
+		UE_LOG(LogFWGen, Warning, TEXT("%s is not a terrain material, the terrain has the default material (add +TerrainMaterials=%s to the %s section of DefaultEngine.ini)."),
+			*GroundMaterial->GetName(), *GroundMaterial->GetMaterial()->GetPathName(), FWG_TERRAIN_MATERIALS_SECTION);
 	}
 
 
 	generateSeed();
+	createBiomeMap();
+
+	// Same triangles for every chunk, rebuilt only when the chunk size changes.
+	if ((pIndexBuffer == nullptr) || (pIndexBuffer->iRowCount != ChunkPieceRowCount + 1) || (pIndexBuffer->iColumnCount != ChunkPieceColumnCount + 1))
+	{
+		pIndexBuffer = std::make_shared<const FWGChunkIndexBuffer>(ChunkPieceRowCount + 1, ChunkPieceColumnCount + 1);
+
+		pTerrainIndices = UFWGTerrainComponent::createIndices(*pIndexBuffer);
+	}
+
+	// The triangle order of the adaptive mesh too.
+	if (AdaptiveMeshMaxError > 0.0f)
+	{
+		if ((pRtin == nullptr) || (pRtin->iRowCount != ChunkPieceRowCount + 1) || (pRtin->iColumnCount != ChunkPieceColumnCount + 1))
+		{
+			pRtin = std::make_shared<const FWGChunkRtin>(ChunkPieceRowCount + 1, ChunkPieceColumnCount + 1);
+		}
+	}
+	else
+	{
+		pRtin = nullptr;
+	}
+
+	// Same for the LOD levels, a one chunk world has no LODs.
+	// The adaptive mesh only needs the level of the chunk, not the grids.
+	iLodLevelCount = ((LodDistance > 0) && (WorldSize != -1)) ? (LodMaxLevel + 1) : 0;
+
+	const int32 iLodGridCount = pRtin ? 0 : iLodLevelCount;
+
+	if ((static_cast<int32>(vLods.size()) != iLodGridCount)
+		|| ((iLodGridCount > 0) && ((vLods[0]->iRowCount != ChunkPieceRowCount + 1) || (vLods[0]->iColumnCount != ChunkPieceColumnCount + 1))))
+	{
+		vLods.clear();
+		vLodTerrainIndices.clear();
+
+		for (int32 i = 0; i < iLodGridCount; i++)
+		{
+			vLods.push_back(std::make_shared<const FWGChunkLod>(ChunkPieceRowCount + 1, ChunkPieceColumnCount + 1, i));
+
+			vLodTerrainIndices.push_back(UFWGTerrainComponent::createIndices(vLods[i]->getIndexBuffer()));
+		}
+	}
+
+	// The chunk jobs use this copy, the properties can be changed while they run.
+	pChunkGenerator = std::make_shared<const FWGChunkGenerator>(this, iGeneratedSeed, pNoiseContext, pBiomeMap);
+
+	// Enough results for the ring of chunks loaded when the central chunk moves diagonally and for the ring prefetched after it,
+	// and for the horizon chunks that move to the other side of the horizon ring then.
+	size_t iMaxFreeResults = static_cast<size_t>(ViewDistance * 2 + 1) * 4;
+
+	if ((HorizonDistance > 0) && (WorldSize != -1))
+	{
+		iMaxFreeResults += static_cast<size_t>((ViewDistance + HorizonDistance) * 2 + 1) * 2;
+	}
+
+	pChunkJobs->setMaxFreeResults(iMaxFreeResults);
+
+	pCookingModule            = (HeightfieldCollision && FWGHeightfield::isSupported()) ? FWGHeightfield::loadCookingModule() : nullptr;
+	bHeightfieldCollision     = (pCookingModule != nullptr);
+	iHeightfieldCollisionStep = HeightfieldCollisionStep;
+
+	if (HeightfieldCollision && (bHeightfieldCollision == false))
+	{
+		UE_LOG(LogFWGen, Warning, TEXT("Heightfield collision is not supported by the physics engine, the chunks use the triangle mesh collision."));
+	}
 
 	if (WorldSize != -1)
 	{
@@ -593,21 +977,21 @@ void AFWGen::GenerateWorld(int64 iCentralChunkX, int64 iCentralChunkY, AActor* p
 		iCurrentSectionIndex = 1;
 	}
 
-	if (ApplyGroundMaterialBlend)
-	{
-		blendWorldMaterialsMore();
-	}
-	
-	if (ApplySlopeDependentBlend)
+	// Create mesh sections, the blends were applied by the generation.
+	for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
 	{
-		applySlopeDependentBlend();
+		updateChunkMesh(pChunkMap->vChunks[i], true);
+		updateChunkCollision(pChunkMap->vChunks[i], true);
 	}
 
-	// Update mesh.
-	for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
+	// The ring of the horizon chunks right outside of the loaded chunks, a one chunk world has no horizon.
+	if ((HorizonDistance > 0) && (WorldSize != -1))
 	{
-		pProcMeshComponent->UpdateMeshSection_LinearColor(i, pChunkMap->vChunks[i]->vVertices, pChunkMap->vChunks[i]->vNormals,
-			pChunkMap->vChunks[i]->vUV0, pChunkMap->vChunks[i]->vVertexColors, pChunkMap->vChunks[i]->vTangents);
+		pHorizon = std::make_shared<FWGHorizon>(HorizonResolution, ViewDistance, ViewDistance + HorizonDistance);
+
+		pHorizonTerrainIndices = UFWGTerrainComponent::createIndices(pHorizon->getIndexBuffer());
+
+		updateHorizon();
 	}
 
 
@@ -667,6 +1051,17 @@ void AFWGen::GenerateWorld(int64 iCentralChunkX, int64 iCentralChunkY, AActor* p
 
 		pCharacter->SetActorLocation(FVector(fChunkX, fChunkY, pCharacter->GetActorLocation().Z));
 	}
+
+	// The collision of its chunk may still be being built.
+	if (pCharacter)
+	{
+		HoldUntilCollision(pCharacter);
+	}
+
+	if (pCharacter)
+	{
+		pStreamingSource = pCharacter;
+	}
 	
 	if (WorldSize != -1)
 	{
@@ -758,7 +1153,82 @@ void AFWGen::GenerateWorld(int64 iCentralChunkX, int64 iCentralChunkY, AActor* p
 			LoadUnloadChunkMaxZ / 2));
 
 		pBlockingVolumeY2->SetGenerateOverlapEvents(true);
+
+
+		// They keep the player on the loaded chunks until the trigger boxes load the next ones.
+		// Without the trigger boxes the chunks are loaded wherever the player goes, so they only mark the end of the world.
+		const ECollisionEnabled::Type blockingVolumeCollision = (UseTriggerBoxes || (WorldSize > 0)) ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision;
+
+		pBlockingVolumeX1->SetCollisionEnabled(blockingVolumeCollision);
+		pBlockingVolumeX2->SetCollisionEnabled(blockingVolumeCollision);
+		pBlockingVolumeY1->SetCollisionEnabled(blockingVolumeCollision);
+		pBlockingVolumeY2->SetCollisionEnabled(blockingVolumeCollision);
+	}
+
+	// Tick() streams the chunks from now on.
+	bWorldCreated = true;
+}
+
+FString AFWGen::RunBenchmark(int32 Iterations)
+{
+	if (Iterations < 1)
+	{
+		Iterations = 1;
+	}
+
+	FString sReport = FWGBenchmark::benchmarkNoise(iGeneratedSeed, GenerationOctaves,
+		ChunkPieceColumnCount + 1, (ChunkPieceRowCount + 1) * Iterations);
+
+	if ((MultiResolutionMaxError > 0.0f) && (GenerationMaxZFromActorZ > 0.0f))
+	{
+		// Same noise coordinates as FWGChunkGenerator::generate().
+		sReport += TEXT("\n") + FWGBenchmark::benchmarkMultiResolution(iGeneratedSeed, GenerationOctaves, GenerationNoiseType,
+			ChunkPieceColumnCount + 1, ChunkPieceRowCount + 1,
+			GenerationFrequency / static_cast<double>(ChunkPieceColumnCount), GenerationFrequency / static_cast<double>(ChunkPieceRowCount),
+			GenerationMaxZFromActorZ, MultiResolutionMaxError, Iterations);
+	}
+
+	if (DomainWarpStrength > 0.0f)
+	{
+		const double fx = (ChunkPieceColumnCount * ChunkPieceSizeX) / GenerationFrequency;
+		const double fy = (ChunkPieceRowCount    * ChunkPieceSizeY) / GenerationFrequency;
+
+		sReport += TEXT("\n") + FWGBenchmark::benchmarkDomainWarp(iGeneratedSeed, GenerationOctaves, GenerationNoiseType,
+			ChunkPieceColumnCount + 1, ChunkPieceRowCount + 1,
+			GenerationFrequency / static_cast<double>(ChunkPieceColumnCount), GenerationFrequency / static_cast<double>(ChunkPieceRowCount),
+			DomainWarpStrength / fx, DomainWarpStrength / fy, DomainWarpFrequency, Iterations);
+	}
+
+	sReport += TEXT("\n") + FWGBenchmark::benchmarkVertexPacking(iGeneratedSeed, GenerationOctaves, GenerationNoiseType,
+		ChunkPieceColumnCount + 1, ChunkPieceRowCount + 1,
+		GenerationFrequency / static_cast<double>(ChunkPieceColumnCount), GenerationFrequency / static_cast<double>(ChunkPieceRowCount),
+		ChunkPieceSizeX, ChunkPieceSizeY, GenerationMaxZFromActorZ, Iterations);
+
+	if (AdaptiveMeshMaxError > 0.0f)
+	{
+		sReport += TEXT("\n") + FWGBenchmark::benchmarkAdaptiveMesh(iGeneratedSeed, GenerationOctaves, GenerationNoiseType,
+			ChunkPieceColumnCount + 1, ChunkPieceRowCount + 1,
+			GenerationFrequency / static_cast<double>(ChunkPieceColumnCount), GenerationFrequency / static_cast<double>(ChunkPieceRowCount),
+			GenerationMaxZFromActorZ, TerrainCutHeightFromActorZ, AdaptiveMeshMaxError, Iterations);
+	}
+
+	if (HeightfieldCollision)
+	{
+		sReport += TEXT("\n") + FWGBenchmark::benchmarkCollision(iGeneratedSeed, GenerationOctaves, GenerationNoiseType,
+			ChunkPieceColumnCount + 1, ChunkPieceRowCount + 1,
+			GenerationFrequency / static_cast<double>(ChunkPieceColumnCount), GenerationFrequency / static_cast<double>(ChunkPieceRowCount),
+			ChunkPieceSizeX, ChunkPieceSizeY, GenerationMaxZFromActorZ, HeightfieldCollisionStep, Iterations);
 	}
+
+	// A 7x7 world like the one with ViewDistance 3.
+	sReport += TEXT("\n") + FWGBenchmark::benchmarkChunkCulling(iGeneratedSeed, GenerationOctaves, GenerationNoiseType,
+		ChunkPieceColumnCount + 1, ChunkPieceRowCount + 1,
+		GenerationFrequency / static_cast<double>(ChunkPieceColumnCount), GenerationFrequency / static_cast<double>(ChunkPieceRowCount),
+		ChunkPieceSizeX, ChunkPieceSizeY, GenerationMaxZFromActorZ, TerrainCutHeightFromActorZ, 3);
+
+	UE_LOG(LogFWGen, Log, TEXT("%s"), *sReport);
+
+	return sReport;
 }
 
 long long AFWGen::GetCentralChunkX()
@@ -811,266 +1281,45 @@ int64 AFWGen::GetChunkYByLocation(FVector Location)
 	return 0;
 }
 
-void AFWGen::blendWorldMaterialsMore(AFWGChunk* pOnlyForThisChunk)
+float AFWGen::GetPrefetchHitRatio()
 {
+	return pPrefetcher->getHitRatio();
+}
+
+float AFWGen::GetPrefetchWasteRatio()
+{
+	return pPrefetcher->getWasteRatio();
+}
+
+void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
+{
+	if (vObjectsToSpawn.size() == 0)
+	{
+		return;
+	}
+
 	std::mt19937_64 gen(std::random_device{}());
+
 	std::uniform_real_distribution<float> urd(0.0f, 1.0f);
+	std::uniform_real_distribution<float> urd_rotation(-MaxRotation, MaxRotation);
+
+	std::sort(vObjectsToSpawn.begin(), vObjectsToSpawn.end(),
+		[](const FWGCallback& a, const FWGCallback& b) -> bool
+		{
+			return a.fProbabilityToSpawn < b.fProbabilityToSpawn;
+		});
 
-	std::vector<AFWGChunk*> vChunkToProcess;
+	std::vector<AFWGChunk*> vChunksToProcess;
 
 	if (pOnlyForThisChunk)
 	{
-		vChunkToProcess.push_back(pOnlyForThisChunk);
+		vChunksToProcess.push_back(pOnlyForThisChunk);
 	}
 	else
 	{
 		for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
 		{
-			vChunkToProcess.push_back(pChunkMap->vChunks[i]);
-		}
-	}
-
-
-	for (size_t i = 0; i < vChunkToProcess.size(); i++)
-	{
-		size_t iVertexIndex = 0;
-
-		for (size_t iRow = 0; iRow < ChunkPieceRowCount + 1; iRow++)
-		{
-			iVertexIndex = (ChunkPieceColumnCount + 1) * iRow;
-
-			size_t iSkipPoints = 0;
-
-			for (size_t iColumn = 0; iColumn < ChunkPieceColumnCount + 1; iColumn++)
-			{
-				if (iSkipPoints > 0)
-				{
-					iSkipPoints--;
-					iVertexIndex++;
-
-					continue;
-				}
-
-				if ((iRow >= 3) && ((iRow + 3) < (ChunkPieceRowCount + 1))
-					&& (iColumn >= 3) && ((iColumn + 3) < (ChunkPieceColumnCount + 1)))
-				{
-					if (SecondMaterialUnderWater &&
-						(vChunkToProcess[i]->vVertices[iVertexIndex].Z <= (GetActorLocation().Z + (GenerationMaxZFromActorZ * (ZWaterLevelInWorld + 0.008f)))))
-					{
-						// Under water material - don't touch.
-					}
-					else
-					{
-						bool bFirstLayerWithOtherColor  = false;
-						bool bSecondLayerWithOtherColor = false;
-						bool bThirdLayerWithOtherColor  = false;
-
-						if ((vChunkToProcess[i]->vLayerIndex[iVertexIndex] == 1)
-							&& (areEqual(vChunkToProcess[i]->vVertexColors[iVertexIndex].A, 0.0f, 0.1f) == false))
-						{
-							bFirstLayerWithOtherColor = true;
-						}
-						else if ((vChunkToProcess[i]->vLayerIndex[iVertexIndex] == 2)
-							&& (areEqual(vChunkToProcess[i]->vVertexColors[iVertexIndex].A, 0.5f, 0.1f) == false))
-						{
-							bSecondLayerWithOtherColor = true;
-						}
-						else if ((vChunkToProcess[i]->vLayerIndex[iVertexIndex] == 3)
-							&& (areEqual(vChunkToProcess[i]->vVertexColors[iVertexIndex].A, 1.0f, 0.1f) == false))
-						{
-							bThirdLayerWithOtherColor = true;
-						}
-
-
-						if (bFirstLayerWithOtherColor || bSecondLayerWithOtherColor || bThirdLayerWithOtherColor)
-						{
-							// Add a little more of other color.
-
-							// . . . . .
-							// . . . . .
-							// . . + . .  <- we are in the center.
-							// . . . . .
-							// . . . . .
-
-							// Close square:
-
-							for (int32 iIndexY = -(ChunkPieceColumnCount + 1); iIndexY <= (ChunkPieceColumnCount + 1); iIndexY += (ChunkPieceColumnCount + 1))
-							{
-								for (int32 iIndexX = -1; iIndexX <= 1; iIndexX++)
-								{
-									if (urd(gen) <= IncreasedMaterialBlendProbability)
-									{
-										vChunkToProcess[i]->vVertexColors[iVertexIndex + iIndexY + iIndexX] = vChunkToProcess[i]->vVertexColors[iVertexIndex];
-									}
-								}
-							}
-
-							// Far square:
-
-							for (int32 iIndexY = -((ChunkPieceColumnCount + 1) * 2 - 1); iIndexY <= ((ChunkPieceColumnCount + 1) * 2 - 1); iIndexY += (ChunkPieceColumnCount + 1))
-							{
-								for (int32 iIndexX = -2; iIndexX <= 2; iIndexX++)
-								{
-									if (urd(gen) <= (IncreasedMaterialBlendProbability / 2))
-									{
-										vChunkToProcess[i]->vVertexColors[iVertexIndex + iIndexY + iIndexX] = vChunkToProcess[i]->vVertexColors[iVertexIndex];
-									}
-								}
-							}
-
-							iSkipPoints = 2;
-						}
-					}
-				}
-				
-				iVertexIndex++;
-			}
-		}
-	}
-}
-
-void AFWGen::applySlopeDependentBlend(AFWGChunk* pOnlyForThisChunk)
-{
-	float fSteepSlopeMinHeightDiff = GenerationMaxZFromActorZ * MinSlopeHeightMultiplier;
-
-	std::vector<AFWGChunk*> vChunksToProcess;
-
-	if (pOnlyForThisChunk)
-	{
-		vChunksToProcess.push_back(pOnlyForThisChunk);
-	}
-	else
-	{
-		for (size_t iChunk = 0; iChunk < pChunkMap->vChunks.size(); iChunk++)
-		{
-			vChunksToProcess.push_back(pChunkMap->vChunks[iChunk]);
-		}
-	}
-
-	for (size_t iChunk = 0; iChunk < vChunksToProcess.size(); iChunk++)
-	{
-		std::vector<bool> vProcessedVertices(vChunksToProcess[iChunk]->vVertices.Num());
-		vProcessedVertices[0] = true;
-
-		size_t iVertexIndex = 0;
-
-		for (size_t iRow = 0; iRow < ChunkPieceRowCount + 1; iRow++)
-		{
-			for (size_t iColumn = 0; iColumn < ChunkPieceColumnCount + 1; iColumn++)
-			{
-				if (((iRow < 2) || (iRow > ChunkPieceRowCount - 3))
-					|| ((iColumn < 2) || (iColumn > ChunkPieceColumnCount - 3)))
-				{
-					iVertexIndex++;
-					continue;
-				}
-
-				bool bHasLeftPoints  = true;
-				bool bHasTopPoints   = true;
-				bool bHasRightPoints = true;
-				bool bHasDownPoints  = true;
-
-				if (iRow == 0)
-				{
-					bHasTopPoints = false;
-				}
-
-				if (iRow == ChunkPieceRowCount)
-				{
-					bHasDownPoints = false;
-				}
-
-				if (iColumn == 0)
-				{
-					bHasLeftPoints = false;
-				}
-
-				if (iColumn == ChunkPieceColumnCount)
-				{
-					bHasRightPoints = false;
-				}
-
-				float fCurrentVertexZ = vChunksToProcess[iChunk]->vVertices[iVertexIndex].Z;
-
-				// Process the left points:
-				if (bHasLeftPoints)
-				{
-					compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex - 1, fSteepSlopeMinHeightDiff);
-
-					if (bHasTopPoints)
-					{
-						compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex - 1 - (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
-					}
-
-					if (bHasDownPoints)
-					{
-						compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex - 1 + (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
-					}
-				}
-
-				// Process the right points:
-				if (bHasRightPoints)
-				{
-				compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex + 1, fSteepSlopeMinHeightDiff);
-
-				if (bHasTopPoints)
-				{
-					compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex + 1 - (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
-				}
-
-				if (bHasDownPoints)
-				{
-					compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex + 1 + (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
-				}
-				}
-
-				// Top point:
-				if (bHasTopPoints)
-				{
-					compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex - (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
-				}
-
-				// Down point:
-				if (bHasDownPoints)
-				{
-					compareHeightDifference(vChunksToProcess[iChunk], vProcessedVertices, fCurrentVertexZ, iVertexIndex + (ChunkPieceColumnCount + 1), fSteepSlopeMinHeightDiff);
-				}
-
-				iVertexIndex++;
-			}
-		}
-	}
-}
-
-void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
-{
-	if (vObjectsToSpawn.size() == 0)
-	{
-		return;
-	}
-
-	std::mt19937_64 gen(std::random_device{}());
-
-	std::uniform_real_distribution<float> urd(0.0f, 1.0f);
-	std::uniform_real_distribution<float> urd_rotation(-MaxRotation, MaxRotation);
-
-	std::sort(vObjectsToSpawn.begin(), vObjectsToSpawn.end(),
-		[](const FWGCallback& a, const FWGCallback& b) -> bool
-		{
-			return a.fProbabilityToSpawn < b.fProbabilityToSpawn;
-		});
-
-	std::vector<AFWGChunk*> vChunksToProcess;
-
-	if (pOnlyForThisChunk)
-	{
-		vChunksToProcess.push_back(pOnlyForThisChunk);
-	}
-	else
-	{
-		for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
-		{
-			vChunksToProcess.push_back(pChunkMap->vChunks[i]);
+			vChunksToProcess.push_back(pChunkMap->vChunks[i]);
 		}
 	}
 
@@ -1128,6 +1377,16 @@ void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
 		}
 
 
+		// Biome of the chunk, the cells interpolate it.
+
+		FWGChunkBiome biome;
+
+		if (pBiomeMap)
+		{
+			biome = pBiomeMap->getChunkBiome(vChunksToProcess[i]->iX, vChunksToProcess[i]->iY);
+		}
+
+
 		for (size_t y = 0; y < vChunksToProcess[i]->vChunkCells.size(); y++)
 		{
 			for (size_t x = 0; x < vChunksToProcess[i]->vChunkCells[y].size(); x++)
@@ -1138,22 +1397,29 @@ void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
 				location.Z = GetActorLocation().Z;
 
 
+				float fMaterialHeightShift = 0.0f;
+				float fSpawnScale          = 1.0f;
+
+				if (pBiomeMap)
+				{
+					const float fU = (x + 0.5f) / vChunksToProcess[i]->vChunkCells[y].size();
+					const float fV = (y + 0.5f) / vChunksToProcess[i]->vChunkCells.size();
+
+					fMaterialHeightShift = FWGChunkBiome::interpolate(biome.vMaterialHeightShift, fU, fV);
+					fSpawnScale          = FWGChunkBiome::interpolate(biome.vSpawnScale, fU, fV);
+				}
+
+
 				location.X += offsetByX(gen);
 				location.Y += offsetByY(gen);
 
 
-				FHitResult OutHit;
-				FVector TraceStart(location.X, location.Y, GetActorLocation().Z + GenerationMaxZFromActorZ + 5.0f);
-				FVector TraceEnd(location.X, location.Y, GetActorLocation().Z - 5.0f);
-				FCollisionQueryParams CollisionParams;
+				// Get Z, from the vertices (the chunk may have no collision yet, see CollisionRadius).
+				float fTerrainZ = 0.0f;
 
-				// Get Z.
-				if (GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, CollisionParams))
+				if (getTerrainHeight(location.X, location.Y, fTerrainZ))
 				{
-					if (OutHit.bBlockingHit)
-					{
-						location.Z = OutHit.ImpactPoint.Z;
-					}
+					location.Z = fTerrainZ;
 				}
 
 
@@ -1162,25 +1428,23 @@ void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
 
 				bool bSteepSlope = false;
 
+				FVector vSampleLocation = location;
+
 				std::vector<float> vXOffset;
-				vXOffset.push_back(TraceStart.X + fXCellSize / 2);
-				vXOffset.push_back(TraceStart.X - fXCellSize / 2);
+				vXOffset.push_back(vSampleLocation.X + fXCellSize / 2);
+				vXOffset.push_back(vSampleLocation.X - fXCellSize / 2);
 				
 
 				for (size_t k = 0; k < vXOffset.size(); k++)
 				{
-					TraceStart.X = vXOffset[k];
-					TraceEnd.X   = vXOffset[k];
+					vSampleLocation.X = vXOffset[k];
 
-					if (GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, CollisionParams))
+					if (getTerrainHeight(vSampleLocation.X, vSampleLocation.Y, fTerrainZ))
 					{
-						if (OutHit.bBlockingHit)
+						if (fabs(fTerrainZ - location.Z) > MaxZDiffInCell)
 						{
-							if (fabs(OutHit.ImpactPoint.Z - location.Z) > MaxZDiffInCell)
-							{
-								bSteepSlope = true;
-								break;
-							}
+							bSteepSlope = true;
+							break;
 						}
 					}
 				}
@@ -1188,23 +1452,19 @@ void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
 				if (bSteepSlope == false)
 				{
 					std::vector<float> vYOffset;
-					vYOffset.push_back(TraceStart.Y + fYCellSize / 2);
-					vYOffset.push_back(TraceStart.Y - fYCellSize / 2);
+					vYOffset.push_back(vSampleLocation.Y + fYCellSize / 2);
+					vYOffset.push_back(vSampleLocation.Y - fYCellSize / 2);
 
 					for (size_t k = 0; k < vYOffset.size(); k++)
 					{
-						TraceStart.Y = vYOffset[k];
-						TraceEnd.Y   = vYOffset[k];
+						vSampleLocation.Y = vYOffset[k];
 
-						if (GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, CollisionParams))
+						if (getTerrainHeight(vSampleLocation.X, vSampleLocation.Y, fTerrainZ))
 						{
-							if (OutHit.bBlockingHit)
+							if (fabs(fTerrainZ - location.Z) > MaxZDiffInCell)
 							{
-								if (fabs(OutHit.ImpactPoint.Z - location.Z) > MaxZDiffInCell)
-								{
-									bSteepSlope = true;
-									break;
-								}
+								bSteepSlope = true;
+								break;
 							}
 						}
 					}
@@ -1228,13 +1488,13 @@ void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
 
 					pCurrentLayer = &vWaterLayer;
 				}
-				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * FirstMaterialMaxRelativeHeight)
+				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * (FirstMaterialMaxRelativeHeight + fMaterialHeightShift))
 				{
 					// First layer.
 
 					pCurrentLayer = &vFirstLayer;
 				}
-				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * SecondMaterialMaxRelativeHeight)
+				else if (location.Z <= GetActorLocation().Z + GenerationMaxZFromActorZ * (SecondMaterialMaxRelativeHeight + fMaterialHeightShift))
 				{
 					// Second layer.
 
@@ -1256,7 +1516,8 @@ void AFWGen::spawnObjects(AFWGChunk* pOnlyForThisChunk)
 					float fNextValue = 1.0f - fFullProb;
 					if (k != pCurrentLayer->size() - 1)
 					{
-						fNextValue = pCurrentLayer->operator[](k).fProbabilityToSpawn;
+						// The biome makes the less probable objects more or less common, the last one takes the rest.
+						fNextValue = FMath::Min(pCurrentLayer->operator[](k).fProbabilityToSpawn * fSpawnScale, 1.0f - fFullProb);
 					}
 
 					if ((fGeneratedProbForThisCell > fFullProb) && (fGeneratedProbForThisCell <= fFullProb + fNextValue) )
@@ -1320,101 +1581,739 @@ void AFWGen::createTriggerBoxForChunk(AFWGChunk* pChunk)
 		ChunkPieceRowCount * ChunkPieceSizeY / 2,
 		LoadUnloadChunkMaxZ / 2));
 
-	pChunk->pTriggerBox->SetGenerateOverlapEvents(true);
+	// Without them the central chunk is found by pollStreamingSource().
+	pChunk->pTriggerBox->SetGenerateOverlapEvents(UseTriggerBoxes);
 	pChunk->setOverlapToActors(vOverlapToClasses);
 }
 
-bool AFWGen::SetMaxRotation(float fMaxRotation)
+void AFWGen::updateChunkMesh(AFWGChunk* pChunk, bool bNewSection)
 {
-	if (fMaxRotation >= 0.0f)
+	const int32 iSectionIndex = pChunk->iSectionIndex;
+
+	UFWGTerrainComponent* pTerrain = getTerrainComponent(iSectionIndex);
+
+	if (bNewSection && GroundMaterial && (pTerrain->GetMaterial(0) != GroundMaterial))
 	{
-		MaxRotation = fMaxRotation;
+		pTerrain->SetMaterial(0, GroundMaterial);
+	}
 
-		return false;
+	if (pRtin)
+	{
+		// Every LOD level allows twice the error of the previous one.
+		const int32 iLevel = getChunkLodLevel(pChunk);
+
+		const int32 iTriangleCount = pRtin->build(pChunk, AdaptiveMeshMaxError * (1 << iLevel), pChunk->vLodTriangles);
+
+		// The triangles depend on the heights, they are always sent (the only index buffer of one chunk).
+		pTerrain->setMesh(pChunk->vLodVertices, pChunk->vLodNormals, pChunk->vLodVertexColors,
+			UFWGTerrainComponent::createIndices(pChunk->vLodTriangles, pChunk->vLodVertices.Num()), pChunk->getMeshBounds(0.0f), pChunkGenerator->ChunkPieceSizeX, pChunkGenerator->ChunkPieceSizeY);
+
+		pChunk->iLodLevel = iLevel;
+
+		UE_LOG(LogFWGen, Verbose, TEXT("Chunk (%lld, %lld): %d triangles instead of %d (%.1fx less), %d vertices instead of %d, LOD %d."),
+			pChunk->iX, pChunk->iY, iTriangleCount, pRtin->getFullTriangleCount(),
+			static_cast<float>(pRtin->getFullTriangleCount()) / FMath::Max(iTriangleCount, 1),
+			pChunk->vLodVertices.Num(), pChunk->vVertices.Num(), iLevel);
+	}
+	else if (vLods.empty())
+	{
+		// The triangles are only uploaded for a new section, a reused section keeps them.
+		pTerrain->setMesh(pChunk->vVertices, pChunk->vNormals, pChunk->vVertexColors,
+			bNewSection ? pTerrainIndices : FWGTerrainIndicesPtr(), pChunk->getMeshBounds(0.0f), pChunkGenerator->ChunkPieceSizeX, pChunkGenerator->ChunkPieceSizeY);
 	}
 	else
 	{
-		return true;
+		const int32 iLevel = getChunkLodLevel(pChunk);
+
+		const FWGChunkLod& lod       = *vLods[iLevel];
+		const FWGChunkLod& coarseLod = *vLods[FMath::Min(iLevel + 1, static_cast<int32>(vLods.size()) - 1)];
+
+		// The neighbours are one level coarser or finer at most. The crack between two levels is not deeper
+		// than the border error of the coarser one, the chunk on either side hangs a skirt this deep.
+		const float fSkirtDepth = FMath::Max(lod.getBorderError(pChunk->vVertices), coarseLod.getBorderError(pChunk->vVertices))
+			+ FWG_LOD_MIN_SKIRT_DEPTH * FMath::Min(pChunkGenerator->ChunkPieceSizeX, pChunkGenerator->ChunkPieceSizeY);
+
+		lod.build(pChunk, fSkirtDepth);
+
+		if (bNewSection || (pChunk->iLodLevel != iLevel))
+		{
+			// Another vertex count, the section is created again.
+			pTerrain->setMesh(pChunk->vLodVertices, pChunk->vLodNormals, pChunk->vLodVertexColors,
+				vLodTerrainIndices[iLevel], pChunk->getMeshBounds(fSkirtDepth), pChunkGenerator->ChunkPieceSizeX, pChunkGenerator->ChunkPieceSizeY);
+
+			pChunk->iLodLevel = iLevel;
+		}
+		else
+		{
+			pTerrain->setMesh(pChunk->vLodVertices, pChunk->vLodNormals, pChunk->vLodVertexColors,
+				nullptr, pChunk->getMeshBounds(fSkirtDepth), pChunkGenerator->ChunkPieceSizeX, pChunkGenerator->ChunkPieceSizeY);
+		}
 	}
 }
 
-void AFWGen::SetMaxZDiffInCell(float fNewMaxZDiffInCell)
+UFWGTerrainComponent* AFWGen::getTerrainComponent(int32 iSectionIndex)
 {
-	MaxZDiffInCell = fNewMaxZDiffInCell;
-}
+	while (vTerrainComponents.Num() <= iSectionIndex)
+	{
+		UFWGTerrainComponent* pTerrain = NewObject<UFWGTerrainComponent>(this);
 
-#if !UE_BUILD_SHIPPING
+		pTerrain->SetupAttachment(RootComponent);
+		pTerrain->RegisterComponent();
 
-void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
-{
-	Super::PostEditChangeProperty(PropertyChangedEvent);
+		vTerrainComponents.Add(pTerrain);
+	}
 
-	FName MemberPropertyChanged = (PropertyChangedEvent.MemberProperty ? PropertyChangedEvent.MemberProperty->GetFName() : NAME_None);
-	
+	return vTerrainComponents[iSectionIndex];
+}
 
-	if (
-		MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceRowCount)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceColumnCount)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceSizeX)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceSizeY)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationFrequency)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationOctaves)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationSeed)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationMaxZFromActorZ)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ComplexPreview)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, InvertWorld)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, FirstMaterialOnSecondProbability)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, FirstMaterialOnThirdProbability)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SecondMaterialOnFirstProbability)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SecondMaterialOnThirdProbability)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ThirdMaterialOnFirstProbability)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ThirdMaterialOnSecondProbability)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, TerrainCutHeightFromActorZ)
-		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, DrawChunkBounds)
-		)
+UFWGTerrainComponent* AFWGen::getHorizonComponent(int32 iSectionIndex)
+{
+	while (vHorizonComponents.Num() <= iSectionIndex)
 	{
-		if (DrawChunkBounds == false)
-		{
-			FlushPersistentDebugLines(GetWorld());
-		}
+		UFWGTerrainComponent* pTerrain = NewObject<UFWGTerrainComponent>(this);
 
-		if ((TerrainCutHeightFromActorZ > 1.0f) || (TerrainCutHeightFromActorZ < 0.0f))
-		{
-			TerrainCutHeightFromActorZ = 1.0f;
-		}
+		pTerrain->SetupAttachment(RootComponent);
+		pTerrain->RegisterComponent();
 
-		if ((FirstMaterialOnSecondProbability < 0.0f) || (FirstMaterialOnSecondProbability > 1.0f))
-		{
-			FirstMaterialOnSecondProbability = 0.01f;
-		}
+		vHorizonComponents.Add(pTerrain);
+	}
 
-		if ((FirstMaterialOnThirdProbability < 0.0f) || (FirstMaterialOnThirdProbability > 1.0f))
-		{
-			FirstMaterialOnThirdProbability = 0.01f;
-		}
+	return vHorizonComponents[iSectionIndex];
+}
 
-		if ((SecondMaterialOnFirstProbability < 0.0f) || (SecondMaterialOnFirstProbability > 1.0f))
-		{
-			SecondMaterialOnFirstProbability = 0.01f;
-		}
+void AFWGen::updateChunkCollision(AFWGChunk* pChunk, bool bNewHeights)
+{
+	const bool bNeedsCollision = chunkNeedsCollision(pChunk);
 
-		if ((SecondMaterialOnThirdProbability < 0.0f) || (SecondMaterialOnThirdProbability > 1.0f))
-		{
-			SecondMaterialOnThirdProbability = 0.01f;
-		}
+	if (bNewHeights || (bNeedsCollision == false))
+	{
+		// What is attached or being built is for the old heights or is not needed anymore.
 
-		if ((ThirdMaterialOnFirstProbability < 0.0f) || (ThirdMaterialOnFirstProbability > 1.0f))
+		if (pChunk->bTriangleMeshCollision)
 		{
-			ThirdMaterialOnFirstProbability = 0.01f;
+			// The section keeps the old triangles until the collision is needed again (a body that is still cooked
+			// replaces the current one, it does not collide either).
+			getCollisionComponent(pChunk->iSectionIndex)->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 		}
-
-		if ((ThirdMaterialOnSecondProbability < 0.0f) || (ThirdMaterialOnSecondProbability > 1.0f))
+		else if (pChunk->bHasCollision)
 		{
-			ThirdMaterialOnSecondProbability = 0.01f;
+			getHeightfieldComponent(pChunk->iSectionIndex)->setHeightfield(nullptr);
 		}
 
-		if ((IncreasedMaterialBlendProbability < 0.0f) || (IncreasedMaterialBlendProbability > 1.0f))
-		{
+		pChunk->iCollisionRequest++;
+		pChunk->bTriangleMeshCollision = false;
+		pChunk->bCollisionPending = false;
+		pChunk->bHasCollision     = false;
+	}
+
+	if ((bNeedsCollision == false) || pChunk->bHasCollision || pChunk->bCollisionPending)
+	{
+		return;
+	}
+
+	pChunk->bCollisionPending = true;
+
+	if (bHeightfieldCollision == false)
+	{
+		cookChunkCollision(pChunk);
+
+		return;
+	}
+
+	// The worker gets a copy of the vertices, the chunk can be generated again before it finishes.
+	TWeakObjectPtr<AFWGen>    pWeakGen   = this;
+	TWeakObjectPtr<AFWGChunk> pWeakChunk = pChunk;
+
+	// The vertices were generated with the parameters of pChunkGenerator, the properties may have changed since.
+	const uint32    iRequest     = pChunk->iCollisionRequest;
+	const int32     iRowCount    = pChunkGenerator->ChunkPieceRowCount + 1;
+	const int32     iColumnCount = pChunkGenerator->ChunkPieceColumnCount + 1;
+	const int32     iStep        = iHeightfieldCollisionStep;
+	TArray<FVector> vVertices    = pChunk->vVertices;
+
+	IPhysXCookingModule* pCooking = pCookingModule;
+
+	Async(EAsyncExecution::ThreadPool, [pWeakGen, pWeakChunk, iRequest, iRowCount, iColumnCount, iStep, vVertices, pCooking]()
+	{
+		const double fStartTime = FPlatformTime::Seconds();
+
+		// From the full resolution vertices whatever the LOD level or the adaptive mesh are.
+		FWGHeightfieldPtr pHeightfield = MakeShared<const FWGHeightfield, ESPMode::ThreadSafe>(vVertices, iRowCount, iColumnCount, iStep, pCooking);
+
+		const double fElapsed = FPlatformTime::Seconds() - fStartTime;
+
+		AsyncTask(ENamedThreads::GameThread, [pWeakGen, pWeakChunk, iRequest, pHeightfield, fElapsed]()
+		{
+			AFWGen*    pGen   = pWeakGen.Get();
+			AFWGChunk* pChunk = pWeakChunk.Get();
+
+			// The world was generated again, or the chunk was moved or left the collision radius.
+			if ((pGen == nullptr) || (pChunk == nullptr) || (pChunk->iCollisionRequest != iRequest))
+			{
+				return;
+			}
+
+			if (pHeightfield->isValid() == false)
+			{
+				UE_LOG(LogFWGen, Warning, TEXT("Chunk (%lld, %lld): failed to build the heightfield collision, the triangle mesh collision is cooked instead."),
+					pChunk->iX, pChunk->iY);
+
+				// Still pending, the held actors wait for the triangle mesh.
+				pGen->cookChunkCollision(pChunk);
+
+				return;
+			}
+
+			UE_LOG(LogFWGen, Verbose, TEXT("Chunk (%lld, %lld): heightfield collision %d x %d samples, %.1f KB, built in %.3f ms."),
+				pChunk->iX, pChunk->iY, pHeightfield->iSampleColumnCount, pHeightfield->iSampleRowCount,
+				pHeightfield->getSize() / 1024.0f, fElapsed * 1000.0);
+
+			pGen->getHeightfieldComponent(pChunk->iSectionIndex)->setHeightfield(pHeightfield);
+
+			pChunk->bCollisionPending = false;
+			pChunk->bHasCollision     = true;
+
+			pGen->onChunkCollisionAttached(pChunk);
+		});
+	});
+}
+
+void AFWGen::updateChunkCollisions()
+{
+	if (CollisionRadius < 0)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
+	{
+		AFWGChunk* pChunk = pChunkMap->vChunks[i];
+
+		if (chunkNeedsCollision(pChunk) == false)
+		{
+			// Only removed, at once.
+			updateChunkCollision(pChunk, false);
+		}
+		else if ((pChunk->bHasCollision == false) && (pChunk->bCollisionPending == false))
+		{
+			// Built by Tick() within ChunkCommitBudget, like the collision of a committed chunk.
+			vCollisionUpdates.push_back(pChunk);
+		}
+	}
+}
+
+void AFWGen::cookChunkCollision(AFWGChunk* pChunk, bool bOnGameThread)
+{
+	UProceduralMeshComponent* pCollision = getCollisionComponent(pChunk->iSectionIndex);
+
+	pChunk->bTriangleMeshCollision = true;
+
+	// GenerateWorld() returns with the collision ready, the streamed chunks do not wait for it
+	// (the component only cooks on the thread pool in a game world).
+	const bool bAsync = (bOnGameThread == false) && bWorldCreated && GetWorld()->IsGameWorld();
+
+	if (bAsync && pChunk->bCookRunning)
+	{
+		// Started by updatePendingCollisions() when the running one finishes (its body is for older heights).
+		return;
+	}
+
+	pCollision->bUseAsyncCooking = bAsync;
+
+	// The LOD levels are only drawn, the collision has the full resolution vertices (the adaptive mesh drops
+	// the vertices of the flat ground with its finest error), so it is not cooked again when the LOD level changes.
+	const TArray<int32>* pTriangles = &pIndexBuffer->getIndices();
+
+	if (pRtin)
+	{
+		pRtin->triangulate(pChunk->vVertices, AdaptiveMeshMaxError, vCollisionTriangles);
+
+		pTriangles = &vCollisionTriangles;
+	}
+
+	// The section only has the collision: no normals, UVs, colors and tangents.
+	static const TArray<FVector>          vNoNormals;
+	static const TArray<FVector2D>        vNoUV0;
+	static const TArray<FLinearColor>     vNoVertexColors;
+	static const TArray<FProcMeshTangent> vNoTangents;
+
+	pChunk->pReplacedBodySetup = pCollision->GetBodySetup();
+
+	FProcMeshSection* pSection = pCollision->GetProcMeshSection(0);
+
+	if (pSection && (pRtin == nullptr) && (pSection->ProcVertexBuffer.Num() == pChunk->vVertices.Num()))
+	{
+		pCollision->UpdateMeshSection_LinearColor(0, pChunk->vVertices, vNoNormals, vNoUV0, vNoVertexColors, vNoTangents);
+	}
+	else
+	{
+		pCollision->CreateMeshSection_LinearColor(0, pChunk->vVertices, *pTriangles, vNoNormals, vNoUV0, vNoVertexColors, vNoTangents, true);
+	}
+
+	if (bAsync)
+	{
+		// The component keeps the old body until the new one is cooked, it does not collide until then.
+		pChunk->bCookRunning   = true;
+		pChunk->iCookRequest   = pChunk->iCollisionRequest;
+		pChunk->fCookStartTime = FPlatformTime::Seconds();
+
+		return;
+	}
+
+	// Cooked, the cooking that was running (if any) is cancelled by the component.
+	pChunk->bCookRunning = false;
+
+	attachCookedCollision(pChunk);
+}
+
+void AFWGen::updatePendingCollisions()
+{
+	const double fNow = FPlatformTime::Seconds();
+
+	for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
+	{
+		AFWGChunk* pChunk = pChunkMap->vChunks[i];
+
+		// The heightfields are attached by their tasks.
+		if (pChunk->bCookRunning == false)
+		{
+			continue;
+		}
+
+		UProceduralMeshComponent* pCollision = getCollisionComponent(pChunk->iSectionIndex);
+
+		// The component takes the cooked body when it is ready, a failed cooking keeps the old one.
+		const bool bCooked   = (pCollision->GetBodySetup() != pChunk->pReplacedBodySetup.Get());
+		const bool bTimedOut = (bCooked == false) && ((fNow - pChunk->fCookStartTime) > FWG_COLLISION_COOK_TIMEOUT);
+
+		if ((bCooked == false) && (bTimedOut == false))
+		{
+			continue;
+		}
+
+		pChunk->bCookRunning = false;
+
+		// The collision was removed meanwhile, the component stays without collision.
+		if ((pChunk->bCollisionPending == false) || (pChunk->bTriangleMeshCollision == false))
+		{
+			continue;
+		}
+
+		if (bTimedOut)
+		{
+			UE_LOG(LogFWGen, Warning, TEXT("Chunk (%lld, %lld): the collision was not cooked in %.1f seconds, it is cooked on the game thread."),
+				pChunk->iX, pChunk->iY, FWG_COLLISION_COOK_TIMEOUT);
+
+			cookChunkCollision(pChunk, true);
+		}
+		else if (pChunk->iCookRequest != pChunk->iCollisionRequest)
+		{
+			// Cooked for the older heights.
+			cookChunkCollision(pChunk);
+		}
+		else
+		{
+			attachCookedCollision(pChunk);
+		}
+	}
+}
+
+void AFWGen::attachCookedCollision(AFWGChunk* pChunk)
+{
+	UProceduralMeshComponent* pCollision = getCollisionComponent(pChunk->iSectionIndex);
+
+	UBodySetup* pBodySetup = pCollision->GetBodySetup();
+
+	pChunk->bCollisionPending = false;
+
+	if ((pBodySetup == nullptr) || pBodySetup->bFailedToCreatePhysicsMeshes)
+	{
+		// The held actors of the chunk stay held, updateChunkCollisions() tries again after the central chunk moved.
+		UE_LOG(LogFWGen, Warning, TEXT("Chunk (%lld, %lld): failed to cook the collision."), pChunk->iX, pChunk->iY);
+
+		pCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+		return;
+	}
+
+	pCollision->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	pChunk->bHasCollision = true;
+
+	onChunkCollisionAttached(pChunk);
+}
+
+bool AFWGen::chunkNeedsCollision(const AFWGChunk* pChunk) const
+{
+	if ((CollisionRadius < 0) || (pChunkMap->pCurrentChunk == nullptr))
+	{
+		return true;
+	}
+
+	// The player is the only streaming source, the chunks are loaded around its chunk.
+	const long long iDistance = FMath::Max(FMath::Abs(pChunk->iX - pChunkMap->pCurrentChunk->iX), FMath::Abs(pChunk->iY - pChunkMap->pCurrentChunk->iY));
+
+	return iDistance <= CollisionRadius;
+}
+
+void AFWGen::onChunkCollisionAttached(AFWGChunk* pChunk)
+{
+	for (size_t i = 0; i < vHeldActors.size(); )
+	{
+		FWGHeldActor& held = vHeldActors[i];
+
+		if (held.pActor.IsValid() && ((held.iChunkX != pChunk->iX) || (held.iChunkY != pChunk->iY)))
+		{
+			i++;
+
+			continue;
+		}
+
+		if (held.pPhysicsComponent.IsValid())
+		{
+			held.pPhysicsComponent->SetSimulatePhysics(true);
+		}
+
+		for (int32 k = 0; k < held.vMovementComponents.Num(); k++)
+		{
+			if (held.vMovementComponents[k].IsValid())
+			{
+				held.vMovementComponents[k]->Activate();
+			}
+		}
+
+		vHeldActors.erase(vHeldActors.begin() + i);
+	}
+}
+
+UProceduralMeshComponent* AFWGen::getCollisionComponent(int32 iSectionIndex)
+{
+	while (vCollisionComponents.Num() <= iSectionIndex)
+	{
+		UProceduralMeshComponent* pCollision = NewObject<UProceduralMeshComponent>(this);
+
+		pCollision->SetupAttachment(RootComponent);
+		pCollision->SetVisibility(false);
+		pCollision->RegisterComponent();
+
+		vCollisionComponents.Add(pCollision);
+	}
+
+	return vCollisionComponents[iSectionIndex];
+}
+
+UFWGHeightfieldComponent* AFWGen::getHeightfieldComponent(int32 iSectionIndex)
+{
+	while (vHeightfieldComponents.Num() <= iSectionIndex)
+	{
+		UFWGHeightfieldComponent* pHeightfield = NewObject<UFWGHeightfieldComponent>(this);
+
+		pHeightfield->SetupAttachment(RootComponent);
+		pHeightfield->RegisterComponent();
+
+		vHeightfieldComponents.Add(pHeightfield);
+	}
+
+	return vHeightfieldComponents[iSectionIndex];
+}
+
+AFWGChunk* AFWGen::getChunkByLocation(float fX, float fY) const
+{
+	for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
+	{
+		const TArray<FVector>& vVertices = pChunkMap->vChunks[i]->vVertices;
+
+		if (vVertices.Num() == 0)
+		{
+			continue;
+		}
+
+		if ((fX >= vVertices[0].X) && (fX <= vVertices.Last().X) && (fY >= vVertices[0].Y) && (fY <= vVertices.Last().Y))
+		{
+			return pChunkMap->vChunks[i];
+		}
+	}
+
+	return nullptr;
+}
+
+bool AFWGen::getTerrainHeight(float fX, float fY, float& fZ) const
+{
+	const AFWGChunk* pChunk = getChunkByLocation(fX, fY);
+
+	if (pChunk == nullptr)
+	{
+		return false;
+	}
+
+	// Same grid as the vertices (the properties may have changed since GenerateWorld()).
+	const FWGChunkGenerator& gen = *pChunkGenerator;
+
+	const int32 iColumnCount = gen.ChunkPieceColumnCount + 1;
+
+	if (pChunk->vVertices.Num() != (gen.ChunkPieceRowCount + 1) * iColumnCount)
+	{
+		return false;
+	}
+
+	const float fColumn = (fX - pChunk->vVertices[0].X) / gen.ChunkPieceSizeX;
+	const float fRow    = (fY - pChunk->vVertices[0].Y) / gen.ChunkPieceSizeY;
+
+	const int32 j = FMath::Clamp(FMath::FloorToInt(fColumn), 0, gen.ChunkPieceColumnCount - 1);
+	const int32 i = FMath::Clamp(FMath::FloorToInt(fRow),    0, gen.ChunkPieceRowCount    - 1);
+
+	const float fU = fColumn - j;
+	const float fV = fRow    - i;
+
+	const float z00 = pChunk->vVertices[i       * iColumnCount + j    ].Z;
+	const float z01 = pChunk->vVertices[i       * iColumnCount + j + 1].Z;
+	const float z10 = pChunk->vVertices[(i + 1) * iColumnCount + j    ].Z;
+	const float z11 = pChunk->vVertices[(i + 1) * iColumnCount + j + 1].Z;
+
+	// The diagonal of a cell goes from (i, j + 1) to (i + 1, j), see FWGChunkIndexBuffer.
+	if (fU + fV <= 1.0f)
+	{
+		fZ = z00 + fU * (z01 - z00) + fV * (z10 - z00);
+	}
+	else
+	{
+		fZ = z11 + (1.0f - fU) * (z10 - z11) + (1.0f - fV) * (z01 - z11);
+	}
+
+	return true;
+}
+
+void AFWGen::updateChunkLods()
+{
+	if (iLodLevelCount == 0)
+	{
+		return;
+	}
+
+	// Every chunk is checked again, the chunks queued by the previous move are queued again if they still need it.
+	vLodUpdates.clear();
+
+	for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
+	{
+		if (pChunkMap->vChunks[i]->iLodLevel != getChunkLodLevel(pChunkMap->vChunks[i]))
+		{
+			vLodUpdates.push_back(pChunkMap->vChunks[i]);
+		}
+	}
+
+	// The finer levels (nearer to the player) first.
+	std::stable_sort(vLodUpdates.begin(), vLodUpdates.end(), [this](const TWeakObjectPtr<AFWGChunk>& a, const TWeakObjectPtr<AFWGChunk>& b)
+	{
+		return getChunkLodLevel(a.Get()) < getChunkLodLevel(b.Get());
+	});
+}
+
+int32 AFWGen::getChunkLodLevel(const AFWGChunk* pChunk) const
+{
+	if (iLodLevelCount == 0)
+	{
+		return 0;
+	}
+
+	// Rings of LodDistance chunks around the central chunk, so neighbour chunks are at most one level apart.
+
+	const long long iDistance = FMath::Max(FMath::Abs(pChunk->iX - pChunkMap->getCentralChunkX()), FMath::Abs(pChunk->iY - pChunkMap->getCentralChunkY()));
+
+	return static_cast<int32>(FMath::Min(iDistance / LodDistance, static_cast<long long>(iLodLevelCount) - 1));
+}
+
+void AFWGen::updateHorizon()
+{
+	if (pHorizon == nullptr)
+	{
+		return;
+	}
+
+	std::vector<FWGHorizonChunk*> vChangedChunks;
+
+	pHorizon->moveCenter(pChunkMap->getCentralChunkX(), pChunkMap->getCentralChunkY(), vChangedChunks);
+
+	for (size_t i = 0; i < vChangedChunks.size(); i++)
+	{
+		FWGHorizonChunk& chunk = *vChangedChunks[i];
+
+		// The result of a job for the old place of the chunk is thrown away.
+		chunk.iLoadRequest++;
+
+		if (bWorldCreated == false)
+		{
+			// GenerateWorld() shows the whole world at once.
+
+			FWGChunkData data;
+
+			pChunkGenerator->generateHorizon(data, chunk.iX, chunk.iY, pHorizon->iResolution, pHorizon->getIndexBuffer());
+
+			commitHorizonChunk(chunk, data);
+
+			continue;
+		}
+
+		// Its old place is under the loaded chunks now, hidden until the job of the new place is committed.
+		if (chunk.bHasSection)
+		{
+			getHorizonComponent(chunk.iSectionIndex)->SetVisibility(false);
+		}
+
+		std::shared_ptr<FWGChunkResult> pJob = pChunkJobs->newJob(FWGChunkBorder(pHorizon->iResolution, pHorizon->iResolution));
+
+		FWGChunkJob& job  = pJob->job;
+		job.iRequest      = chunk.iLoadRequest;
+		job.iX            = chunk.iX;
+		job.iY            = chunk.iY;
+		job.fPriority     = FWGChunkJobQueue::getPriority(chunk.iX, chunk.iY, pChunkMap->getCentralChunkX(), pChunkMap->getCentralChunkY());
+		job.pHorizon      = pHorizon;
+		job.iHorizonChunk = static_cast<size_t>(vChangedChunks[i] - pHorizon->vChunks.data());
+		job.pGenerator    = pChunkGenerator;
+
+		pChunkJobs->addJob(std::move(pJob));
+	}
+}
+
+void AFWGen::commitHorizonChunk(FWGHorizonChunk& chunk, const FWGChunkData& data)
+{
+	UFWGTerrainComponent* pTerrain = getHorizonComponent(chunk.iSectionIndex);
+
+	if ((chunk.bHasSection == false) && GroundMaterial && (pTerrain->GetMaterial(0) != GroundMaterial))
+	{
+		pTerrain->SetMaterial(0, GroundMaterial);
+	}
+
+	// Same grid as FWGChunkGenerator::generateHorizon(), the skirts are under the border vertices.
+	// The UV is in full resolution vertices like the one of the other chunks.
+	const int32 iPieces = pHorizon->iResolution - 1;
+
+	const float fStepX = pChunkGenerator->ChunkPieceColumnCount * pChunkGenerator->ChunkPieceSizeX / iPieces;
+	const float fStepY = pChunkGenerator->ChunkPieceRowCount    * pChunkGenerator->ChunkPieceSizeY / iPieces;
+
+	const FVector2D vUVScale(static_cast<float>(pChunkGenerator->ChunkPieceColumnCount) / iPieces,
+		static_cast<float>(pChunkGenerator->ChunkPieceRowCount) / iPieces);
+
+	// The triangles are only uploaded for a new section, a moved chunk keeps them.
+	pTerrain->setMesh(data.vVertices, data.vNormals, data.vVertexColors, chunk.bHasSection ? FWGTerrainIndicesPtr() : pHorizonTerrainIndices,
+		FBox(data.vVertices), fStepX, fStepY, vUVScale);
+
+	pTerrain->SetVisibility(true);
+
+	chunk.bHasSection = true;
+}
+
+bool AFWGen::SetMaxRotation(float fMaxRotation)
+{
+	if (fMaxRotation >= 0.0f)
+	{
+		MaxRotation = fMaxRotation;
+
+		return false;
+	}
+	else
+	{
+		return true;
+	}
+}
+
+void AFWGen::SetMaxZDiffInCell(float fNewMaxZDiffInCell)
+{
+	MaxZDiffInCell = fNewMaxZDiffInCell;
+}
+
+#if !UE_BUILD_SHIPPING
+
+void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FName MemberPropertyChanged = (PropertyChangedEvent.MemberProperty ? PropertyChangedEvent.MemberProperty->GetFName() : NAME_None);
+	
+
+	if (
+		MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceRowCount)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceColumnCount)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceSizeX)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkPieceSizeY)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, LodDistance)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, LodMaxLevel)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, AdaptiveMeshMaxError)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, HorizonDistance)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, HorizonResolution)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, HeightfieldCollision)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, HeightfieldCollisionStep)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, CollisionRadius)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ChunkCommitBudget)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, PrefetchLookahead)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, UseTriggerBoxes)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, StreamingHysteresis)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationFrequency)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationOctaves)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationSeed)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationMaxZFromActorZ)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ComplexPreview)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, InvertWorld)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SinglePrecisionGeneration)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, GenerationNoiseType)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, MultiResolutionMaxError)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, DomainWarpStrength)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, DomainWarpFrequency)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, BiomeFrequency)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, BiomeHeightVariation)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, BiomeMaterialHeightShift)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, BiomeSpawnVariation)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, FirstMaterialOnSecondProbability)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, FirstMaterialOnThirdProbability)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SecondMaterialOnFirstProbability)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SecondMaterialOnThirdProbability)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ThirdMaterialOnFirstProbability)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ThirdMaterialOnSecondProbability)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, TerrainCutHeightFromActorZ)
+		|| MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, DrawChunkBounds)
+		)
+	{
+		if (DrawChunkBounds == false)
+		{
+			FlushPersistentDebugLines(GetWorld());
+		}
+
+		if ((TerrainCutHeightFromActorZ > 1.0f) || (TerrainCutHeightFromActorZ < 0.0f))
+		{
+			TerrainCutHeightFromActorZ = 1.0f;
+		}
+
+		if ((FirstMaterialOnSecondProbability < 0.0f) || (FirstMaterialOnSecondProbability > 1.0f))
+		{
+			FirstMaterialOnSecondProbability = 0.01f;
+		}
+
+		if ((FirstMaterialOnThirdProbability < 0.0f) || (FirstMaterialOnThirdProbability > 1.0f))
+		{
+			FirstMaterialOnThirdProbability = 0.01f;
+		}
+
+		if ((SecondMaterialOnFirstProbability < 0.0f) || (SecondMaterialOnFirstProbability > 1.0f))
+		{
+			SecondMaterialOnFirstProbability = 0.01f;
+		}
+
+		if ((SecondMaterialOnThirdProbability < 0.0f) || (SecondMaterialOnThirdProbability > 1.0f))
+		{
+			SecondMaterialOnThirdProbability = 0.01f;
+		}
+
+		if ((ThirdMaterialOnFirstProbability < 0.0f) || (ThirdMaterialOnFirstProbability > 1.0f))
+		{
+			ThirdMaterialOnFirstProbability = 0.01f;
+		}
+
+		if ((ThirdMaterialOnSecondProbability < 0.0f) || (ThirdMaterialOnSecondProbability > 1.0f))
+		{
+			ThirdMaterialOnSecondProbability = 0.01f;
+		}
+
+		if ((IncreasedMaterialBlendProbability < 0.0f) || (IncreasedMaterialBlendProbability > 1.0f))
+		{
 			IncreasedMaterialBlendProbability = 0.0f;
 		}
 
@@ -1430,6 +2329,68 @@ void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 			ChunkPieceColumnCount = 1;
 		}
 
+		if (LodDistance < 0)
+		{
+			LodDistance = 0;
+		}
+
+		if (LodMaxLevel > FWG_LOD_MAX_LEVEL)
+		{
+			LodMaxLevel = FWG_LOD_MAX_LEVEL;
+		}
+		else if (LodMaxLevel < 1)
+		{
+			LodMaxLevel = 1;
+		}
+
+		if (AdaptiveMeshMaxError < 0.0f)
+		{
+			AdaptiveMeshMaxError = 0.0f;
+		}
+
+		if (HorizonDistance < 0)
+		{
+			HorizonDistance = 0;
+		}
+
+		if (HorizonResolution > FWG_HORIZON_MAX_RESOLUTION)
+		{
+			HorizonResolution = FWG_HORIZON_MAX_RESOLUTION;
+		}
+		else if (HorizonResolution < FWG_HORIZON_MIN_RESOLUTION)
+		{
+			HorizonResolution = FWG_HORIZON_MIN_RESOLUTION;
+		}
+
+		if (HeightfieldCollisionStep < 1)
+		{
+			HeightfieldCollisionStep = 1;
+		}
+
+		if (CollisionRadius < -1)
+		{
+			CollisionRadius = -1;
+		}
+
+		if (ChunkCommitBudget < 0.0f)
+		{
+			ChunkCommitBudget = 0.0f;
+		}
+
+		if (PrefetchLookahead < 0.0f)
+		{
+			PrefetchLookahead = 0.0f;
+		}
+
+		if (StreamingHysteresis < 0.0f)
+		{
+			StreamingHysteresis = 0.0f;
+		}
+		else if (StreamingHysteresis > 0.5f)
+		{
+			StreamingHysteresis = 0.5f;
+		}
+
 		if (GenerationMaxZFromActorZ < 0.0f)
 		{
 			GenerationMaxZFromActorZ = 0.0f;
@@ -1458,6 +2419,36 @@ void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 			GenerationOctaves = 1;
 		}
 
+		if (DomainWarpStrength < 0.0f)
+		{
+			DomainWarpStrength = 0.0f;
+		}
+
+		if (DomainWarpFrequency <= 0.0f)
+		{
+			DomainWarpFrequency = 0.5f;
+		}
+
+		if (BiomeFrequency <= 0.0f)
+		{
+			BiomeFrequency = 0.05f;
+		}
+
+		if ((BiomeHeightVariation < 0.0f) || (BiomeHeightVariation > 1.0f))
+		{
+			BiomeHeightVariation = 0.0f;
+		}
+
+		if ((BiomeMaterialHeightShift < 0.0f) || (BiomeMaterialHeightShift > 1.0f))
+		{
+			BiomeMaterialHeightShift = 0.0f;
+		}
+
+		if ((BiomeSpawnVariation < 0.0f) || (BiomeSpawnVariation > 1.0f))
+		{
+			BiomeSpawnVariation = 0.0f;
+		}
+
 		refreshPreview();
 
 		if (ComplexPreview)
@@ -1466,7 +2457,7 @@ void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 		}
 		else
 		{
-			pChunkMap->clearWorld(pProcMeshComponent);
+			pChunkMap->clearWorld();
 		}
 	}
 	else if ( MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, CreateWater) 
@@ -1486,7 +2477,15 @@ void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 
 		if (GroundMaterial)
 		{
-			pProcMeshComponent->SetMaterial(0, GroundMaterial);
+			for (int32 i = 0; i < vTerrainComponents.Num(); i++)
+			{
+				vTerrainComponents[i]->SetMaterial(0, GroundMaterial);
+			}
+
+			for (int32 i = 0; i < vHorizonComponents.Num(); i++)
+			{
+				vHorizonComponents[i]->SetMaterial(0, GroundMaterial);
+			}
 		}
 
 		if (CreateWater)
@@ -1529,104 +2528,254 @@ void AFWGen::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 
 		refreshPreview();
 
-		if (ComplexPreview) GenerateWorld();
+		if (ComplexPreview) GenerateWorld();
+	}
+	else if (MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ReadParamsFromFileRightNow))
+	{
+		if (ReadParamsFromFileRightNow)
+		{
+			LoadWorldParamsFromFile(PathToSaveFile);
+		}
+	}
+	else if (MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SaveParamsToFileRightNow))
+	{
+		if (SaveParamsToFileRightNow)
+		{
+			SaveWorldParamsToFile(PathToSaveFile);
+		}
+	}
+	else
+	{
+		refreshPreview();
+
+		if (ComplexPreview) GenerateWorld();
+	}
+}
+#endif // WITH_EDITOR
+
+bool AFWGen::SetChunkPieceRowCount(int32 NewChunkPieceRowCount)
+{
+	if (NewChunkPieceRowCount < 1)
+	{
+		return true;
+	}
+	else
+	{
+		ChunkPieceRowCount = NewChunkPieceRowCount;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetChunkPieceColumnCount(int32 NewChunkPieceColumnCount)
+{
+	if (NewChunkPieceColumnCount < 1)
+	{
+		return true;
+	}
+	else
+	{
+		ChunkPieceColumnCount = NewChunkPieceColumnCount;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetChunkPieceSizeX(float NewChunkPieceSizeX)
+{
+	if (NewChunkPieceSizeX < 0.5f)
+	{
+		return true;
+	}
+	else
+	{
+		ChunkPieceSizeX = NewChunkPieceSizeX;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetChunkPieceSizeY(float NewChunkPieceSizeY)
+{
+	if (NewChunkPieceSizeY < 0.5f)
+	{
+		return true;
+	}
+	else
+	{
+		ChunkPieceSizeY = NewChunkPieceSizeY;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetViewDistance(int32 NewViewDistance)
+{
+	if (NewViewDistance < 1)
+	{
+		return true;
+	}
+	else
+	{
+		ViewDistance = NewViewDistance;
+
+		return false;
+	}
+}
+
+void AFWGen::SetLoadUnloadChunkMaxZ(float NewLoadUnloadChunkMaxZ)
+{
+	LoadUnloadChunkMaxZ = NewLoadUnloadChunkMaxZ;
+}
+
+bool AFWGen::SetLodDistance(int32 NewLodDistance)
+{
+	if (NewLodDistance < 0)
+	{
+		return true;
+	}
+	else
+	{
+		LodDistance = NewLodDistance;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetLodMaxLevel(int32 NewLodMaxLevel)
+{
+	if ((NewLodMaxLevel < 1) || (NewLodMaxLevel > FWG_LOD_MAX_LEVEL))
+	{
+		return true;
+	}
+	else
+	{
+		LodMaxLevel = NewLodMaxLevel;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetAdaptiveMeshMaxError(float NewAdaptiveMeshMaxError)
+{
+	if (NewAdaptiveMeshMaxError < 0.0f)
+	{
+		return true;
 	}
-	else if (MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, ReadParamsFromFileRightNow))
+	else
 	{
-		if (ReadParamsFromFileRightNow)
-		{
-			LoadWorldParamsFromFile(PathToSaveFile);
-		}
+		AdaptiveMeshMaxError = NewAdaptiveMeshMaxError;
+
+		return false;
 	}
-	else if (MemberPropertyChanged == GET_MEMBER_NAME_CHECKED(AFWGen, SaveParamsToFileRightNow))
+}
+
+bool AFWGen::SetHorizonDistance(int32 NewHorizonDistance)
+{
+	if (NewHorizonDistance < 0)
 	{
-		if (SaveParamsToFileRightNow)
-		{
-			SaveWorldParamsToFile(PathToSaveFile);
-		}
+		return true;
 	}
 	else
 	{
-		refreshPreview();
+		HorizonDistance = NewHorizonDistance;
 
-		if (ComplexPreview) GenerateWorld();
+		return false;
 	}
 }
-#endif // WITH_EDITOR
 
-bool AFWGen::SetChunkPieceRowCount(int32 NewChunkPieceRowCount)
+bool AFWGen::SetHorizonResolution(int32 NewHorizonResolution)
 {
-	if (NewChunkPieceRowCount < 1)
+	if ((NewHorizonResolution < FWG_HORIZON_MIN_RESOLUTION) || (NewHorizonResolution > FWG_HORIZON_MAX_RESOLUTION))
 	{
 		return true;
 	}
 	else
 	{
-		ChunkPieceRowCount = NewChunkPieceRowCount;
+		HorizonResolution = NewHorizonResolution;
 
 		return false;
 	}
 }
 
-bool AFWGen::SetChunkPieceColumnCount(int32 NewChunkPieceColumnCount)
+void AFWGen::SetHeightfieldCollision(bool NewHeightfieldCollision)
 {
-	if (NewChunkPieceColumnCount < 1)
+	HeightfieldCollision = NewHeightfieldCollision;
+}
+
+bool AFWGen::SetHeightfieldCollisionStep(int32 NewHeightfieldCollisionStep)
+{
+	if (NewHeightfieldCollisionStep < 1)
 	{
 		return true;
 	}
 	else
 	{
-		ChunkPieceColumnCount = NewChunkPieceColumnCount;
+		HeightfieldCollisionStep = NewHeightfieldCollisionStep;
 
 		return false;
 	}
 }
 
-bool AFWGen::SetChunkPieceSizeX(float NewChunkPieceSizeX)
+bool AFWGen::SetCollisionRadius(int32 NewCollisionRadius)
 {
-	if (NewChunkPieceSizeX < 0.5f)
+	if (NewCollisionRadius < -1)
 	{
 		return true;
 	}
 	else
 	{
-		ChunkPieceSizeX = NewChunkPieceSizeX;
+		CollisionRadius = NewCollisionRadius;
 
 		return false;
 	}
 }
 
-bool AFWGen::SetChunkPieceSizeY(float NewChunkPieceSizeY)
+bool AFWGen::SetChunkCommitBudget(float NewChunkCommitBudget)
 {
-	if (NewChunkPieceSizeY < 0.5f)
+	if (NewChunkCommitBudget < 0.0f)
 	{
 		return true;
 	}
 	else
 	{
-		ChunkPieceSizeY = NewChunkPieceSizeY;
+		ChunkCommitBudget = NewChunkCommitBudget;
 
 		return false;
 	}
 }
 
-bool AFWGen::SetViewDistance(int32 NewViewDistance)
+bool AFWGen::SetPrefetchLookahead(float NewPrefetchLookahead)
 {
-	if (NewViewDistance < 1)
+	if (NewPrefetchLookahead < 0.0f)
 	{
 		return true;
 	}
 	else
 	{
-		ViewDistance = NewViewDistance;
+		PrefetchLookahead = NewPrefetchLookahead;
 
 		return false;
 	}
 }
 
-void AFWGen::SetLoadUnloadChunkMaxZ(float NewLoadUnloadChunkMaxZ)
+void AFWGen::SetUseTriggerBoxes(bool NewUseTriggerBoxes)
 {
-	LoadUnloadChunkMaxZ = NewLoadUnloadChunkMaxZ;
+	UseTriggerBoxes = NewUseTriggerBoxes;
+}
+
+bool AFWGen::SetStreamingHysteresis(float NewStreamingHysteresis)
+{
+	if ((NewStreamingHysteresis < 0.0f) || (NewStreamingHysteresis > 0.5f))
+	{
+		return true;
+	}
+	else
+	{
+		StreamingHysteresis = NewStreamingHysteresis;
+
+		return false;
+	}
 }
 
 bool AFWGen::SetGenerationFrequency(float NewGenerationFrequency)
@@ -1690,6 +2839,114 @@ void AFWGen::SetInvertWorld(bool Invertworld)
 	this->InvertWorld = Invertworld;
 }
 
+void AFWGen::SetSinglePrecisionGeneration(bool NewSinglePrecisionGeneration)
+{
+	SinglePrecisionGeneration = NewSinglePrecisionGeneration;
+}
+
+void AFWGen::SetGenerationNoiseType(EFWGNoiseType NewGenerationNoiseType)
+{
+	GenerationNoiseType = NewGenerationNoiseType;
+}
+
+bool AFWGen::SetMultiResolutionMaxError(float NewMultiResolutionMaxError)
+{
+	if (NewMultiResolutionMaxError < 0.0f)
+	{
+		return true;
+	}
+	else
+	{
+		MultiResolutionMaxError = NewMultiResolutionMaxError;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetDomainWarpStrength(float NewDomainWarpStrength)
+{
+	if (NewDomainWarpStrength < 0.0f)
+	{
+		return true;
+	}
+	else
+	{
+		DomainWarpStrength = NewDomainWarpStrength;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetDomainWarpFrequency(float NewDomainWarpFrequency)
+{
+	if (NewDomainWarpFrequency <= 0.0f)
+	{
+		return true;
+	}
+	else
+	{
+		DomainWarpFrequency = NewDomainWarpFrequency;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetBiomeFrequency(float NewBiomeFrequency)
+{
+	if (NewBiomeFrequency <= 0.0f)
+	{
+		return true;
+	}
+	else
+	{
+		BiomeFrequency = NewBiomeFrequency;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetBiomeHeightVariation(float NewBiomeHeightVariation)
+{
+	if ((NewBiomeHeightVariation > 1.0f) || (NewBiomeHeightVariation < 0.0f))
+	{
+		return true;
+	}
+	else
+	{
+		BiomeHeightVariation = NewBiomeHeightVariation;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetBiomeMaterialHeightShift(float NewBiomeMaterialHeightShift)
+{
+	if ((NewBiomeMaterialHeightShift > 1.0f) || (NewBiomeMaterialHeightShift < 0.0f))
+	{
+		return true;
+	}
+	else
+	{
+		BiomeMaterialHeightShift = NewBiomeMaterialHeightShift;
+
+		return false;
+	}
+}
+
+bool AFWGen::SetBiomeSpawnVariation(float NewBiomeSpawnVariation)
+{
+	if ((NewBiomeSpawnVariation > 1.0f) || (NewBiomeSpawnVariation < 0.0f))
+	{
+		return true;
+	}
+	else
+	{
+		BiomeSpawnVariation = NewBiomeSpawnVariation;
+
+		return false;
+	}
+}
+
 bool AFWGen::SetWorldSize(int32 NewWorldSize)
 {
 	if (NewWorldSize < -1)
@@ -1855,6 +3112,94 @@ void AFWGen::PostEditMove(bool bFinished)
 }
 #endif // WITH_EDITOR
 
+void AFWGen::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// The chunks the jobs have generated since the last frame.
+	while (std::shared_ptr<FWGChunkResult> pResult = pChunkJobs->getResult())
+	{
+		if (pResult->job.bPrefetch)
+		{
+			pPrefetcher->addResult(std::move(pResult));
+		}
+		else
+		{
+			vChunkCommits.push_back(std::move(pResult));
+		}
+	}
+
+	pollStreamingSource();
+	updatePrefetch();
+	updatePendingCollisions();
+
+
+	// Uploading a few meshes and spawning their objects in one frame is a hitch, so the commits are done
+	// step by step until ChunkCommitBudget is spent, the rest is done in the next frames.
+	// The time is checked between the steps, so the last step may go over the budget,
+	// and at least one step is done every frame, so a step longer than the budget does not stop the commits.
+
+	const double fStartTime = FPlatformTime::Seconds();
+	const double fBudget    = ChunkCommitBudget / 1000.0;
+
+	int32 iStepCount = 0;
+
+	while ((vChunkCommits.empty() == false) || (vCollisionUpdates.empty() == false) || (vLodUpdates.empty() == false))
+	{
+		if ((ChunkCommitBudget > 0.0f) && (iStepCount > 0) && ((FPlatformTime::Seconds() - fStartTime) >= fBudget))
+		{
+			break;
+		}
+
+		if (vCollisionUpdates.empty() == false)
+		{
+			// The chunks near the player first, they are already drawn.
+			AFWGChunk* pChunk = vCollisionUpdates.front().Get();
+
+			vCollisionUpdates.pop_front();
+
+			if (pChunk)
+			{
+				updateChunkCollision(pChunk, false);
+			}
+		}
+		else if (vLodUpdates.empty() == false)
+		{
+			// Resampled from the vertices the chunk has, no noise.
+			AFWGChunk* pChunk = vLodUpdates.front().Get();
+
+			vLodUpdates.pop_front();
+
+			// A commit of the chunk may have already meshed it with its level.
+			if (pChunk && (pChunk->iLodLevel != getChunkLodLevel(pChunk)))
+			{
+				updateChunkMesh(pChunk, false);
+			}
+		}
+		else if (commitChunkStep(*vChunkCommits.front()))
+		{
+			// Its arrays (the old arrays of the chunk) and its job are used by a next job.
+			pChunkJobs->recycleResult(std::move(vChunkCommits.front()));
+
+			vChunkCommits.pop_front();
+		}
+
+		iStepCount++;
+	}
+
+
+	const FWGChunkJobStats jobStats = pChunkJobs->getStats();
+
+	SET_DWORD_STAT(STAT_FWGChunkJobs, pChunkJobs->getJobCount());
+	SET_DWORD_STAT(STAT_FWGChunkJobsCancelled, jobStats.iCancelledJobCount);
+	SET_FLOAT_STAT(STAT_FWGChunkJobsSavedTime, static_cast<float>(jobStats.fSavedTime * 1000.0));
+	SET_DWORD_STAT(STAT_FWGChunkCommits, vChunkCommits.size());
+	SET_DWORD_STAT(STAT_FWGChunkCommitSteps, iStepCount);
+	SET_FLOAT_STAT(STAT_FWGChunkCommitTime, static_cast<float>((FPlatformTime::Seconds() - fStartTime) * 1000.0));
+	SET_FLOAT_STAT(STAT_FWGPrefetchHitRatio, pPrefetcher->getHitRatio());
+	SET_FLOAT_STAT(STAT_FWGPrefetchWasteRatio, pPrefetcher->getWasteRatio());
+}
+
 void AFWGen::BeginPlay()
 {
 	Super::BeginPlay();
@@ -1878,431 +3223,362 @@ void AFWGen::generateSeed()
 	}
 
 	iGeneratedSeed = seed;
-}
-
-float AFWGen::pickVertexMaterial(double height, std::uniform_real_distribution<float>* pUrd, std::mt19937_64* pRnd, float* pfLayerTypeWithoutRnd)
-{
-	std::uniform_real_distribution<float> urd_mat(0.005f, 1.0f);
-	std::uniform_int_distribution<int> urd_bool(0, 1);
 
+	// The context keeps the clamped octave count, an out of range value must not rebuild it every time.
+	const int32 iOctaves = FMath::Clamp(GenerationOctaves, 1, FWG_MAX_OCTAVES);
 
-	float fDiviation = (*pUrd)(*pRnd);
+	if ((pNoiseContext == nullptr) || (pNoiseContext->iSeed != seed) || (pNoiseContext->iOctaves != iOctaves)
+		|| (pNoiseContext->noiseType != GenerationNoiseType))
+	{
+		pNoiseContext = std::shared_ptr<const FWGNoiseContext>(new FWGNoiseContext(seed, GenerationOctaves, GenerationNoiseType));
+	}
+}
 
-	float fVertexColor = 0.0f; // apply first material to the vertex
+void AFWGen::createBiomeMap()
+{
+	// The cached regions depend on the noise and on the chunk size, so start from an empty map.
+	pBiomeMap = nullptr;
 
-	if ( (height >= (FirstMaterialMaxRelativeHeight + fDiviation)) 
-		&& (height <= (SecondMaterialMaxRelativeHeight + fDiviation)) )
+	if ((BiomeHeightVariation <= 0.0f) && (BiomeMaterialHeightShift <= 0.0f) && (BiomeSpawnVariation <= 0.0f))
 	{
-		fVertexColor = 0.5f; // apply second material to the vertex
+		return;
+	}
 
-		if (pfLayerTypeWithoutRnd)
-		{
-			*pfLayerTypeWithoutRnd = fVertexColor;
-		}
+	// Same noise coordinates as FWGChunkGenerator::generate(): a chunk is GenerationFrequency wide,
+	// the corner (0, 0) of the chunk (0, 0) is half a chunk away from the actor.
 
-		float fFirstProb = urd_mat(*pRnd);
-		float fThirdProb  = urd_mat(*pRnd);
+	const double fx = (ChunkPieceColumnCount * ChunkPieceSizeX) / GenerationFrequency;
+	const double fy = (ChunkPieceRowCount    * ChunkPieceSizeY) / GenerationFrequency;
 
-		bool bPickFirst = false, bPickThird = false;
+	const double fOriginX = (GetActorLocation().X - ChunkPieceColumnCount * ChunkPieceSizeX / 2.0) / fx;
+	const double fOriginY = (GetActorLocation().Y - ChunkPieceRowCount    * ChunkPieceSizeY / 2.0) / fy;
 
-		if (fFirstProb <= FirstMaterialOnSecondProbability)
-		{
-			bPickFirst = true;
-		}
+	pBiomeMap = std::make_shared<FWGBiomeMap>(pNoiseContext, fOriginX, fOriginY, GenerationFrequency, GenerationFrequency,
+		BiomeFrequency, BiomeHeightVariation, BiomeMaterialHeightShift, BiomeSpawnVariation);
+}
 
-		if (fThirdProb <= ThirdMaterialOnSecondProbability)
-		{
-			bPickThird = true;
-		}
+AFWGChunk* AFWGen::generateChunk(long long iX, long long iY, int32 iSectionIndex, bool bAroundCenter)
+{
+	// Create chunk.
 
-		if (bPickFirst && bPickThird)
-		{
-			if (urd_bool(*pRnd))
-			{
-				// Pick Third
-				fVertexColor = 1.0f; // apply third material to the vertex
-			}
-			else
-			{
-				// Pick First
-				fVertexColor = 0.0f; // apply first material to the vertex
-			}
-		}
-		else
-		{
-			if (bPickFirst)
-			{
-				fVertexColor = 0.0f; // apply first material to the vertex
-			}
+	// You don't want to use NewObject for Actors (only UObjects).
+	//AFWGChunk* pNewChunk = NewObject<AFWGChunk>(GetTransientPackage(), MakeUniqueObjectName(this, AFWGChunk::StaticClass(), "Chunk_"));
+	FActorSpawnParameters params;
+	params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
-			if (bPickThird)
-			{
-				fVertexColor = 1.0f; // apply third material to the vertex
-			}
-		}
-	}
-	else if (height >= (SecondMaterialMaxRelativeHeight + fDiviation))
-	{
-		fVertexColor = 1.0f; // apply third material to the vertex
+	AFWGChunk* pNewChunk = GetWorld()->SpawnActor<AFWGChunk>(AFWGChunk::StaticClass(), FTransform(FRotator(0, 0, 0), FVector(0, 0, 0), FVector(1, 1, 1)), params);
+	pNewChunk->setInit(iX, iY, iSectionIndex, bAroundCenter);
+	pNewChunk->setChunkSize(DivideChunkXCount, DivideChunkYCount);
+	pNewChunk->setChunkMap(pChunkMap);
 
-		if (pfLayerTypeWithoutRnd)
-		{
-			*pfLayerTypeWithoutRnd = fVertexColor;
-		}
 
-		float fFirstProb  = urd_mat(*pRnd);
-		float fSecondProb = urd_mat(*pRnd);
 
-		bool bPickFirst = false, bPickSecond = false;
+	// Generation, on this thread: the world is ready when GenerateWorld() returns.
 
-		if (fFirstProb <= FirstMaterialOnThirdProbability)
-		{
-			bPickFirst = true;
-		}
+	const int32 iCorrectedRowCount    = pChunkGenerator->ChunkPieceRowCount + 1;
+	const int32 iCorrectedColumnCount = pChunkGenerator->ChunkPieceColumnCount + 1;
 
-		if (fSecondProb <= SecondMaterialOnThirdProbability)
-		{
-			bPickSecond = true;
-		}
+	FWGChunkData data;
 
-		if (bPickFirst && bPickSecond)
-		{
-			if (urd_bool(*pRnd))
-			{
-				// Pick Third
-				fVertexColor = 0.5f; // apply second material to the vertex
-			}
-			else
-			{
-				// Pick First
-				fVertexColor = 0.0f; // apply first material to the vertex
-			}
-		}
-		else
-		{
-			if (bPickFirst)
-			{
-				fVertexColor = 0.0f; // apply first material to the vertex
-			}
+	pChunkGenerator->generate(data, iX, iY, pChunkMap->pBorderCache->getBorder(iX, iY, iCorrectedRowCount, iCorrectedColumnCount));
 
-			if (bPickSecond)
-			{
-				fVertexColor = 0.5f; // apply second material to the vertex
-			}
-		}
-	}
-	else
-	{
-		// first material
+	pNewChunk->setMeshData(data);
 
-		fVertexColor = 0.0f;
+	pChunkMap->pBorderCache->addChunk(pNewChunk, iCorrectedRowCount, iCorrectedColumnCount);
 
-		if (pfLayerTypeWithoutRnd)
-		{
-			*pfLayerTypeWithoutRnd = fVertexColor;
-		}
+	// The mesh section is created by the caller (see updateChunkMesh()).
 
-		float fSecondProb = urd_mat(*pRnd);
-		float fThirdProb  = urd_mat(*pRnd);
+	return pNewChunk;
+}
 
-		bool bPickSecond = false, bPickThird = false;
+void AFWGen::requestChunk(AFWGChunk* pChunk)
+{
+	const float fPriority = FWGChunkJobQueue::getPriority(pChunk->iX, pChunk->iY, pChunkMap->getCentralChunkX(), pChunkMap->getCentralChunkY());
 
-		if (fSecondProb <= SecondMaterialOnFirstProbability)
-		{
-			bPickSecond = true;
-		}
+	if (PrefetchLookahead > 0.0f)
+	{
+		bool bPrefetched = false;
 
-		if (fThirdProb <= ThirdMaterialOnFirstProbability)
-		{
-			bPickThird = true;
-		}
+		std::shared_ptr<FWGChunkResult> pResult = pPrefetcher->takeResult(pChunk->iX, pChunk->iY, pChunkGenerator.get());
 
-		if (bPickSecond && bPickThird)
+		if (pResult)
 		{
-			if (urd_bool(*pRnd))
-			{
-				// Pick Third
-				fVertexColor = 1.0f; // apply third material to the vertex
-			}
-			else
-			{
-				// Pick Second
-				fVertexColor = 0.5f; // apply second material to the vertex
-			}
+			// Committed by the next Tick(), the border of the neighbours committed since the prefetch is copied then.
+			pChunkJobs->cancelJobs(pChunk);
+
+			pResult->job.pChunk    = pChunk;
+			pResult->job.iRequest  = pChunk->iLoadRequest;
+			pResult->job.bPrefetch = false;
+
+			vChunkCommits.push_back(std::move(pResult));
+
+			bPrefetched = true;
 		}
 		else
 		{
-			if (bPickSecond)
-			{
-				fVertexColor = 0.5f; // apply second material to the vertex
-			}
+			bPrefetched = pChunkJobs->adoptJob(pChunk->iX, pChunk->iY, pChunkGenerator.get(), pChunk, pChunk->iLoadRequest, fPriority);
+		}
 
-			if (bPickThird)
-			{
-				fVertexColor = 1.0f; // apply third material to the vertex
-			}
+		pPrefetcher->addLoad(bPrefetched);
+
+		if (bPrefetched)
+		{
+			return;
 		}
 	}
 
-	return fVertexColor;
+	const int32 iCorrectedRowCount    = pChunkGenerator->ChunkPieceRowCount + 1;
+	const int32 iCorrectedColumnCount = pChunkGenerator->ChunkPieceColumnCount + 1;
+
+	std::shared_ptr<FWGChunkResult> pJob = pChunkJobs->newJob(pChunkMap->pBorderCache->getBorder(pChunk->iX, pChunk->iY, iCorrectedRowCount, iCorrectedColumnCount));
+
+	FWGChunkJob& job = pJob->job;
+	job.pChunk     = pChunk;
+	job.iRequest   = pChunk->iLoadRequest;
+	job.iX         = pChunk->iX;
+	job.iY         = pChunk->iY;
+	job.fPriority  = fPriority;
+	job.pGenerator = pChunkGenerator;
+
+	pChunkJobs->addJob(std::move(pJob));
 }
 
-AFWGChunk* AFWGen::generateChunk(long long iX, long long iY, int32 iSectionIndex, bool bAroundCenter,
-	long long iUnloadX, long long iUnloadY, bool bUnload)
+void AFWGen::pollStreamingSource()
 {
-	// Generation setup
+	if (UseTriggerBoxes || (WorldSize == -1) || (bWorldCreated == false) || (pChunkGenerator == nullptr))
+	{
+		return;
+	}
 
-	uint32_t seed = iGeneratedSeed;
+	AActor* pSource = getStreamingSource();
 
+	if (pSource == nullptr)
+	{
+		return;
+	}
 
+	const FVector vLocation = pSource->GetActorLocation();
 
-	// We ++ here because we start to make polygons from 2nd row
-	int32 iCorrectedRowCount = ChunkPieceRowCount + 1;
-	int32 iCorrectedColumnCount = ChunkPieceColumnCount + 1;
 
+	// Location in chunks from the corner of the chunk (0, 0) (it is centered on the actor),
+	// the integer part is the chunk the source is in.
 
+	const double fChunkXSize = pChunkGenerator->ChunkPieceColumnCount * pChunkGenerator->ChunkPieceSizeX;
+	const double fChunkYSize = pChunkGenerator->ChunkPieceRowCount    * pChunkGenerator->ChunkPieceSizeY;
 
+	const double fX = (vLocation.X - pChunkGenerator->vActorLocation.X) / fChunkXSize + 0.5;
+	const double fY = (vLocation.Y - pChunkGenerator->vActorLocation.Y) / fChunkYSize + 0.5;
 
-	// Perlin Noise setup
+	const long long iCentralX = pChunkMap->getCentralChunkX();
+	const long long iCentralY = pChunkMap->getCentralChunkY();
 
-	const siv::PerlinNoise perlinNoise(seed);
-	const double fx = ((iCorrectedColumnCount - 1) * ChunkPieceSizeX) / GenerationFrequency;
-	const double fy = ((iCorrectedRowCount - 1) * ChunkPieceSizeY) / GenerationFrequency;
+	// The central chunk is changed only when the source is StreamingHysteresis chunks past its border,
+	// so walking along the border does not load and unload the same chunks again and again.
+	if ((fX >= iCentralX - StreamingHysteresis) && (fX < iCentralX + 1 + StreamingHysteresis)
+		&& (fY >= iCentralY - StreamingHysteresis) && (fY < iCentralY + 1 + StreamingHysteresis))
+	{
+		return;
+	}
 
+	pChunkMap->moveCentralChunk(static_cast<long long>(FMath::FloorToDouble(fX)), static_cast<long long>(FMath::FloorToDouble(fY)));
+}
 
+AActor* AFWGen::getStreamingSource() const
+{
+	if (pStreamingSource.IsValid())
+	{
+		return pStreamingSource.Get();
+	}
 
+	APlayerController* pController = GetWorld()->GetFirstPlayerController();
 
-	// Prepare chunk coordinates
+	if (pController)
+	{
+		return pController->GetPawn();
+	}
 
-	float fChunkX = GetActorLocation().X;
-	float fChunkY = GetActorLocation().Y;
+	return nullptr;
+}
 
-	if (iX != 0)
-	{
-		// Left or right chunk
+void AFWGen::updatePrefetch()
+{
+	AActor* pSource = getStreamingSource();
 
-		fChunkX += (iX * ChunkPieceColumnCount * ChunkPieceSizeX);
-	}
-	
-	if (iY != 0)
+	if ((PrefetchLookahead <= 0.0f) || (WorldSize == -1) || (bWorldCreated == false) || (pChunkGenerator == nullptr) || (pSource == nullptr))
 	{
-		// Top or bottom chunk
+		pPrefetcher->clearPath();
 
-		fChunkY += (iY * ChunkPieceRowCount * ChunkPieceSizeY);
+		return;
 	}
 
+	pPrefetcher->addPathPoint(pSource->GetActorLocation(), GetWorld()->GetTimeSeconds());
 
+	const FVector vPredictedLocation = pPrefetcher->predictLocation(pSource->GetVelocity(), PrefetchLookahead);
 
 
-	// Generation params
+	// The chunk (0, 0) is centered on the actor.
 
-	float fStartX = fChunkX - ((iCorrectedColumnCount - 1) * ChunkPieceSizeX) / 2;
-	float fStartY = fChunkY - ((iCorrectedRowCount    - 1) * ChunkPieceSizeY) / 2;
+	const double fChunkXSize = pChunkGenerator->ChunkPieceColumnCount * pChunkGenerator->ChunkPieceSizeX;
+	const double fChunkYSize = pChunkGenerator->ChunkPieceRowCount    * pChunkGenerator->ChunkPieceSizeY;
 
-	FVector vPrevLocation(fStartX, fStartY, GetActorLocation().Z);
+	const long long iPredictedX = static_cast<long long>(FMath::FloorToDouble((vPredictedLocation.X - pChunkGenerator->vActorLocation.X) / fChunkXSize + 0.5));
+	const long long iPredictedY = static_cast<long long>(FMath::FloorToDouble((vPredictedLocation.Y - pChunkGenerator->vActorLocation.Y) / fChunkYSize + 0.5));
 
+	const long long iCentralX = pChunkMap->getCentralChunkX();
+	const long long iCentralY = pChunkMap->getCentralChunkY();
 
+	const long long iStepX = (iPredictedX > iCentralX) ? 1 : ((iPredictedX < iCentralX) ? -1 : 0);
+	const long long iStepY = (iPredictedY > iCentralY) ? 1 : ((iPredictedY < iCentralY) ? -1 : 0);
 
+	// The central chunk does not move to the last chunks of the world (see FWGenChunkMap::setCurrentChunk()).
+	const bool bCanMoveX = (iStepX != 0) && ((WorldSize == 0) || (abs(iCentralX + iStepX) < WorldSize));
+	const bool bCanMoveY = (iStepY != 0) && ((WorldSize == 0) || (abs(iCentralY + iStepY) < WorldSize));
 
-	// Create chunk.
 
-	AFWGChunk* pNewChunk = nullptr;
+	// The ring loaded when the central chunk moves one chunk that way.
 
-	if (bUnload == false)
+	if (bCanMoveX)
 	{
-		// You don't want to use NewObject for Actors (only UObjects).
-		//AFWGChunk* pNewChunk = NewObject<AFWGChunk>(GetTransientPackage(), MakeUniqueObjectName(this, AFWGChunk::StaticClass(), "Chunk_"));
-		FActorSpawnParameters params;
-		params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-		pNewChunk = GetWorld()->SpawnActor<AFWGChunk>(AFWGChunk::StaticClass(), FTransform(FRotator(0, 0, 0), FVector(0, 0, 0), FVector(1, 1, 1)), params);
-		pNewChunk->setInit(iX, iY, iSectionIndex, bAroundCenter);
-		pNewChunk->setChunkSize(DivideChunkXCount, DivideChunkYCount);
-		pNewChunk->setChunkMap(pChunkMap);
+		for (long long y = iCentralY - ViewDistance; y <= iCentralY + ViewDistance; y++)
+		{
+			prefetchChunk(iCentralX + iStepX * (ViewDistance + 1), y);
+		}
 	}
-	else
+
+	if (bCanMoveY)
 	{
-		for (size_t i = 0; i < pChunkMap->vChunks.size(); i++)
+		for (long long x = iCentralX - ViewDistance; x <= iCentralX + ViewDistance; x++)
 		{
-			if (pChunkMap->vChunks[i]->iX == iUnloadX
-				&& pChunkMap->vChunks[i]->iY == iUnloadY)
-			{
-				pNewChunk = pChunkMap->vChunks[i];
-
-				pNewChunk->setUpdate(iX, iY, bAroundCenter);
-				pNewChunk->setChunkSize(DivideChunkXCount, DivideChunkYCount);
-
-				iSectionIndex = pNewChunk->iSectionIndex;
-
-				break;
-			}
+			prefetchChunk(x, iCentralY + iStepY * (ViewDistance + 1));
 		}
 	}
+}
 
+void AFWGen::prefetchChunk(long long iX, long long iY)
+{
+	if (pPrefetcher->hasResult(iX, iY) || pChunkJobs->hasJob(iX, iY))
+	{
+		return;
+	}
 
+	const int32 iCorrectedRowCount    = pChunkGenerator->ChunkPieceRowCount + 1;
+	const int32 iCorrectedColumnCount = pChunkGenerator->ChunkPieceColumnCount + 1;
 
-	// Prepare random for vectex color
-
-	std::mt19937_64 rnd(iGeneratedSeed);
-	std::uniform_real_distribution<float> urd(-MaterialHeightMaxDeviation, MaterialHeightMaxDeviation);
-
+	std::shared_ptr<FWGChunkResult> pJob = pChunkJobs->newJob(pChunkMap->pBorderCache->getBorder(iX, iY, iCorrectedRowCount, iCorrectedColumnCount));
 
-	// Generation
+	FWGChunkJob& job = pJob->job;
+	job.iRequest   = 0;
+	job.iX         = iX;
+	job.iY         = iY;
+	job.fPriority  = FWGChunkJobQueue::getPriority(iX, iY, pChunkMap->getCentralChunkX(), pChunkMap->getCentralChunkY());
+	job.bPrefetch  = true;
+	job.pGenerator = pChunkGenerator;
 
-	float fMaxGeneratedZ = GetActorLocation().Z;
-	size_t iMaxGeneratedZIndex = 0;
+	pChunkJobs->addJob(std::move(pJob));
+}
 
-	for (int32 i = 0; i < iCorrectedRowCount; i++)
+bool AFWGen::commitChunkStep(FWGChunkResult& result)
+{
+	if (result.job.pHorizon)
 	{
-		for (int32 j = 0; j < iCorrectedColumnCount; j++)
+		// One step: a horizon chunk has no collision and no objects.
+		// The ring of the job is gone if the world was generated again, or the chunk was moved again before the job finished.
+		if ((result.job.pHorizon == pHorizon) && (pHorizon->vChunks[result.job.iHorizonChunk].iLoadRequest == result.job.iRequest))
 		{
-			// Generate vertex
-			double generatedValue = perlinNoise.octaveNoise0_1(vPrevLocation.X / fx, vPrevLocation.Y / fy, GenerationOctaves);
-
-			if (generatedValue > TerrainCutHeightFromActorZ)
-			{
-				generatedValue = TerrainCutHeightFromActorZ;
-			}
-
-			if (InvertWorld)
-			{
-				generatedValue = 1.0 - generatedValue;
-			}
-
-
-			pNewChunk->vNormals      .Add(FVector(0, 0, 1.0f));
-			pNewChunk->vUV0          .Add(FVector2D(i, j));
-			pNewChunk->vTangents     .Add(FProcMeshTangent(0.0f, 1.0f, 0.0f));
-
+			commitHorizonChunk(pHorizon->vChunks[result.job.iHorizonChunk], result.data);
+		}
 
+		return true;
+	}
 
-			// Set vertex Z
+	AFWGChunk* pChunk = result.job.pChunk.Get();
 
-			// Here return value from perlinNoise.octaveNoise0_1 can be
-			// 0    , but should be   GetActorLocation().Z
-			// ...  , but should be   value from interval [GetActorLocation().Z; GenerationMaxZFromActorZ]
-			// 1    , but should be   GenerationMaxZFromActorZ
+	// The world was generated again or the chunk was moved again before the job finished
+	// (or between the steps, then the commit of the new job does the rest).
+	if ((pChunk == nullptr) || (pChunk->iLoadRequest != result.job.iRequest))
+	{
+		return true;
+	}
 
-			vPrevLocation.Z = GetActorLocation().Z + (GenerationMaxZFromActorZ * generatedValue);
 
-			if (vPrevLocation.Z > fMaxGeneratedZ)
+	if (result.commitStep == EFWGCommitStep::Mesh)
+	{
+		// Unload old actors.
+		if (pCallbackToDespawn)
+		{
+			struct params
 			{
-				fMaxGeneratedZ = vPrevLocation.Z;
-				iMaxGeneratedZIndex = pNewChunk->vVertices.Num();
-			}
-
-			pNewChunk->vVertices .Add (vPrevLocation);
+				int64 x;
+				int64 y;
+			};
 
+			params p;
+			p.x = pChunk->iMeshX;
+			p.y = pChunk->iMeshY;
 
+			pCallbackToDespawn->pOwner->ProcessEvent(pCallbackToDespawn->pFunction, &p);
+		}
 
-			// Set "material" to vertex
 
-			float fAlphaColor = 0.0f;
+		pChunk->setChunkSize(DivideChunkXCount, DivideChunkYCount);
+		// result.data gets the old arrays of the chunk, a next job fills them (see FWGChunkJobQueue::recycleResult()).
+		pChunk->setMeshData(result.data);
 
-			float fAlphaColorWithoutRnd = 0.0f;
+		const int32 iCorrectedRowCount    = result.job.pGenerator->ChunkPieceRowCount + 1;
+		const int32 iCorrectedColumnCount = result.job.pGenerator->ChunkPieceColumnCount + 1;
 
-			if (SecondMaterialUnderWater && (generatedValue < (ZWaterLevelInWorld + 0.005f)))
-			{
-				fAlphaColor = 0.5f;
-				fAlphaColorWithoutRnd = 0.5f;
-			}
-			else
-			{
-				if ((i == 0) || (i == iCorrectedRowCount - 1) || (j == 0) || (j == iCorrectedColumnCount - 1))
-				{
-					pickVertexMaterial(generatedValue, &urd, &rnd, &fAlphaColorWithoutRnd);
-					fAlphaColor = fAlphaColorWithoutRnd;
-				}
-				else
-				{
-					fAlphaColor = pickVertexMaterial(generatedValue, &urd, &rnd, &fAlphaColorWithoutRnd);
-				}
-			}
+		// The neighbours committed after the job was added generated their common vertices too, theirs are used.
+		pChunkMap->pBorderCache->getBorder(pChunk->iX, pChunk->iY, iCorrectedRowCount, iCorrectedColumnCount).copyTo(pChunk);
 
-			pNewChunk->vVertexColors .Add(FLinearColor(0.0f, 0.0f, 0.0f, fAlphaColor));
+		pChunkMap->pBorderCache->addChunk(pChunk, iCorrectedRowCount, iCorrectedColumnCount);
 
-			if (areEqual(fAlphaColorWithoutRnd, 0.0f, 0.1f))
-			{
-				// First Layer
+		// Update mesh.
+		updateChunkMesh(pChunk, false);
 
-				pNewChunk->vLayerIndex.push_back(1);
-			}
-			else if (areEqual(fAlphaColorWithoutRnd, 0.5f, 0.1f))
-			{
-				// Second Layer
-				pNewChunk->vLayerIndex.push_back(2);
-			}
-			else
-			{
-				// Third Layer
-				pNewChunk->vLayerIndex.push_back(3);
-			}
 
 
+		// Move Water Plane.
 
-			vPrevLocation.X += ChunkPieceSizeX;
+		float fX = GetActorLocation().X;
+		float fY = GetActorLocation().Y;
 
-			if (i != 0)
-			{
-				//     j = 0,   1,   2,   3  ...
-				// i = 0:  +----+----+----+- ...
-				//         |   /|   /|   /|
-				//         |  / |  / |  / |
-				//         | /  | /  | /  |
-				// i = 1:  +----+----+----+- ...
+		if (pChunk->iX != 0)
+		{
+			fX += (pChunk->iX * ChunkPieceColumnCount * ChunkPieceSizeX);
+		}
 
-				int32 iFirstIndexInRow = (i - 1) * iCorrectedColumnCount;
+		if (pChunk->iY != 0)
+		{
+			fY += (pChunk->iY * ChunkPieceRowCount * ChunkPieceSizeY);
+		}
 
-				if (j == 0)
-				{
-					// Add triangle #1
-					pNewChunk->vTriangles.Add(iFirstIndexInRow + j);
-					pNewChunk->vTriangles.Add(i * iCorrectedColumnCount + j);
-					pNewChunk->vTriangles.Add(iFirstIndexInRow + j + 1);
-				}
-				else
-				{
-					// Add triangle #2
-					pNewChunk->vTriangles.Add(iFirstIndexInRow + j);
-					pNewChunk->vTriangles.Add(i * iCorrectedColumnCount + j - 1);
-					pNewChunk->vTriangles.Add(i * iCorrectedColumnCount + j);
 
-					if (j < (iCorrectedColumnCount - 1))
-					{
-						// Add triangle #1
-						pNewChunk->vTriangles.Add(iFirstIndexInRow + j);
-						pNewChunk->vTriangles.Add(i * iCorrectedColumnCount + j);
-						pNewChunk->vTriangles.Add(iFirstIndexInRow + j + 1);
-					}
-				}
-			}
-		}
+		WaterPlane->SetWorldLocation(FVector(
+			fX,
+			fY,
+			GetActorLocation().Z + (GenerationMaxZFromActorZ * ZWaterLevelInWorld)
+		));
 
-		vPrevLocation.Set(fStartX, vPrevLocation.Y + ChunkPieceSizeY, GetActorLocation().Z);
-	}
+		createTriggerBoxForChunk(pChunk);
 
-	pNewChunk->iMaxZVertexIndex = iMaxGeneratedZIndex;
+		result.commitStep = EFWGCommitStep::Collision;
 
-	if (bUnload == false)
+		return false;
+	}
+	else if (result.commitStep == EFWGCommitStep::Collision)
 	{
-		pProcMeshComponent->CreateMeshSection_LinearColor(iSectionIndex, pNewChunk->vVertices, pNewChunk->vTriangles, pNewChunk->vNormals,
-			pNewChunk->vUV0, pNewChunk->vVertexColors, pNewChunk->vTangents, true);
+		updateChunkCollision(pChunk, true);
 
-		// Set material
-		if (GroundMaterial)
-		{
-			pProcMeshComponent->SetMaterial(iSectionIndex, GroundMaterial);
-		}
+		result.commitStep = EFWGCommitStep::Spawn;
 
-		pNewChunk->setMeshSection(pProcMeshComponent->GetProcMeshSection(iSectionIndex));
+		return false;
 	}
 	else
 	{
-		pProcMeshComponent->UpdateMeshSection_LinearColor(iSectionIndex, pNewChunk->vVertices, pNewChunk->vNormals, 
-			pNewChunk->vUV0, pNewChunk->vVertexColors, pNewChunk->vTangents);
-	}
+		spawnObjects(pChunk);
 
-	return pNewChunk;
+		return true;
+	}
 }
 
 #if !UE_BUILD_SHIPPING
@@ -2352,19 +3628,6 @@ bool AFWGen::areEqual(float a, float b, float eps)
 	return fabs(a - b) < eps;
 }
 
-void AFWGen::compareHeightDifference(AFWGChunk* pChunk, std::vector<bool>& vProcessedVertices, float& fCurrentZ, size_t iCompareToIndex, float& fSteepSlopeMinHeightDiff)
-{
-	if (vProcessedVertices[iCompareToIndex] == false)
-	{
-		if (fabs(pChunk->vVertices[iCompareToIndex].Z - fCurrentZ) > fSteepSlopeMinHeightDiff)
-		{
-			pChunk->vVertexColors[iCompareToIndex] = FLinearColor(0.0f, 0.0f, 0.0f, 0.5f);
-		}
-
-		vProcessedVertices[iCompareToIndex] = true;
-	}
-}
-
 void AFWGen::SetSecondMaterialUnderWater(bool NewSecondMaterialUnderWater)
 {
 	SecondMaterialUnderWater = NewSecondMaterialUnderWater;
@@ -2468,6 +3731,8 @@ FWGenChunkMap::FWGenChunkMap(AFWGen* pGen)
 {
 	pCurrentChunk = nullptr;
 	this->pGen    = pGen;
+
+	pBorderCache  = new FWGChunkBorderCache();
 }
 
 void FWGenChunkMap::loadNewChunk(long long iLoadX, long long iLoadY, long long iUnloadX, long long iUnloadY)
@@ -2482,69 +3747,35 @@ void FWGenChunkMap::loadNewChunk(long long iLoadX, long long iLoadY, long long i
 		}
 
 
-		// Unload old actors.
-		if (pGen->pCallbackToDespawn)
-		{
-			struct params
-			{
-				int64 x;
-				int64 y;
-			};
-
-			params p;
-			p.x = iUnloadX;
-			p.y = iUnloadY;
-
-			pGen->pCallbackToDespawn->pOwner->ProcessEvent( pGen->pCallbackToDespawn->pFunction, &p);
-		}
-
+		// The unloaded chunk is generated again for the new coordinates.
 
-		AFWGChunk* pNewChunk = pGen->generateChunk(iLoadX, iLoadY, pGen->iCurrentSectionIndex, bAroundCenter, iUnloadX, iUnloadY, true);
+		AFWGChunk* pChunk = nullptr;
 
-		if (pGen->ApplyGroundMaterialBlend)
+		for (size_t i = 0; i < vChunks.size(); i++)
 		{
-			pGen->blendWorldMaterialsMore(pNewChunk);
-		}
+			if ((vChunks[i]->iX == iUnloadX) && (vChunks[i]->iY == iUnloadY))
+			{
+				pChunk = vChunks[i];
 
-		if (pGen->ApplySlopeDependentBlend)
-		{
-			pGen->applySlopeDependentBlend(pNewChunk);
+				break;
+			}
 		}
 
-		// Update mesh.
-		pGen->pProcMeshComponent->UpdateMeshSection_LinearColor(pNewChunk->iSectionIndex, pNewChunk->vVertices, pNewChunk->vNormals,
-			pNewChunk->vUV0, pNewChunk->vVertexColors, pNewChunk->vTangents);
-
-
-
-		// Move Water Plane.
-
-		float fX = pGen->GetActorLocation().X;
-		float fY = pGen->GetActorLocation().Y;
-
-		if (iLoadX != 0)
+		if (pChunk == nullptr)
 		{
-			fX += (iLoadX * pGen->ChunkPieceColumnCount * pGen->ChunkPieceSizeX);
-		}
-		
-		if (iLoadY != 0)
-		{
-			fY += (iLoadY * pGen->ChunkPieceRowCount * pGen->ChunkPieceSizeY);
+			return;
 		}
 
+		pChunk->setUpdate(iLoadX, iLoadY, bAroundCenter);
 
-		pGen->WaterPlane->SetWorldLocation(FVector(
-			fX,
-			fY,
-			pGen->GetActorLocation().Z + (pGen->GenerationMaxZFromActorZ * pGen->ZWaterLevelInWorld)
-		));
-
+		// Its trigger box stays where its mesh is until the new mesh is committed (see createTriggerBoxForChunk()).
+		pChunk->pTriggerBox->SetGenerateOverlapEvents(false);
 
-		// Do last steps.
+		// The edges of the unloaded chunk are not needed anymore.
+		pBorderCache->removeUnused(vChunks);
 
-		pGen->spawnObjects(pNewChunk);
-
-		pGen->createTriggerBoxForChunk(pNewChunk);
+		// Generated on the thread pool, AFWGen::Tick() commits it.
+		pGen->requestChunk(pChunk);
 	}
 }
 
@@ -2553,7 +3784,7 @@ void FWGenChunkMap::addChunk(AFWGChunk* pChunk)
 	vChunks.push_back(pChunk);
 }
 
-void FWGenChunkMap::clearWorld(UProceduralMeshComponent* pProcMeshComponent)
+void FWGenChunkMap::clearWorld()
 {
 	for (size_t i = 0; i < vChunks.size(); i++)
 	{
@@ -2573,95 +3804,202 @@ void FWGenChunkMap::clearWorld(UProceduralMeshComponent* pProcMeshComponent)
 
 	vChunks.clear();
 
-	pProcMeshComponent->ClearAllMeshSections();
+	pGen->bWorldCreated = false;
+
+	pBorderCache->clear();
+
+	// Their chunks are destroyed.
+	pGen->pChunkJobs->clear();
+
+	for (size_t i = 0; i < pGen->vChunkCommits.size(); i++)
+	{
+		pGen->pChunkJobs->recycleResult(std::move(pGen->vChunkCommits[i]));
+	}
+
+	pGen->vChunkCommits.clear();
+	pGen->vCollisionUpdates.clear();
+	pGen->vLodUpdates.clear();
+	pGen->pPrefetcher->clear();
+
+	for (int32 i = 0; i < pGen->vCollisionComponents.Num(); i++)
+	{
+		pGen->vCollisionComponents[i]->ClearAllMeshSections();
+	}
+
+	for (int32 i = 0; i < pGen->vTerrainComponents.Num(); i++)
+	{
+		pGen->vTerrainComponents[i]->clearMesh();
+	}
+
+	for (int32 i = 0; i < pGen->vHeightfieldComponents.Num(); i++)
+	{
+		pGen->vHeightfieldComponents[i]->setHeightfield(nullptr);
+	}
 }
 
-void FWGenChunkMap::setCurrentChunk(AFWGChunk* pChunk)
+void FWGenChunkMap::setCurrentChunk(AFWGChunk* pChunk, AActor* pSource)
 {
+	if (pSource)
+	{
+		pGen->pStreamingSource = pSource;
+	}
+
 	if (pCurrentChunk)
 	{
-		if (pGen->WorldSize > 0)
+		moveCentralChunk(pChunk->iX, pChunk->iY);
+	}
+	else
+	{
+		pCurrentChunk = pChunk;
+	}
+}
+
+void FWGenChunkMap::moveCentralChunk(long long iNewX, long long iNewY)
+{
+	if (pCurrentChunk == nullptr)
+	{
+		return;
+	}
+
+	if (pGen->WorldSize > 0)
+	{
+		// The last chunks of the world are never central (the loaded chunks would go past them).
+		iNewX = FMath::Clamp(iNewX, 1 - static_cast<long long>(pGen->WorldSize), static_cast<long long>(pGen->WorldSize) - 1);
+		iNewY = FMath::Clamp(iNewY, 1 - static_cast<long long>(pGen->WorldSize), static_cast<long long>(pGen->WorldSize) - 1);
+	}
+
+	long long offsetX = iNewX - pCurrentChunk->iX;
+	long long offsetY = iNewY - pCurrentChunk->iY;
+
+	if (offsetX == 0 && offsetY == 0)
+	{
+		return;
+	}
+
+	// The chunks of the square around the new central chunk that are not loaded take the places of the loaded chunks
+	// that are out of it (any move: along an axis, diagonal or over many chunks).
+
+	const long long iViewDistance = pGen->ViewDistance;
+
+	auto isInView = [&](long long iX, long long iY)
+	{
+		return (abs(iX - iNewX) <= iViewDistance) && (abs(iY - iNewY) <= iViewDistance);
+	};
+
+	std::vector<std::pair<long long, long long>> vLoad;
+	std::vector<std::pair<long long, long long>> vUnload;
+
+	for (size_t i = 0; i < vChunks.size(); i++)
+	{
+		if (isInView(vChunks[i]->iX, vChunks[i]->iY) == false)
 		{
-			long long iMaxCoord = pGen->WorldSize;
+			vUnload.push_back(std::make_pair(vChunks[i]->iX, vChunks[i]->iY));
+		}
+	}
 
-			if (abs(pChunk->iX) == pGen->WorldSize || abs(pChunk->iY) == pGen->WorldSize)
+	for (long long y = iNewY - iViewDistance; y <= iNewY + iViewDistance; y++)
+	{
+		for (long long x = iNewX - iViewDistance; x <= iNewX + iViewDistance; x++)
+		{
+			if (getChunk(x, y) == nullptr)
 			{
-				return;
+				vLoad.push_back(std::make_pair(x, y));
 			}
 		}
+	}
 
-		long long offsetX = pChunk->iX - pCurrentChunk->iX;
-		long long offsetY = pChunk->iY - pCurrentChunk->iY;
+	// The closest chunks are loaded first (the central chunk first, if it was not loaded), they take the farthest ones.
 
-		if (offsetX != 0 && offsetY != 0)
-		{
-			return;
-		}
+	auto getDistance = [&](const std::pair<long long, long long>& chunk)
+	{
+		return FWGChunkJobQueue::getPriority(chunk.first, chunk.second, iNewX, iNewY);
+	};
 
-		float fChunkXSize = pGen->ChunkPieceColumnCount * pGen->ChunkPieceSizeX;
-		float fChunkYSize = pGen->ChunkPieceRowCount * pGen->ChunkPieceSizeY;
+	std::sort(vLoad.begin(), vLoad.end(), [&](const std::pair<long long, long long>& a, const std::pair<long long, long long>& b)
+	{
+		return getDistance(a) < getDistance(b);
+	});
 
-		mtxLoadChunks.lock();
+	std::sort(vUnload.begin(), vUnload.end(), [&](const std::pair<long long, long long>& a, const std::pair<long long, long long>& b)
+	{
+		return getDistance(a) > getDistance(b);
+	});
 
+	const size_t iLoadCount = FMath::Min(vLoad.size(), vUnload.size());
 
+	AFWGChunk* pNewCentralChunk = getChunk(iNewX, iNewY);
 
-		// Move blocking volumes.
+	if ((pNewCentralChunk == nullptr) && (iLoadCount > 0))
+	{
+		// Moved to the central chunk by the first load.
+		pNewCentralChunk = getChunk(vUnload[0].first, vUnload[0].second);
+	}
 
-		FVector volumeLocation = pGen->pBlockingVolumeX1->GetComponentLocation();
-		volumeLocation.X += offsetX * fChunkXSize;
-		volumeLocation.Y += offsetY * fChunkYSize;
-		pGen->pBlockingVolumeX1->SetWorldLocation(volumeLocation);
+	if (pNewCentralChunk == nullptr)
+	{
+		// ViewDistance was changed after GenerateWorld().
+		return;
+	}
 
-		volumeLocation = pGen->pBlockingVolumeX2->GetComponentLocation();
-		volumeLocation.X += offsetX * fChunkXSize;
-		volumeLocation.Y += offsetY * fChunkYSize;
-		pGen->pBlockingVolumeX2->SetWorldLocation(volumeLocation);
+	// The priorities of the chunk jobs are computed from the central chunk.
+	pCurrentChunk = pNewCentralChunk;
 
-		volumeLocation = pGen->pBlockingVolumeY1->GetComponentLocation();
-		volumeLocation.X += offsetX * fChunkXSize;
-		volumeLocation.Y += offsetY * fChunkYSize;
-		pGen->pBlockingVolumeY1->SetWorldLocation(volumeLocation);
+	float fChunkXSize = pGen->ChunkPieceColumnCount * pGen->ChunkPieceSizeX;
+	float fChunkYSize = pGen->ChunkPieceRowCount * pGen->ChunkPieceSizeY;
 
-		volumeLocation = pGen->pBlockingVolumeY2->GetComponentLocation();
-		volumeLocation.X += offsetX * fChunkXSize;
-		volumeLocation.Y += offsetY * fChunkYSize;
-		pGen->pBlockingVolumeY2->SetWorldLocation(volumeLocation);
+	// Move blocking volumes.
 
+	FVector volumeLocation = pGen->pBlockingVolumeX1->GetComponentLocation();
+	volumeLocation.X += offsetX * fChunkXSize;
+	volumeLocation.Y += offsetY * fChunkYSize;
+	pGen->pBlockingVolumeX1->SetWorldLocation(volumeLocation);
 
+	volumeLocation = pGen->pBlockingVolumeX2->GetComponentLocation();
+	volumeLocation.X += offsetX * fChunkXSize;
+	volumeLocation.Y += offsetY * fChunkYSize;
+	pGen->pBlockingVolumeX2->SetWorldLocation(volumeLocation);
 
-		long long iX = pChunk->iX + (offsetX * pGen->ViewDistance);
-		long long iY = pChunk->iY + (offsetY * pGen->ViewDistance);
+	volumeLocation = pGen->pBlockingVolumeY1->GetComponentLocation();
+	volumeLocation.X += offsetX * fChunkXSize;
+	volumeLocation.Y += offsetY * fChunkYSize;
+	pGen->pBlockingVolumeY1->SetWorldLocation(volumeLocation);
 
-		long long iUnloadX = pCurrentChunk->iX + (-offsetX * pGen->ViewDistance);
-		long long iUnloadY = pCurrentChunk->iY + (-offsetY * pGen->ViewDistance);
+	volumeLocation = pGen->pBlockingVolumeY2->GetComponentLocation();
+	volumeLocation.X += offsetX * fChunkXSize;
+	volumeLocation.Y += offsetY * fChunkYSize;
+	pGen->pBlockingVolumeY2->SetWorldLocation(volumeLocation);
 
-		pCurrentChunk = pChunk;
 
-		loadNewChunk(iX, iY, iUnloadX, iUnloadY);
 
+	for (size_t i = 0; i < iLoadCount; i++)
+	{
+		loadNewChunk(vLoad[i].first, vLoad[i].second, vUnload[i].first, vUnload[i].second);
+	}
 
-		// Generate other chunks.
+	// The jobs of the chunks that are now nearer run first, the jobs of the chunks out of the view distance are stopped.
+	pGen->pChunkJobs->updateJobs(iNewX, iNewY, pGen->ViewDistance);
 
-		for (int32 i = 1; i <= pGen->ViewDistance; i++)
-		{
-			if (offsetX == 0)
-			{
-				loadNewChunk(iX - i, iY, iUnloadX + i, iUnloadY);
-				loadNewChunk(iX + i, iY, iUnloadX - i, iUnloadY);
-			}
-			else if (offsetY == 0)
-			{
-				loadNewChunk(iX, iY - i, iUnloadX, iUnloadY + i);
-				loadNewChunk(iX, iY + i, iUnloadX, iUnloadY - i);
-			}
-		}
+	// The prefetched chunks the player turned away from.
+	pGen->pPrefetcher->removeFarResults(iNewX, iNewY, pGen->ViewDistance + 1);
 
-		mtxLoadChunks.unlock();
-	}
-	else
+	// The other chunks are now nearer or further from the central chunk.
+	pGen->updateChunkLods();
+	pGen->updateChunkCollisions();
+
+	pGen->updateHorizon();
+}
+
+AFWGChunk* FWGenChunkMap::getChunk(long long iX, long long iY) const
+{
+	for (size_t i = 0; i < vChunks.size(); i++)
 	{
-		pCurrentChunk = pChunk;
+		if ((vChunks[i]->iX == iX) && (vChunks[i]->iY == iY))
+		{
+			return vChunks[i];
+		}
 	}
+
+	return nullptr;
 }
 
 long long FWGenChunkMap::getCentralChunkX()
@@ -2705,4 +4043,6 @@ FWGenChunkMap::~FWGenChunkMap()
 		vChunks[i]->Destroy();
 		vChunks[i] = nullptr;
 	}
+
+	delete pBorderCache;
 }
\ No newline at end of file
@@ -27,24 +27,333 @@
 
 # pragma once
 # include <cstdint>
+# include <cmath>
 # include <numeric>
 # include <algorithm>
 # include <random>
 
+# if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#	define SIV_PERLIN_X86 1
+#	include <immintrin.h>
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+# else
+#	define SIV_PERLIN_X86 0
+# endif
+
+//----------------------------------------------------------------------------------------
+//
+//	Batch row evaluation.
+//
+//	The SIMD kernels are written once in PerlinNoiseRow.inl and included per instruction
+//	set below. GCC and Clang need every function that uses AVX2 / SSE4.1 intrinsics to be
+//	compiled for that target, so each inclusion is wrapped in a target region. MSVC allows
+//	intrinsics everywhere and needs no region.
+//
+//----------------------------------------------------------------------------------------
+
+# define SIV_PRAGMA(x) _Pragma(#x)
+
+# if defined(__clang__)
+#	define SIV_BEGIN_TARGET(isa) SIV_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#	define SIV_END_TARGET SIV_PRAGMA(clang attribute pop)
+# elif defined(__GNUC__)
+#	define SIV_BEGIN_TARGET(isa) SIV_PRAGMA(GCC push_options) SIV_PRAGMA(GCC target(isa))
+#	define SIV_END_TARGET SIV_PRAGMA(GCC pop_options)
+# else
+#	define SIV_BEGIN_TARGET(isa)
+#	define SIV_END_TARGET
+# endif
+
 namespace siv
 {
+	// Instruction set used by PerlinNoise::octaveNoise0_1Row().
+	enum class SimdLevel
+	{
+		Scalar,
+		SSE4,
+		AVX2
+	};
+
+	// Best instruction set supported by this CPU (and OS, for AVX state saving). Detected once.
+	inline SimdLevel DetectSimdLevel()
+	{
+		static const SimdLevel level = []() -> SimdLevel
+		{
+# if SIV_PERLIN_X86
+			unsigned int regs[4] = { 0, 0, 0, 0 };
+
+#	if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			const unsigned int maxLeaf = static_cast<unsigned int>(info[0]);
+			__cpuidex(info, 1, 0);
+			for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(info[i]);
+#	else
+			const unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+			__get_cpuid_count(1, 0, &regs[0], &regs[1], &regs[2], &regs[3]);
+#	endif
+
+			const bool bSse41   = (regs[2] & (1u << 19)) != 0;
+			const bool bOsxsave = (regs[2] & (1u << 27)) != 0;
+			const bool bAvx     = (regs[2] & (1u << 28)) != 0;
+
+			bool bAvx2 = false;
+
+			if (bOsxsave && bAvx && (maxLeaf >= 7))
+			{
+#	if defined(_MSC_VER)
+				const unsigned long long xcr0 = _xgetbv(0);
+				__cpuidex(info, 7, 0);
+				for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(info[i]);
+#	else
+				unsigned int xcr0Low = 0, xcr0High = 0;
+				__asm__ __volatile__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+				const unsigned long long xcr0 = (static_cast<unsigned long long>(xcr0High) << 32) | xcr0Low;
+				__get_cpuid_count(7, 0, &regs[0], &regs[1], &regs[2], &regs[3]);
+#	endif
+				// OS must save XMM and YMM state.
+				bAvx2 = ((xcr0 & 6) == 6) && ((regs[1] & (1u << 5)) != 0);
+			}
+
+			if (bAvx2)
+			{
+				return SimdLevel::AVX2;
+			}
+
+			if (bSse41)
+			{
+				return SimdLevel::SSE4;
+			}
+# endif
+			return SimdLevel::Scalar;
+		}();
+
+		return level;
+	}
+
+	inline const char* SimdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::AVX2: return "AVX2";
+		case SimdLevel::SSE4: return "SSE4";
+		default:              return "Scalar";
+		}
+	}
+
+	// Everything noise(x, y) needs from y. Shared by all samples of a row, computed once per octave.
+	template <class T>
+	struct RowTerms
+	{
+		std::int32_t Y;   // lattice row, & 255
+		T y0;             // y - floor(y)
+		T y1;             // y0 - 1
+		T v;              // Fade(y0)
+		T dv;             // Fade'(y0)
+	};
+
+	template <class T>
+	inline RowTerms<T> MakeRowTerms(T y)
+	{
+		const T yFloor = std::floor(y);
+
+		RowTerms<T> terms;
+		terms.Y  = static_cast<std::int32_t>(yFloor) & 255;
+		terms.y0 = y - yFloor;
+		terms.y1 = terms.y0 - 1;
+		terms.v  = terms.y0 * terms.y0 * terms.y0 * (terms.y0 * (terms.y0 * 6 - 15) + 10);
+		terms.dv = 30 * terms.y0 * terms.y0 * (terms.y0 * (terms.y0 - 2) + 1);
+
+		return terms;
+	}
+
+# if SIV_PERLIN_X86
+	namespace simd
+	{
+SIV_BEGIN_TARGET("sse4.1")
+		template <class T>
+		struct Sse4;
+
+		template <>
+		struct Sse4<double>
+		{
+			using T = double;
+			using V = __m128d;
+			using I = __m128i;
+			static constexpr std::int32_t Width = 2;
+
+			static V Load(const T* p) { return _mm_loadu_pd(p); }
+			static void Store(T* p, V v) { _mm_storeu_pd(p, v); }
+			static V Set1(T v) { return _mm_set1_pd(v); }
+			static V Zero() { return _mm_setzero_pd(); }
+			static V Add(V a, V b) { return _mm_add_pd(a, b); }
+			static V Sub(V a, V b) { return _mm_sub_pd(a, b); }
+			static V Mul(V a, V b) { return _mm_mul_pd(a, b); }
+			static V And(V a, V b) { return _mm_and_pd(a, b); }
+			static V Xor(V a, V b) { return _mm_xor_pd(a, b); }
+			static V Floor(V v) { return _mm_floor_pd(v); }
+			// mask ? a : b
+			static V Select(V mask, V a, V b) { return _mm_blendv_pd(b, a, mask); }
+
+			static I ToInt(V v) { return _mm_cvttpd_epi32(v); }
+			static I SetI(std::int32_t v) { return _mm_set1_epi32(v); }
+			static I AddI(I a, I b) { return _mm_add_epi32(a, b); }
+			static I AndI(I a, I b) { return _mm_and_si128(a, b); }
+			static I OrI(I a, I b) { return _mm_or_si128(a, b); }
+			static I CmpEqI(I a, I b) { return _mm_cmpeq_epi32(a, b); }
+			static I CmpGtI(I a, I b) { return _mm_cmpgt_epi32(a, b); }
+			// Widens an all-ones / all-zeros int32 lane mask to the lane width of V.
+			static V Mask(I m) { return _mm_castsi128_pd(_mm_cvtepi32_epi64(m)); }
+			// No hardware gather before AVX2.
+			static I Gather(const std::int32_t* table, I idx)
+			{
+				return _mm_setr_epi32(table[_mm_extract_epi32(idx, 0)], table[_mm_extract_epi32(idx, 1)], 0, 0);
+			}
+		};
+
+		template <>
+		struct Sse4<float>
+		{
+			using T = float;
+			using V = __m128;
+			using I = __m128i;
+			static constexpr std::int32_t Width = 4;
+
+			static V Load(const T* p) { return _mm_loadu_ps(p); }
+			static void Store(T* p, V v) { _mm_storeu_ps(p, v); }
+			static V Set1(T v) { return _mm_set1_ps(v); }
+			static V Zero() { return _mm_setzero_ps(); }
+			static V Add(V a, V b) { return _mm_add_ps(a, b); }
+			static V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+			static V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+			static V And(V a, V b) { return _mm_and_ps(a, b); }
+			static V Xor(V a, V b) { return _mm_xor_ps(a, b); }
+			static V Floor(V v) { return _mm_floor_ps(v); }
+			static V Select(V mask, V a, V b) { return _mm_blendv_ps(b, a, mask); }
+
+			static I ToInt(V v) { return _mm_cvttps_epi32(v); }
+			static I SetI(std::int32_t v) { return _mm_set1_epi32(v); }
+			static I AddI(I a, I b) { return _mm_add_epi32(a, b); }
+			static I AndI(I a, I b) { return _mm_and_si128(a, b); }
+			static I OrI(I a, I b) { return _mm_or_si128(a, b); }
+			static I CmpEqI(I a, I b) { return _mm_cmpeq_epi32(a, b); }
+			static I CmpGtI(I a, I b) { return _mm_cmpgt_epi32(a, b); }
+			// Lanes already have the width of V.
+			static V Mask(I m) { return _mm_castsi128_ps(m); }
+			static I Gather(const std::int32_t* table, I idx)
+			{
+				return _mm_setr_epi32(table[_mm_extract_epi32(idx, 0)], table[_mm_extract_epi32(idx, 1)],
+					table[_mm_extract_epi32(idx, 2)], table[_mm_extract_epi32(idx, 3)]);
+			}
+		};
+
+		namespace sse4
+		{
+#	include "PerlinNoiseRow.inl"
+		}
+SIV_END_TARGET
+
+SIV_BEGIN_TARGET("avx2")
+		template <class T>
+		struct Avx2;
+
+		template <>
+		struct Avx2<double>
+		{
+			using T = double;
+			using V = __m256d;
+			using I = __m128i;
+			static constexpr std::int32_t Width = 4;
+
+			static V Load(const T* p) { return _mm256_loadu_pd(p); }
+			static void Store(T* p, V v) { _mm256_storeu_pd(p, v); }
+			static V Set1(T v) { return _mm256_set1_pd(v); }
+			static V Zero() { return _mm256_setzero_pd(); }
+			static V Add(V a, V b) { return _mm256_add_pd(a, b); }
+			static V Sub(V a, V b) { return _mm256_sub_pd(a, b); }
+			static V Mul(V a, V b) { return _mm256_mul_pd(a, b); }
+			static V And(V a, V b) { return _mm256_and_pd(a, b); }
+			static V Xor(V a, V b) { return _mm256_xor_pd(a, b); }
+			static V Floor(V v) { return _mm256_floor_pd(v); }
+			static V Select(V mask, V a, V b) { return _mm256_blendv_pd(b, a, mask); }
+
+			static I ToInt(V v) { return _mm256_cvttpd_epi32(v); }
+			static I SetI(std::int32_t v) { return _mm_set1_epi32(v); }
+			static I AddI(I a, I b) { return _mm_add_epi32(a, b); }
+			static I AndI(I a, I b) { return _mm_and_si128(a, b); }
+			static I OrI(I a, I b) { return _mm_or_si128(a, b); }
+			static I CmpEqI(I a, I b) { return _mm_cmpeq_epi32(a, b); }
+			static I CmpGtI(I a, I b) { return _mm_cmpgt_epi32(a, b); }
+			static V Mask(I m) { return _mm256_castsi256_pd(_mm256_cvtepi32_epi64(m)); }
+			static I Gather(const std::int32_t* table, I idx) { return _mm_i32gather_epi32(table, idx, 4); }
+		};
+
+		template <>
+		struct Avx2<float>
+		{
+			using T = float;
+			using V = __m256;
+			using I = __m256i;
+			static constexpr std::int32_t Width = 8;
+
+			static V Load(const T* p) { return _mm256_loadu_ps(p); }
+			static void Store(T* p, V v) { _mm256_storeu_ps(p, v); }
+			static V Set1(T v) { return _mm256_set1_ps(v); }
+			static V Zero() { return _mm256_setzero_ps(); }
+			static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+			static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+			static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+			static V And(V a, V b) { return _mm256_and_ps(a, b); }
+			static V Xor(V a, V b) { return _mm256_xor_ps(a, b); }
+			static V Floor(V v) { return _mm256_floor_ps(v); }
+			static V Select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+
+			static I ToInt(V v) { return _mm256_cvttps_epi32(v); }
+			static I SetI(std::int32_t v) { return _mm256_set1_epi32(v); }
+			static I AddI(I a, I b) { return _mm256_add_epi32(a, b); }
+			static I AndI(I a, I b) { return _mm256_and_si256(a, b); }
+			static I OrI(I a, I b) { return _mm256_or_si256(a, b); }
+			static I CmpEqI(I a, I b) { return _mm256_cmpeq_epi32(a, b); }
+			static I CmpGtI(I a, I b) { return _mm256_cmpgt_epi32(a, b); }
+			static V Mask(I m) { return _mm256_castsi256_ps(m); }
+			static I Gather(const std::int32_t* table, I idx) { return _mm256_i32gather_epi32(table, idx, 4); }
+		};
+
+		namespace avx2
+		{
+#	include "PerlinNoiseRow.inl"
+		}
+SIV_END_TARGET
+	}
+# endif
+
 	class PerlinNoise
 	{
 	private:
 
 		std::uint8_t p[512];
 
-		static double Fade(double t) noexcept
+		// Same permutation widened to 32 bits, used as the gather table by the SIMD kernels.
+		std::int32_t pi[512];
+
+		template <class T>
+		static T Fade(T t) noexcept
 		{
 			return t * t * t * (t * (t * 6 - 15) + 10);
 		}
 
-		static double Lerp(double t, double a, double b) noexcept
+		template <class T>
+		static T FadeDerivative(T t) noexcept
+		{
+			return 30 * t * t * (t * (t - 2) + 1);
+		}
+
+		template <class T>
+		static T Lerp(T t, T a, T b) noexcept
 		{
 			return a + t * (b - a);
 		}
@@ -57,6 +366,225 @@ namespace siv
 			return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 		}
 
+		// Grad(hash, x, y, 0.0)
+		template <class T>
+		static T Grad(std::int32_t hash, T x, T y) noexcept
+		{
+			const std::int32_t h = hash & 15;
+			const T u = h < 8 ? x : y;
+			const T v = h < 4 ? y : h == 12 || h == 14 ? x : T(0);
+			return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+		}
+
+		// Grad(hash, x, y) == gx * x + gy * y
+		template <class T>
+		static void GradCoefficients(std::int32_t hash, T& gx, T& gy) noexcept
+		{
+			const std::int32_t h = hash & 15;
+			const T su = (h & 1) == 0 ? T(1) : T(-1);
+			const T sv = (h & 2) == 0 ? T(1) : T(-1);
+			gx = (h < 8 ? su : T(0)) + (h == 12 || h == 14 ? sv : T(0));
+			gy = (h < 8 ? T(0) : su) + (h < 4 ? sv : T(0));
+		}
+
+		// Octaves are handled in blocks of this size by the row kernels.
+		static constexpr std::int32_t RowOctaveBlock = 16;
+
+		// Adds noise(xs[i] * scales[o], y_o) * amps[o] over the octaves o of one block to out[i]
+		// (or overwrites out[i] if !accumulate), where terms[o] holds the precomputed y_o part.
+		// Sweeping a row, the lattice cell X only changes every few samples, so its hashes are
+		// looked up once per cell.
+		// Octaves > 0 fixes the octave count at compile time, 0 takes it from octaves.
+		template <std::int32_t Octaves, class T>
+		void noiseRowScalar(const T* xs, std::int32_t count, const RowTerms<T>* terms, const T* scales,
+			const T* amps, std::int32_t octaves, bool accumulate, T* out) const
+		{
+			const std::int32_t octaveCount = (Octaves > 0) ? Octaves : octaves;
+
+			for (std::int32_t o = 0; o < octaveCount; ++o)
+			{
+				const RowTerms<T>& t = terms[o];
+
+				std::int32_t lastX = -1;
+				std::int32_t hAA = 0, hBA = 0, hAB = 0, hBB = 0;
+
+				for (std::int32_t i = 0; i < count; ++i)
+				{
+					T x = xs[i] * scales[o];
+
+					const T xFloor = std::floor(x);
+					const std::int32_t X = static_cast<std::int32_t>(xFloor) & 255;
+
+					if (X != lastX)
+					{
+						const std::int32_t A = p[X] + t.Y;
+						const std::int32_t B = p[X + 1] + t.Y;
+
+						hAA = p[p[A]];
+						hAB = p[p[A + 1]];
+						hBA = p[p[B]];
+						hBB = p[p[B + 1]];
+
+						lastX = X;
+					}
+
+					x -= xFloor;
+
+					const T u = Fade(x);
+
+					const T value = Lerp(t.v, Lerp(u, Grad(hAA, x, t.y0),
+						Grad(hBA, x - 1, t.y0)),
+						Lerp(u, Grad(hAB, x, t.y1),
+						Grad(hBB, x - 1, t.y1)));
+
+					out[i] = ((accumulate || (o > 0)) ? out[i] : T(0)) + value * amps[o];
+				}
+			}
+		}
+
+		// noiseRowScalar() for one block of Octaves octaves that also writes the partial derivatives
+		// of the sum by x and by y.
+		template <std::int32_t Octaves, class T>
+		void noiseRowScalarDerivatives(const T* xs, std::int32_t count, const RowTerms<T>* terms, const T* scales,
+			const T* amps, T* out, T* outDx, T* outDy) const
+		{
+			for (std::int32_t o = 0; o < Octaves; ++o)
+			{
+				const RowTerms<T>& t = terms[o];
+
+				// d/dx noise(x * scale) = scale * noise'.
+				const T slope = amps[o] * scales[o];
+
+				std::int32_t lastX = -1;
+				std::int32_t hAA = 0, hBA = 0, hAB = 0, hBB = 0;
+				T gxa = 0, gya = 0, gxb = 0, gyb = 0, gxc = 0, gyc = 0, gxd = 0, gyd = 0;
+
+				for (std::int32_t i = 0; i < count; ++i)
+				{
+					T x = xs[i] * scales[o];
+
+					const T xFloor = std::floor(x);
+					const std::int32_t X = static_cast<std::int32_t>(xFloor) & 255;
+
+					if (X != lastX)
+					{
+						const std::int32_t A = p[X] + t.Y;
+						const std::int32_t B = p[X + 1] + t.Y;
+
+						hAA = p[p[A]];
+						hAB = p[p[A + 1]];
+						hBA = p[p[B]];
+						hBB = p[p[B + 1]];
+
+						GradCoefficients(hAA, gxa, gya);
+						GradCoefficients(hBA, gxb, gyb);
+						GradCoefficients(hAB, gxc, gyc);
+						GradCoefficients(hBB, gxd, gyd);
+
+						lastX = X;
+					}
+
+					x -= xFloor;
+
+					const T u = Fade(x);
+					const T du = FadeDerivative(x);
+
+					const T a = Grad(hAA, x, t.y0);
+					const T b = Grad(hBA, x - 1, t.y0);
+					const T c = Grad(hAB, x, t.y1);
+					const T d = Grad(hBB, x - 1, t.y1);
+
+					const T ab = Lerp(u, a, b);
+					const T cd = Lerp(u, c, d);
+
+					const T value = Lerp(t.v, ab, cd);
+					const T dx = Lerp(t.v, Lerp(u, gxa, gxb), Lerp(u, gxc, gxd)) + du * Lerp(t.v, b - a, d - c);
+					const T dy = Lerp(t.v, Lerp(u, gya, gyb), Lerp(u, gyc, gyd)) + t.dv * (cd - ab);
+
+					out[i]   = ((o > 0) ? out[i]   : T(0)) + value * amps[o];
+					outDx[i] = ((o > 0) ? outDx[i] : T(0)) + dx * slope;
+					outDy[i] = ((o > 0) ? outDy[i] : T(0)) + dy * slope;
+				}
+			}
+		}
+
+		// noiseRowScalarDerivatives() for samples that do not share y, so the y part of every
+		// octave is computed per sample and no hashes can be reused between samples.
+		template <std::int32_t Octaves, class T>
+		void noisePointsScalarDerivatives(const T* xs, const T* ys, std::int32_t count, const T* scales,
+			const T* amps, T* out, T* outDx, T* outDy) const
+		{
+			for (std::int32_t i = 0; i < count; ++i)
+			{
+				T result = 0, resultDx = 0, resultDy = 0;
+
+				for (std::int32_t o = 0; o < Octaves; ++o)
+				{
+					const RowTerms<T> t = MakeRowTerms(ys[i] * scales[o]);
+
+					T x = xs[i] * scales[o];
+
+					const T xFloor = std::floor(x);
+					const std::int32_t X = static_cast<std::int32_t>(xFloor) & 255;
+
+					const std::int32_t A = p[X] + t.Y;
+					const std::int32_t B = p[X + 1] + t.Y;
+
+					const std::int32_t hAA = p[p[A]];
+					const std::int32_t hAB = p[p[A + 1]];
+					const std::int32_t hBA = p[p[B]];
+					const std::int32_t hBB = p[p[B + 1]];
+
+					T gxa, gya, gxb, gyb, gxc, gyc, gxd, gyd;
+					GradCoefficients(hAA, gxa, gya);
+					GradCoefficients(hBA, gxb, gyb);
+					GradCoefficients(hAB, gxc, gyc);
+					GradCoefficients(hBB, gxd, gyd);
+
+					x -= xFloor;
+
+					const T u = Fade(x);
+					const T du = FadeDerivative(x);
+
+					const T a = Grad(hAA, x, t.y0);
+					const T b = Grad(hBA, x - 1, t.y0);
+					const T c = Grad(hAB, x, t.y1);
+					const T d = Grad(hBB, x - 1, t.y1);
+
+					const T ab = Lerp(u, a, b);
+					const T cd = Lerp(u, c, d);
+
+					const T slope = amps[o] * scales[o];
+
+					result   += Lerp(t.v, ab, cd) * amps[o];
+					resultDx += (Lerp(t.v, Lerp(u, gxa, gxb), Lerp(u, gxc, gxd)) + du * Lerp(t.v, b - a, d - c)) * slope;
+					resultDy += (Lerp(t.v, Lerp(u, gya, gyb), Lerp(u, gyc, gyd)) + t.dv * (cd - ab)) * slope;
+				}
+
+				out[i]   = result;
+				outDx[i] = resultDx;
+				outDy[i] = resultDy;
+			}
+		}
+
+		double noise2D(double x, const RowTerms<double>& terms) const
+		{
+			const double xFloor = std::floor(x);
+			const std::int32_t X = static_cast<std::int32_t>(xFloor) & 255;
+
+			x -= xFloor;
+
+			const double u = Fade(x);
+
+			const std::int32_t A = p[X] + terms.Y, AA = p[A], AB = p[A + 1];
+			const std::int32_t B = p[X + 1] + terms.Y, BA = p[B], BB = p[B + 1];
+
+			return Lerp(terms.v, Lerp(u, Grad(p[AA], x, terms.y0),
+				Grad(p[BA], x - 1, terms.y0)),
+				Lerp(u, Grad(p[AB], x, terms.y1),
+				Grad(p[BB], x - 1, terms.y1)));
+		}
+
 	public:
 
 		explicit PerlinNoise(std::uint32_t seed = std::default_random_engine::default_seed)
@@ -83,6 +611,11 @@ namespace siv
 			{
 				p[256 + i] = p[i];
 			}
+
+			for (size_t i = 0; i < 512; ++i)
+			{
+				pi[i] = p[i];
+			}
 		}
 
 		template <class URNG>
@@ -99,6 +632,11 @@ namespace siv
 			{
 				p[256 + i] = p[i];
 			}
+
+			for (size_t i = 0; i < 512; ++i)
+			{
+				pi[i] = p[i];
+			}
 		}
 
 		double noise(double x) const
@@ -106,9 +644,10 @@ namespace siv
 			return noise(x, 0.0, 0.0);
 		}
 
+		// Same result as noise(x, y, 0.0) without the z half of the lattice.
 		double noise(double x, double y) const
 		{
-			return noise(x, y, 0.0);
+			return noise2D(x, MakeRowTerms(y));
 		}
 
 		double noise(double x, double y, double z) const
@@ -215,5 +754,202 @@ namespace siv
 		{
 			return octaveNoise(x, y, z, octaves) * 0.5 + 0.5;
 		}
+
+		// Maximum absolute difference between octaveNoise0_1Row() and octaveNoise0_1(xs[i], y, octaves).
+		// The SIMD kernels perform the same operations in the same order as noise(), so in practice
+		// the results are bit-identical; the tolerance only leaves room for compilers that contract
+		// the scalar path into FMA instructions.
+		static constexpr double RowTolerance = 1e-12;
+
+		// Evaluates octaveNoise0_1(xs[i], y, octaves) for i in [0, count) and writes the results to out.
+		// All samples share one y, which is how terrain rows are generated.
+		// The y part of every octave is computed once per call, the per-sample work is only x dependent.
+		void octaveNoise0_1Row(const double* xs, double y, std::int32_t count, std::int32_t octaves, double* out,
+			SimdLevel level = DetectSimdLevel()) const
+		{
+			double frequencies[RowOctaveBlock];
+			double amplitudes[RowOctaveBlock];
+
+			double frequency = 1.0;
+			double amplitude = 1.0;
+
+			for (std::int32_t first = 0; first < octaves; first += RowOctaveBlock)
+			{
+				const std::int32_t blockOctaves = BlockOctaves(octaves - first);
+
+				for (std::int32_t o = 0; o < blockOctaves; ++o)
+				{
+					frequencies[o] = frequency;
+					amplitudes[o] = amplitude;
+
+					frequency *= 2.0;
+					amplitude *= 0.5;
+				}
+
+				noiseRowBlock<0>(xs, y, count, blockOctaves, frequencies, amplitudes, first > 0, out, level);
+			}
+
+			finishRow0_1(count, octaves, out);
+		}
+
+		// Same as above with the per-octave frequency and amplitude supplied by the caller,
+		// frequencies[o] = 2^o and amplitudes[o] = 0.5^o give the same result.
+		void octaveNoise0_1Row(const double* xs, double y, std::int32_t count, std::int32_t octaves,
+			const double* frequencies, const double* amplitudes, double* out, SimdLevel level = DetectSimdLevel()) const
+		{
+			for (std::int32_t first = 0; first < octaves; first += RowOctaveBlock)
+			{
+				noiseRowBlock<0>(xs, y, count, BlockOctaves(octaves - first),
+					frequencies + first, amplitudes + first, first > 0, out, level);
+			}
+
+			finishRow0_1(count, octaves, out);
+		}
+
+		// Same as above for a fixed octave count, which lets the compiler unroll the octave loop
+		// of the kernels. Also available in single precision, where the kernels process twice as
+		// many samples per instruction; the float results follow the same steps in float.
+		template <std::int32_t Octaves, class T>
+		void octaveNoise0_1Row(const T* xs, T y, std::int32_t count, const T* frequencies, const T* amplitudes,
+			T* out, SimdLevel level = DetectSimdLevel()) const
+		{
+			static_assert((Octaves >= 1) && (Octaves <= RowOctaveBlock), "Octaves must fit in one block.");
+
+			noiseRowBlock<Octaves>(xs, y, count, Octaves, frequencies, amplitudes, false, out, level);
+
+			finishRow0_1(count, Octaves, out);
+		}
+
+		// octaveNoise0_1Row<Octaves>() that also writes the partial derivatives of the result by x
+		// (outDx) and by y (outDy), as used for terrain normals. The values in out are the same.
+		template <std::int32_t Octaves, class T>
+		void octaveNoise0_1RowDerivatives(const T* xs, T y, std::int32_t count, const T* frequencies, const T* amplitudes,
+			T* out, T* outDx, T* outDy, SimdLevel level = DetectSimdLevel()) const
+		{
+			octaveNoiseRowDerivatives<Octaves>(xs, y, count, 0, frequencies, amplitudes, out, outDx, outDy, level);
+
+			finishRow0_1(count, Octaves, out);
+
+			for (std::int32_t i = 0; i < count; ++i)
+			{
+				outDx[i] *= T(0.5);
+				outDy[i] *= T(0.5);
+			}
+		}
+
+		// Sum of the octaves [firstOctave, firstOctave + Octaves) with their derivatives, before the mapping
+		// to [0, 1] (octaveNoise0_1 = sum * 0.5 + 0.5). frequencies and amplitudes are indexed by the octave.
+		template <std::int32_t Octaves, class T>
+		void octaveNoiseRowDerivatives(const T* xs, T y, std::int32_t count, std::int32_t firstOctave, const T* frequencies,
+			const T* amplitudes, T* out, T* outDx, T* outDy, SimdLevel level = DetectSimdLevel()) const
+		{
+			static_assert((Octaves >= 1) && (Octaves <= RowOctaveBlock), "Octaves must fit in one block.");
+
+			// All octaves use the same permutation.
+			frequencies += firstOctave;
+			amplitudes += firstOctave;
+
+			RowTerms<T> terms[Octaves];
+
+			for (std::int32_t o = 0; o < Octaves; ++o)
+			{
+				terms[o] = MakeRowTerms(y * frequencies[o]);
+			}
+
+			std::int32_t done = 0;
+
+# if SIV_PERLIN_X86
+			if (level == SimdLevel::AVX2)
+			{
+				done = simd::avx2::NoiseRowDerivatives<simd::Avx2<T>, Octaves>(pi, xs, count, terms, frequencies, amplitudes, out, outDx, outDy);
+			}
+			else if (level == SimdLevel::SSE4)
+			{
+				done = simd::sse4::NoiseRowDerivatives<simd::Sse4<T>, Octaves>(pi, xs, count, terms, frequencies, amplitudes, out, outDx, outDy);
+			}
+# endif
+
+			noiseRowScalarDerivatives<Octaves>(xs + done, count - done, terms, frequencies, amplitudes, out + done, outDx + done, outDy + done);
+		}
+
+		// octaveNoise0_1RowDerivatives<Octaves>() for samples (xs[i], ys[i]) that do not lie on one row,
+		// as needed for warped coordinates. Slower per sample than the row version.
+		template <std::int32_t Octaves, class T>
+		void octaveNoise0_1PointsDerivatives(const T* xs, const T* ys, std::int32_t count, const T* frequencies, const T* amplitudes,
+			T* out, T* outDx, T* outDy, SimdLevel level = DetectSimdLevel()) const
+		{
+			static_assert((Octaves >= 1) && (Octaves <= RowOctaveBlock), "Octaves must fit in one block.");
+
+			std::int32_t done = 0;
+
+# if SIV_PERLIN_X86
+			if (level == SimdLevel::AVX2)
+			{
+				done = simd::avx2::NoisePointsDerivatives<simd::Avx2<T>, Octaves>(pi, xs, ys, count, frequencies, amplitudes, out, outDx, outDy);
+			}
+			else if (level == SimdLevel::SSE4)
+			{
+				done = simd::sse4::NoisePointsDerivatives<simd::Sse4<T>, Octaves>(pi, xs, ys, count, frequencies, amplitudes, out, outDx, outDy);
+			}
+# endif
+
+			noisePointsScalarDerivatives<Octaves>(xs + done, ys + done, count - done, frequencies, amplitudes, out + done, outDx + done, outDy + done);
+
+			finishRow0_1(count, Octaves, out);
+
+			for (std::int32_t i = 0; i < count; ++i)
+			{
+				outDx[i] *= T(0.5);
+				outDy[i] *= T(0.5);
+			}
+		}
+
+	private:
+
+		template <std::int32_t Octaves, class T>
+		void noiseRowBlock(const T* xs, T y, std::int32_t count, std::int32_t octaves,
+			const T* frequencies, const T* amplitudes, bool accumulate, T* out, SimdLevel level) const
+		{
+			RowTerms<T> terms[RowOctaveBlock];
+
+			for (std::int32_t o = 0; o < octaves; ++o)
+			{
+				terms[o] = MakeRowTerms(y * frequencies[o]);
+			}
+
+			std::int32_t done = 0;
+
+# if SIV_PERLIN_X86
+			if (level == SimdLevel::AVX2)
+			{
+				done = simd::avx2::NoiseRow<simd::Avx2<T>, Octaves>(pi, xs, count, terms, frequencies, amplitudes, octaves, accumulate, out);
+			}
+			else if (level == SimdLevel::SSE4)
+			{
+				done = simd::sse4::NoiseRow<simd::Sse4<T>, Octaves>(pi, xs, count, terms, frequencies, amplitudes, octaves, accumulate, out);
+			}
+# endif
+
+			noiseRowScalar<Octaves>(xs + done, count - done, terms, frequencies, amplitudes, octaves, accumulate, out + done);
+		}
+
+		static std::int32_t BlockOctaves(std::int32_t remaining) noexcept
+		{
+			return (remaining < RowOctaveBlock) ? remaining : RowOctaveBlock;
+		}
+
+		template <class T>
+		static void finishRow0_1(std::int32_t count, std::int32_t octaves, T* out)
+		{
+			if (octaves <= 0)
+			{
+				std::fill(out, out + count, T(0));
+			}
+
+			for (std::int32_t i = 0; i < count; ++i)
+			{
+				out[i] = out[i] * T(0.5) + T(0.5);
+			}
+		}
 	};
 }
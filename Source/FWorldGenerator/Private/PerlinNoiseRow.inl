@@ -0,0 +1,316 @@
+//----------------------------------------------------------------------------------------
+//
+//	siv::PerlinNoise - SIMD row kernels.
+//
+//	Included by PerlinNoise.hpp once per instruction set, inside a namespace and a
+//	target region, so there is intentionally no include guard. S is one of the
+//	register wrapper defined next to the inclusion (Sse4<T>, Avx2<T>), T is double or float.
+//
+//	Every operation mirrors PerlinNoise::noise(x, y, 0.0) in the same order, so each
+//	lane produces the same value as the scalar code. The y dependent part of every
+//	octave comes precomputed in RowTerms.
+//
+//----------------------------------------------------------------------------------------
+
+template <class S>
+inline typename S::V Fade(typename S::V t)
+{
+	// t * t * t * (t * (t * 6 - 15) + 10)
+	const typename S::V inner = S::Add(S::Mul(t, S::Sub(S::Mul(t, S::Set1(6)), S::Set1(15))), S::Set1(10));
+	return S::Mul(S::Mul(S::Mul(t, t), t), inner);
+}
+
+// Derivative of Fade(): 30 * t * t * (t * (t - 2) + 1)
+template <class S>
+inline typename S::V FadeDerivative(typename S::V t)
+{
+	const typename S::V inner = S::Add(S::Mul(t, S::Sub(t, S::Set1(2))), S::Set1(1));
+	return S::Mul(S::Mul(S::Set1(30), S::Mul(t, t)), inner);
+}
+
+template <class S>
+inline typename S::V Lerp(typename S::V t, typename S::V a, typename S::V b)
+{
+	return S::Add(a, S::Mul(t, S::Sub(b, a)));
+}
+
+// PerlinNoise::Grad(hash, x, y, 0.0).
+template <class S>
+inline typename S::V Grad(typename S::I hash, typename S::V x, typename S::V y)
+{
+	using V = typename S::V;
+
+	const typename S::I h = S::AndI(hash, S::SetI(15));
+
+	const V uIsY = S::Mask(S::CmpGtI(h, S::SetI(7)));
+	const V vIsY = S::Mask(S::CmpGtI(S::SetI(4), h));
+	const V vIsX = S::Mask(S::OrI(S::CmpEqI(h, S::SetI(12)), S::CmpEqI(h, S::SetI(14))));
+
+	const V negU = S::Mask(S::CmpEqI(S::AndI(h, S::SetI(1)), S::SetI(1)));
+	const V negV = S::Mask(S::CmpEqI(S::AndI(h, S::SetI(2)), S::SetI(2)));
+
+	const V signBit = S::Set1(typename S::T(-0.0));
+
+	const V u = S::Select(uIsY, y, x);
+	const V v = S::Select(vIsY, y, S::Select(vIsX, x, S::Zero()));
+
+	return S::Add(S::Xor(u, S::And(negU, signBit)), S::Xor(v, S::And(negV, signBit)));
+}
+
+// Grad(hash, x, y) == gx * x + gy * y, with gx and gy in {-1, 0, 1}.
+template <class S>
+inline void GradCoefficients(typename S::I hash, typename S::V& gx, typename S::V& gy)
+{
+	using V = typename S::V;
+
+	const typename S::I h = S::AndI(hash, S::SetI(15));
+
+	const V uIsY = S::Mask(S::CmpGtI(h, S::SetI(7)));
+	const V vIsY = S::Mask(S::CmpGtI(S::SetI(4), h));
+	const V vIsX = S::Mask(S::OrI(S::CmpEqI(h, S::SetI(12)), S::CmpEqI(h, S::SetI(14))));
+
+	const V negU = S::Mask(S::CmpEqI(S::AndI(h, S::SetI(1)), S::SetI(1)));
+	const V negV = S::Mask(S::CmpEqI(S::AndI(h, S::SetI(2)), S::SetI(2)));
+
+	const V signBit = S::Set1(typename S::T(-0.0));
+	const V one = S::Set1(1);
+	const V zero = S::Zero();
+
+	const V su = S::Xor(one, S::And(negU, signBit));
+	const V sv = S::Xor(one, S::And(negV, signBit));
+
+	// vIsX and vIsY never overlap.
+	gx = S::Add(S::Select(uIsY, zero, su), S::Select(vIsX, sv, zero));
+	gy = S::Add(S::Select(uIsY, su, zero), S::Select(vIsY, sv, zero));
+}
+
+// PerlinNoise::noise(x, y, 0.0) for S::Width samples sharing one y, whose part is precomputed in terms.
+template <class S>
+inline typename S::V Noise(const std::int32_t* p, typename S::V x, const RowTerms<typename S::T>& terms)
+{
+	using V = typename S::V;
+	using I = typename S::I;
+
+	const V xFloor = S::Floor(x);
+
+	const I X = S::AndI(S::ToInt(xFloor), S::SetI(255));
+	const I Y = S::SetI(terms.Y);
+
+	x = S::Sub(x, xFloor);
+
+	const V u = Fade<S>(x);
+
+	const I one = S::SetI(1);
+
+	const I A  = S::AddI(S::Gather(p, X), Y);
+	const I AA = S::Gather(p, A);
+	const I AB = S::Gather(p, S::AddI(A, one));
+	const I B  = S::AddI(S::Gather(p, S::AddI(X, one)), Y);
+	const I BA = S::Gather(p, B);
+	const I BB = S::Gather(p, S::AddI(B, one));
+
+	const V x1 = S::Sub(x, S::Set1(1));
+	const V y0 = S::Set1(terms.y0);
+	const V y1 = S::Set1(terms.y1);
+
+	return Lerp<S>(S::Set1(terms.v), Lerp<S>(u, Grad<S>(S::Gather(p, AA), x, y0),
+		Grad<S>(S::Gather(p, BA), x1, y0)),
+		Lerp<S>(u, Grad<S>(S::Gather(p, AB), x, y1),
+		Grad<S>(S::Gather(p, BB), x1, y1)));
+}
+
+// Same contract as PerlinNoise::noiseRowScalar() for whole vectors. Returns how many samples
+// were processed; the caller finishes the remaining count % S::Width samples.
+// Octaves > 0 fixes the octave count at compile time, 0 takes it from octaves.
+template <class S, std::int32_t Octaves>
+inline std::int32_t NoiseRow(const std::int32_t* p, const typename S::T* xs, std::int32_t count,
+	const RowTerms<typename S::T>* terms, const typename S::T* scales, const typename S::T* amps,
+	std::int32_t octaves, bool accumulate, typename S::T* out)
+{
+	using V = typename S::V;
+
+	const std::int32_t octaveCount = (Octaves > 0) ? Octaves : octaves;
+	const std::int32_t vectorCount = count - (count % S::Width);
+
+	for (std::int32_t i = 0; i < vectorCount; i += S::Width)
+	{
+		const V x = S::Load(xs + i);
+
+		V result = accumulate ? S::Load(out + i) : S::Zero();
+
+		for (std::int32_t o = 0; o < octaveCount; ++o)
+		{
+			result = S::Add(result, S::Mul(Noise<S>(p, S::Mul(x, S::Set1(scales[o])), terms[o]), S::Set1(amps[o])));
+		}
+
+		S::Store(out + i, result);
+	}
+
+	return vectorCount;
+}
+
+// NoiseRow() for one block of Octaves octaves that also writes the partial derivatives of the sum
+// by x and by y. The value is computed from the gradient coefficients, which gives the same
+// result as Grad().
+template <class S, std::int32_t Octaves>
+inline std::int32_t NoiseRowDerivatives(const std::int32_t* p, const typename S::T* xs, std::int32_t count,
+	const RowTerms<typename S::T>* terms, const typename S::T* scales, const typename S::T* amps,
+	typename S::T* out, typename S::T* outDx, typename S::T* outDy)
+{
+	using V = typename S::V;
+	using I = typename S::I;
+
+	const std::int32_t vectorCount = count - (count % S::Width);
+
+	for (std::int32_t i = 0; i < vectorCount; i += S::Width)
+	{
+		const V xRow = S::Load(xs + i);
+
+		V result = S::Zero();
+		V resultDx = S::Zero();
+		V resultDy = S::Zero();
+
+		for (std::int32_t o = 0; o < Octaves; ++o)
+		{
+			const RowTerms<typename S::T>& t = terms[o];
+
+			V x = S::Mul(xRow, S::Set1(scales[o]));
+
+			const V xFloor = S::Floor(x);
+
+			const I X = S::AndI(S::ToInt(xFloor), S::SetI(255));
+			const I Y = S::SetI(t.Y);
+
+			x = S::Sub(x, xFloor);
+
+			const V u = Fade<S>(x);
+			const V du = FadeDerivative<S>(x);
+
+			const I one = S::SetI(1);
+
+			const I A = S::AddI(S::Gather(p, X), Y);
+			const I B = S::AddI(S::Gather(p, S::AddI(X, one)), Y);
+
+			V gxa, gya, gxb, gyb, gxc, gyc, gxd, gyd;
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, A)), gxa, gya);
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, B)), gxb, gyb);
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, S::AddI(A, one))), gxc, gyc);
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, S::AddI(B, one))), gxd, gyd);
+
+			const V x1 = S::Sub(x, S::Set1(1));
+			const V y0 = S::Set1(t.y0);
+			const V y1 = S::Set1(t.y1);
+			const V v = S::Set1(t.v);
+
+			const V a = S::Add(S::Mul(gxa, x), S::Mul(gya, y0));
+			const V b = S::Add(S::Mul(gxb, x1), S::Mul(gyb, y0));
+			const V c = S::Add(S::Mul(gxc, x), S::Mul(gyc, y1));
+			const V d = S::Add(S::Mul(gxd, x1), S::Mul(gyd, y1));
+
+			const V ab = Lerp<S>(u, a, b);
+			const V cd = Lerp<S>(u, c, d);
+
+			const V value = Lerp<S>(v, ab, cd);
+			const V dx = S::Add(Lerp<S>(v, Lerp<S>(u, gxa, gxb), Lerp<S>(u, gxc, gxd)),
+				S::Mul(du, Lerp<S>(v, S::Sub(b, a), S::Sub(d, c))));
+			const V dy = S::Add(Lerp<S>(v, Lerp<S>(u, gya, gyb), Lerp<S>(u, gyc, gyd)),
+				S::Mul(S::Set1(t.dv), S::Sub(cd, ab)));
+
+			// d/dx noise(x * scale) = scale * noise'.
+			const V slope = S::Set1(amps[o] * scales[o]);
+
+			result = S::Add(result, S::Mul(value, S::Set1(amps[o])));
+			resultDx = S::Add(resultDx, S::Mul(dx, slope));
+			resultDy = S::Add(resultDy, S::Mul(dy, slope));
+		}
+
+		S::Store(out + i, result);
+		S::Store(outDx + i, resultDx);
+		S::Store(outDy + i, resultDy);
+	}
+
+	return vectorCount;
+}
+
+// NoiseRowDerivatives() for samples that do not share y: the y part of every octave is computed
+// per lane, the same way as MakeRowTerms() does it for a row.
+template <class S, std::int32_t Octaves>
+inline std::int32_t NoisePointsDerivatives(const std::int32_t* p, const typename S::T* xs, const typename S::T* ys,
+	std::int32_t count, const typename S::T* scales, const typename S::T* amps,
+	typename S::T* out, typename S::T* outDx, typename S::T* outDy)
+{
+	using V = typename S::V;
+	using I = typename S::I;
+
+	const std::int32_t vectorCount = count - (count % S::Width);
+
+	for (std::int32_t i = 0; i < vectorCount; i += S::Width)
+	{
+		const V xPoints = S::Load(xs + i);
+		const V yPoints = S::Load(ys + i);
+
+		V result = S::Zero();
+		V resultDx = S::Zero();
+		V resultDy = S::Zero();
+
+		for (std::int32_t o = 0; o < Octaves; ++o)
+		{
+			V x = S::Mul(xPoints, S::Set1(scales[o]));
+			V y = S::Mul(yPoints, S::Set1(scales[o]));
+
+			const V xFloor = S::Floor(x);
+			const V yFloor = S::Floor(y);
+
+			const I X = S::AndI(S::ToInt(xFloor), S::SetI(255));
+			const I Y = S::AndI(S::ToInt(yFloor), S::SetI(255));
+
+			x = S::Sub(x, xFloor);
+			y = S::Sub(y, yFloor);
+
+			const V u = Fade<S>(x);
+			const V du = FadeDerivative<S>(x);
+			const V v = Fade<S>(y);
+			const V dv = FadeDerivative<S>(y);
+
+			const I one = S::SetI(1);
+
+			const I A = S::AddI(S::Gather(p, X), Y);
+			const I B = S::AddI(S::Gather(p, S::AddI(X, one)), Y);
+
+			V gxa, gya, gxb, gyb, gxc, gyc, gxd, gyd;
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, A)), gxa, gya);
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, B)), gxb, gyb);
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, S::AddI(A, one))), gxc, gyc);
+			GradCoefficients<S>(S::Gather(p, S::Gather(p, S::AddI(B, one))), gxd, gyd);
+
+			const V x1 = S::Sub(x, S::Set1(1));
+			const V y1 = S::Sub(y, S::Set1(1));
+
+			const V a = S::Add(S::Mul(gxa, x), S::Mul(gya, y));
+			const V b = S::Add(S::Mul(gxb, x1), S::Mul(gyb, y));
+			const V c = S::Add(S::Mul(gxc, x), S::Mul(gyc, y1));
+			const V d = S::Add(S::Mul(gxd, x1), S::Mul(gyd, y1));
+
+			const V ab = Lerp<S>(u, a, b);
+			const V cd = Lerp<S>(u, c, d);
+
+			const V value = Lerp<S>(v, ab, cd);
+			const V dx = S::Add(Lerp<S>(v, Lerp<S>(u, gxa, gxb), Lerp<S>(u, gxc, gxd)),
+				S::Mul(du, Lerp<S>(v, S::Sub(b, a), S::Sub(d, c))));
+			const V dy = S::Add(Lerp<S>(v, Lerp<S>(u, gya, gyb), Lerp<S>(u, gyc, gyd)),
+				S::Mul(dv, S::Sub(cd, ab)));
+
+			const V slope = S::Set1(amps[o] * scales[o]);
+
+			result = S::Add(result, S::Mul(value, S::Set1(amps[o])));
+			resultDx = S::Add(resultDx, S::Mul(dx, slope));
+			resultDy = S::Add(resultDy, S::Mul(dy, slope));
+		}
+
+		S::Store(out + i, result);
+		S::Store(outDx + i, resultDx);
+		S::Store(outDy + i, resultDy);
+	}
+
+	return vectorCount;
+}
@@ -0,0 +1,22 @@
+// This file is part of the FWorldGenenerator.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+
+#pragma once
+
+// UE
+#include "CoreMinimal.h"
+
+#include "FWGNoiseType.generated.h"
+
+
+// Noise used to generate the terrain height.
+// The values are written to the save file, only add new values to the end.
+UENUM(BlueprintType)
+enum class EFWGNoiseType : uint8
+{
+	Perlin        UMETA(DisplayName = "Perlin"),
+	OpenSimplex2  UMETA(DisplayName = "OpenSimplex2"),
+	Value         UMETA(DisplayName = "Value")
+};
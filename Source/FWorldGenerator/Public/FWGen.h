@@ -11,21 +11,30 @@
 #include "ProceduralMeshComponent.h"
 #include "Components/BoxComponent.h"
 
+// Custom
+#include "FWGNoiseType.h"
+
 // STL
 #include <vector>
 #include <random>
-#include <thread>
-#include <mutex>
+#include <memory>
+#include <deque>
 
 #include "FWGen.generated.h"
 
 
+FWORLDGENERATOR_API DECLARE_LOG_CATEGORY_EXTERN(LogFWGen, Log, All);
+
+
 class UStaticMeshComponent;
+class UFWGTerrainComponent;
+class UFWGHeightfieldComponent;
+class IPhysXCookingModule;
 
 
 #define VERSION_SIZE 20
 // Max size: 20 chars.
-#define FWGEN_VERSION "FWG 1.0.0"
+#define FWGEN_VERSION "FWG 1.12.0"
 
 // --------------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------------
@@ -34,6 +43,37 @@ class UStaticMeshComponent;
 class FWGenChunkMap;
 class AFWGChunk;
 class FWGCallback;
+class FWGNoiseContext;
+class FWGChunkGenerator;
+class FWGChunkJobQueue;
+class FWGChunkPrefetcher;
+class FWGChunkBorderCache;
+class FWGBiomeMap;
+class FWGChunkIndexBuffer;
+class FWGTerrainIndexBuffer;
+class FWGChunkLod;
+class FWGChunkRtin;
+class FWGHorizon;
+struct FWGChunkData;
+struct FWGChunkResult;
+struct FWGHorizonChunk;
+class UMovementComponent;
+
+
+// Actor that waits for the collision of the chunk it stands on (see AFWGen::HoldUntilCollision()).
+struct FWGHeldActor
+{
+	TWeakObjectPtr<AActor>                      pActor;
+
+	// Its physics was turned off.
+	TWeakObjectPtr<UPrimitiveComponent>         pPhysicsComponent;
+
+	// Were active and were deactivated.
+	TArray<TWeakObjectPtr<UMovementComponent>>  vMovementComponents;
+
+	long long                                   iChunkX;
+	long long                                   iChunkY;
+};
 
 UCLASS()
 class FWORLDGENERATOR_API AFWGen : public AActor
@@ -45,6 +85,8 @@ public:
 
 	~AFWGen();
 
+	virtual void Tick(float DeltaTime) override;
+
 	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
 		bool          BindFunctionToSpawn(UObject* FunctionOwner, FString FunctionName, float Layer,
 			float ProbabilityToSpawn, bool IsBlocking);
@@ -64,6 +106,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
 		FVector       GetFreeCellLocation(float Layer, bool SetBlocking = true);
 
+	// If the chunk under the actor has no collision yet (see CollisionRadius), turns off the physics of its root component
+	// and deactivates its movement components until the collision is attached. Call it for the actors spawned by the functions
+	// bound with BindFunctionToSpawn() that could fall through the ground. GenerateWorld() does it for the Character.
+	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
+		void          HoldUntilCollision(AActor* Actor);
+
+	// The actor the chunks are loaded around (without UseTriggerBoxes) and the prefetch follows.
+	// If none is set, the Character of GenerateWorld() or the pawn of the first player is used.
+	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
+		void          SetStreamingSource(AActor* Actor);
+
 	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
 		void          SaveWorldParamsToFile(FString PathToFile);
 
@@ -73,6 +126,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
 		void          GenerateWorld(int64 iCentralChunkX = 0, int64 iCentralChunkY = 0, AActor* Character = nullptr);
 
+	// Measures terrain generation throughput on this machine, writes the report to the log and returns it.
+	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Benchmark")
+		FString       RunBenchmark(int32 Iterations = 20);
+
 	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
 		int64     GetCentralChunkX();
 
@@ -85,6 +142,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
 		int64     GetChunkYByLocation(FVector Location);
 
+	// Part of the chunks loaded since the start of the game that were generated (or were being generated)
+	// before the player crossed into them (see PrefetchLookahead).
+	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
+		float     GetPrefetchHitRatio();
+
+	// Part of the prefetched chunks that were thrown away because the player went elsewhere.
+	UFUNCTION(BlueprintCallable, Category = "FWorldGenerator")
+		float     GetPrefetchWasteRatio();
+
 
 	// "Set" functions
 		
@@ -108,6 +174,42 @@ public:
 		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
 			void SetLoadUnloadChunkMaxZ(float NewLoadUnloadChunkMaxZ);
 
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetLodDistance(int32 NewLodDistance);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetLodMaxLevel(int32 NewLodMaxLevel);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetAdaptiveMeshMaxError(float NewAdaptiveMeshMaxError);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetHorizonDistance(int32 NewHorizonDistance);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetHorizonResolution(int32 NewHorizonResolution);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			void SetHeightfieldCollision(bool NewHeightfieldCollision);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetHeightfieldCollisionStep(int32 NewHeightfieldCollisionStep);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetCollisionRadius(int32 NewCollisionRadius);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetChunkCommitBudget(float NewChunkCommitBudget);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetPrefetchLookahead(float NewPrefetchLookahead);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			void SetUseTriggerBoxes(bool NewUseTriggerBoxes);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Chunks")
+			bool SetStreamingHysteresis(float NewStreamingHysteresis);
+
 
 		// Generation
 
@@ -126,6 +228,36 @@ public:
 		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Generation")
 			void SetInvertWorld(bool InvertWorld);
 
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Generation")
+			void SetSinglePrecisionGeneration(bool NewSinglePrecisionGeneration);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Generation")
+			void SetGenerationNoiseType(EFWGNoiseType NewGenerationNoiseType);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Generation")
+			bool SetMultiResolutionMaxError(float NewMultiResolutionMaxError);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Generation")
+			bool SetDomainWarpStrength(float NewDomainWarpStrength);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Generation")
+			bool SetDomainWarpFrequency(float NewDomainWarpFrequency);
+
+
+		// Biomes
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Biomes")
+			bool SetBiomeFrequency(float NewBiomeFrequency);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Biomes")
+			bool SetBiomeHeightVariation(float NewBiomeHeightVariation);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Biomes")
+			bool SetBiomeMaterialHeightShift(float NewBiomeMaterialHeightShift);
+
+		UFUNCTION(BlueprintCallable, Category = "FWorldGenerator | Biomes")
+			bool SetBiomeSpawnVariation(float NewBiomeSpawnVariation);
+
 
 		// World
 
@@ -265,6 +397,42 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
 		float LoadUnloadChunkMaxZ = 200000.0f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		int32 LodDistance = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		int32 LodMaxLevel = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		float AdaptiveMeshMaxError = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		int32 HorizonDistance = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		int32 HorizonResolution = 16;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		bool  HeightfieldCollision = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		int32 HeightfieldCollisionStep = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		int32 CollisionRadius = -1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		float ChunkCommitBudget = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		float PrefetchLookahead = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		bool  UseTriggerBoxes = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunks")
+		float StreamingHysteresis = 0.1f;
+
 
 
 
@@ -283,6 +451,35 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
 		bool  InvertWorld = false;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
+		bool  SinglePrecisionGeneration = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
+		EFWGNoiseType GenerationNoiseType = EFWGNoiseType::Perlin;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
+		float MultiResolutionMaxError = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
+		float DomainWarpStrength = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
+		float DomainWarpFrequency = 0.5f;
+
+
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes")
+		float BiomeFrequency = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes")
+		float BiomeHeightVariation = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes")
+		float BiomeMaterialHeightShift = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes")
+		float BiomeSpawnVariation = 0.0f;
+
 
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "World")
@@ -403,17 +600,68 @@ protected:
 
 private:
 
-	AFWGChunk*  generateChunk      (long long iX, long long iY, int32 iSectionIndex, bool bAroundCenter,
-		long long iUnloadX = 0, long long iUnloadY = 0, bool bUnload = false);
+	// Spawns a new chunk and generates it on this thread (see FWGChunkGenerator).
+	AFWGChunk*  generateChunk      (long long iX, long long iY, int32 iSectionIndex, bool bAroundCenter);
+	// Adds the job that generates the chunk for the coordinates it was moved to (see AFWGChunk::setUpdate()),
+	// the job of the previous coordinates (if not finished) is cancelled.
+	void  requestChunk             (AFWGChunk* pChunk);
+	// Without UseTriggerBoxes: moves the central chunk to the chunk of the streaming source (see StreamingHysteresis).
+	void  pollStreamingSource      ();
+	// nullptr if there is none.
+	AActor* getStreamingSource     () const;
+	// Adds the prefetch jobs for the chunks that are loaded when the central chunk moves
+	// towards where the streaming source is predicted to be (see FWGChunkPrefetcher).
+	void  updatePrefetch           ();
+	void  prefetchChunk            (long long iX, long long iY);
+	// Game thread: runs the next step of the commit (see EFWGCommitStep), returns true if the commit is finished
+	// (or thrown away because the chunk was moved again).
+	bool  commitChunkStep          (FWGChunkResult& result);
 	void  generateSeed             ();
-	float pickVertexMaterial       (double height, std::uniform_real_distribution<float>* pUrd, std::mt19937_64* pRnd, float* pfLayerTypeWithoutRnd = nullptr);
-	void  blendWorldMaterialsMore  (AFWGChunk* pOnlyForThisChunk = nullptr);
-	void  applySlopeDependentBlend (AFWGChunk* pOnlyForThisChunk = nullptr);
+	void  createBiomeMap           ();
 	void  spawnObjects             (AFWGChunk* pOnlyForThisChunk = nullptr);
 	void  createTriggerBoxForChunk (AFWGChunk* pChunk);
 
+	// Creates (bNewSection or another LOD level) or updates the mesh section of the chunk, only what is drawn
+	// (the collision is not touched, see updateChunkCollision()).
+	void  updateChunkMesh          (AFWGChunk* pChunk, bool bNewSection);
+	// Terrain component of the chunk section, created when the section is used for the first time.
+	UFWGTerrainComponent* getTerrainComponent (int32 iSectionIndex);
+	// Terrain component of the horizon chunk section (see FWGHorizonChunk::iSectionIndex), created the same way.
+	UFWGTerrainComponent* getHorizonComponent (int32 iSectionIndex);
+	// Adds or removes the collision of the chunk by CollisionRadius, bNewHeights - the chunk was generated again.
+	// The heightfield collision is built on the thread pool and attached later, the triangle mesh collision
+	// is cooked on the thread pool after the world was generated (see updatePendingCollisions()).
+	void  updateChunkCollision     (AFWGChunk* pChunk, bool bNewHeights);
+	// Triangle mesh collision of the chunk from its full resolution vertices (whatever the LOD level is),
+	// cooked on the thread pool after the world was generated unless bOnGameThread.
+	void  cookChunkCollision       (AFWGChunk* pChunk, bool bOnGameThread = false);
+	// Attaches the triangle mesh collision of the chunks whose cooking finished, cooks again the ones that were cooked
+	// for older heights and, after FWG_COLLISION_COOK_TIMEOUT, the ones whose cooking failed.
+	void  updatePendingCollisions  ();
+	// Enables the cooked triangle mesh collision of the chunk (the chunk has no collision if the cooking failed).
+	void  attachCookedCollision    (AFWGChunk* pChunk);
+	// After the central chunk moved: removes the collision of the chunks that left CollisionRadius
+	// and adds the chunks that came into it to vCollisionUpdates.
+	void  updateChunkCollisions    ();
+	bool  chunkNeedsCollision      (const AFWGChunk* pChunk) const;
+	void  onChunkCollisionAttached (AFWGChunk* pChunk);
+	UFWGHeightfieldComponent* getHeightfieldComponent (int32 iSectionIndex);
+	UProceduralMeshComponent* getCollisionComponent   (int32 iSectionIndex);
+
+	// Loaded chunk that has this location, nullptr if none.
+	AFWGChunk* getChunkByLocation  (float fX, float fY) const;
+	// Height of the triangles of the full resolution vertices, false if no loaded chunk has this location.
+	bool  getTerrainHeight         (float fX, float fY, float& fZ) const;
+	// Adds the chunks whose LOD level changed after the central chunk moved to vLodUpdates.
+	void  updateChunkLods          ();
+	int32 getChunkLodLevel         (const AFWGChunk* pChunk) const;
+
+	// Adds the jobs of the horizon chunks that entered the ring after the central chunk moved
+	// (generates them at once during GenerateWorld()).
+	void  updateHorizon            ();
+	void  commitHorizonChunk       (FWGHorizonChunk& chunk, const FWGChunkData& data);
+
 	bool  areEqual                 (float a, float b, float eps);
-	void  compareHeightDifference  (AFWGChunk* pChunk, std::vector<bool>& vProcessedVertices, float& fCurrentZ, size_t iCompareToIndex, float& fSteepSlopeMinHeightDiff);
 
 #if WITH_EDITORONLY_DATA
 //#if !UE_BUILD_SHIPPING
@@ -423,9 +671,26 @@ private:
 	std::vector<FWGCallback>  vObjectsToSpawn;
 	std::vector<FString>      vOverlapToClasses;
 
+	// See HoldUntilCollision().
+	std::vector<FWGHeldActor> vHeldActors;
+
+
+	// Component i draws the chunk section i.
+	UPROPERTY()
+	TArray<UFWGTerrainComponent*> vTerrainComponents;
+
+	// Component i is the collision of the chunk section i if bHeightfieldCollision.
+	UPROPERTY()
+	TArray<UFWGHeightfieldComponent*> vHeightfieldComponents;
+
+	// Component i is the triangle mesh collision of the chunk section i if not bHeightfieldCollision (it is not visible).
+	// One per chunk: a procedural mesh component cooks the collision of all of its sections together.
+	UPROPERTY()
+	TArray<UProceduralMeshComponent*> vCollisionComponents;
 
+	// Component i draws the horizon chunk section i, no collision.
 	UPROPERTY()
-	UProceduralMeshComponent* pProcMeshComponent;
+	TArray<UFWGTerrainComponent*> vHorizonComponents;
 
 
 	UPROPERTY()
@@ -447,6 +712,70 @@ private:
 
 	int32                     iGeneratedSeed;
 
+	// Rebuilt by generateSeed() only when the seed, the octave count or the noise type changes.
+	std::shared_ptr<const FWGNoiseContext> pNoiseContext;
+
+	// Rebuilt by GenerateWorld(), nullptr if the biomes are disabled.
+	std::shared_ptr<FWGBiomeMap> pBiomeMap;
+
+	// Triangles of every chunk section, rebuilt by GenerateWorld() when the chunk size changes.
+	std::shared_ptr<const FWGChunkIndexBuffer> pIndexBuffer;
+
+	// LOD levels of the chunks, 0 if the LODs are disabled.
+	int32                     iLodLevelCount;
+
+	// Level i is vLods[i], rebuilt by GenerateWorld() when the chunk size or LodMaxLevel changes.
+	// Empty if the LODs are disabled or the adaptive mesh is used.
+	std::vector<std::shared_ptr<const FWGChunkLod>> vLods;
+
+	// Index buffers of pIndexBuffer and of vLods on the GPU, every terrain component draws with them.
+	TSharedPtr<FWGTerrainIndexBuffer, ESPMode::ThreadSafe>              pTerrainIndices;
+	std::vector<TSharedPtr<FWGTerrainIndexBuffer, ESPMode::ThreadSafe>> vLodTerrainIndices;
+
+	// Index buffer of pHorizon on the GPU, every horizon component draws with it.
+	TSharedPtr<FWGTerrainIndexBuffer, ESPMode::ThreadSafe>              pHorizonTerrainIndices;
+
+	// Rebuilt by GenerateWorld() when the chunk size changes, nullptr if the adaptive mesh is disabled.
+	std::shared_ptr<const FWGChunkRtin> pRtin;
+
+	// Rebuilt by GenerateWorld(), nullptr if HorizonDistance is 0.
+	std::shared_ptr<FWGHorizon> pHorizon;
+
+	// Copy of the generation parameters made by GenerateWorld(), the chunk jobs keep their own reference.
+	std::shared_ptr<const FWGChunkGenerator> pChunkGenerator;
+
+	// Chunks generated on the thread pool after the central chunk moved, committed by Tick().
+	std::shared_ptr<FWGChunkJobQueue> pChunkJobs;
+
+	// Results taken from pChunkJobs whose commits are not finished (the front one is in progress), see Tick().
+	std::deque<std::shared_ptr<FWGChunkResult>> vChunkCommits;
+
+	// Chunks that came into CollisionRadius after the central chunk moved, their collision is built by Tick()
+	// one chunk per step of the commit budget (see updateChunkCollisions()).
+	std::deque<TWeakObjectPtr<AFWGChunk>> vCollisionUpdates;
+
+	// Chunks whose LOD level changed after the central chunk moved, meshed again by Tick()
+	// one chunk per step of the commit budget after vCollisionUpdates (see updateChunkLods()).
+	std::deque<TWeakObjectPtr<AFWGChunk>> vLodUpdates;
+
+	// Chunks generated before they are loaded, see PrefetchLookahead.
+	std::shared_ptr<FWGChunkPrefetcher> pPrefetcher;
+
+	// Set by SetStreamingSource(), GenerateWorld() (its Character) or the trigger box of the chunk the actor entered.
+	TWeakObjectPtr<AActor>    pStreamingSource;
+
+	// Set by GenerateWorld(): HeightfieldCollision and the physics engine supports heightfields.
+	bool                      bHeightfieldCollision;
+
+	// HeightfieldCollisionStep copied by GenerateWorld(), the heightfields are built for the vertices of pChunkGenerator.
+	int32                     iHeightfieldCollisionStep;
+
+	// Loaded by GenerateWorld() on the game thread for the heightfields built on the thread pool.
+	IPhysXCookingModule*      pCookingModule;
+
+	// Triangles of the adaptive mesh collision, see cookChunkCollision().
+	TArray<int32>             vCollisionTriangles;
+
 
 	bool                      bWorldCreated;
 
@@ -484,9 +813,13 @@ public:
 
 	void addChunk(AFWGChunk* pChunk);
 
-	void clearWorld(UProceduralMeshComponent* pProcMeshComponent);
+	void clearWorld();
 
-	void setCurrentChunk(AFWGChunk* pChunk);
+	// pSource - the actor that entered the chunk (nullptr if none).
+	void setCurrentChunk(AFWGChunk* pChunk, AActor* pSource = nullptr);
+
+	// Loads the chunks around the new central chunk in place of the chunks that are out of the view distance.
+	void moveCentralChunk(long long iNewX, long long iNewY);
 
 	long long getCentralChunkX();
 	long long getCentralChunkY();
@@ -495,12 +828,16 @@ public:
 
 	std::vector<AFWGChunk*> vChunks;
 
+	// Border vertices of the loaded chunks, shared with the chunks generated next to them.
+	FWGChunkBorderCache* pBorderCache;
+
 private:
 
 	void loadNewChunk(long long iLoadX, long long iLoadY, long long iUnloadX, long long iUnloadY);
 
+	// nullptr if the chunk is not loaded.
+	AFWGChunk* getChunk(long long iX, long long iY) const;
+
 	AFWGChunk* pCurrentChunk;
 	AFWGen* pGen;
-
-	std::mutex mtxLoadChunks;
 };
\ No newline at end of file